@@ -0,0 +1,110 @@
+/****************************************************************/
+/* File Name : arena.c						*/
+/* Contains modules :	create_arena				*/
+/*			arena_allocate				*/
+/*			free_arena				*/
+/* Uses modules in :	oc1.h					*/
+/*			util.c					*/
+/* Is used by modules in :	mktree.c			*/
+/*				_oblique.pyx			*/
+/* Remarks       :	The nodes of a tree being grown, with	*/
+/*			their coefficients and counts, are	*/
+/*			allocated from an arena : large blocks	*/
+/*			of memory, handed out in order and	*/
+/*			freed all at once with the tree. Each	*/
+/*			context allocates from a block of its	*/
+/*			own (context -> arena_block), so the	*/
+/*			threads growing subtrees only take the	*/
+/*			arena's lock when they need a new block.*/
+/****************************************************************/
+#include "oc1.h"
+
+/* Blocks are this many bytes, unless a larger one is asked for. */
+#define ARENA_BLOCK_SIZE	65536
+
+/* Everything handed out is aligned to this many bytes. */
+#define ARENA_ALIGNMENT	16
+#define ALIGNED(size) (((size) + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1))
+
+/************************************************************************/
+/* Module name : create_arena                                           */
+/* Functionality : Creates an empty arena.                              */
+/* Parameters : None.                                                   */
+/* Returns : the arena.                                                 */
+/* Calls modules : error (util.c)                                       */
+/* Is called by modules : build_tree (mktree.c)                         */
+/************************************************************************/
+ARENA *create_arena()
+{
+  ARENA *arena;
+
+  if ((arena = (ARENA *) malloc(sizeof(ARENA))) == NULL)
+    error("Create_Arena : Memory allocation failure.");
+  arena -> blocks = NULL;
+  pthread_mutex_init(&arena -> lock, NULL);
+  return (arena);
+}
+
+/************************************************************************/
+/* Module name : arena_allocate                                         */
+/* Functionality : Allocates memory from the arena of a context.        */
+/* Parameters : context : the context, with its arena set.              */
+/*              size : number of bytes.                                 */
+/* Returns : the memory, aligned to ARENA_ALIGNMENT bytes. It lasts     */
+/*           until free_arena.                                          */
+/* Calls modules : error (util.c)                                       */
+/* Is called by modules : create_tree_node (mktree.c)                   */
+/*                        build_tree (mktree.c)                         */
+/************************************************************************/
+char *arena_allocate(context, size)
+TRAINING_CONTEXT *context;
+size_t size;
+{
+  ARENA *arena = context -> arena;
+  ARENA_BLOCK *block = context -> arena_block;
+  size_t block_size;
+  char *memory;
+
+  size = ALIGNED(size);
+  if (block == NULL || block -> used + size > block -> size) {
+    block_size = (size > ARENA_BLOCK_SIZE) ? size : ARENA_BLOCK_SIZE;
+    block = (ARENA_BLOCK *) malloc(ALIGNED(sizeof(ARENA_BLOCK)) + block_size);
+    if (block == NULL) error("Arena_Allocate : Memory allocation failure.");
+    block -> size = block_size;
+    block -> used = 0;
+    pthread_mutex_lock(&arena -> lock);
+    block -> next = arena -> blocks;
+    arena -> blocks = block;
+    pthread_mutex_unlock(&arena -> lock);
+    context -> arena_block = block;
+  }
+
+  memory = (char *) block + ALIGNED(sizeof(ARENA_BLOCK)) + block -> used;
+  block -> used += size;
+  return (memory);
+}
+
+/************************************************************************/
+/* Module name : free_arena                                             */
+/* Functionality : Frees an arena, and everything allocated from it.    */
+/* Parameters : arena : the arena, or NULL.                             */
+/* Returns : Nothing.                                                   */
+/* Calls modules : None.                                                */
+/* Is called by modules : build_tree (mktree.c)                         */
+/*                        cross_validate (mktree.c)                     */
+/*                        Tree (_oblique.pyx)                           */
+/* Remarks : Takes time in the number of blocks, not of allocations.    */
+/************************************************************************/
+void free_arena(arena)
+ARENA *arena;
+{
+  ARENA_BLOCK *block, *next;
+
+  if (arena == NULL) return;
+  for (block = arena -> blocks; block != NULL; block = next) {
+    next = block -> next;
+    free((char *) block);
+  }
+  pthread_mutex_destroy(&arena -> lock);
+  free((char *) arena);
+}
@@ -13,6 +13,7 @@
 /*                      classify                                */
 /* Uses modules in :	oc1.h					*/
 /*			util.c					*/ 
+/*			flat_tree.c				*/
 /* Is used by modules in :	mktree.c			*/
 /* Remarks       :      Modules for classifying labelled or     */
 /*                      unlabelled data given a decision tree.  */
@@ -33,63 +34,33 @@ extern char misclassified_data[LINESIZE];
 /*			points to "output".				*/
 /* Parameters :	points : array of pointers to POINT structures.		*/
 /*		no_of_points : number of test samples			*/
+/*		dimensions : number of attributes of each sample	*/
 /*		root : pointer to the root of the decision tree		*/
+/*		root_count : training samples of each category, for a	*/
+/*			     tree that is a single leaf (root NULL).	*/
 /*		output : Points, with assigned categories are written	*/
 /*		to this file.						*/
 /* Returns :	None.							*/
-/* Calls modules :	ivector (util.c)				*/
-/*			free_ivector (util.c)				*/
-/*			leaf_count (classify_util.c)			*/
-/*		 	tree_depth (classify_util.c)			*/
-/*			print_point              			*/	
+/* Calls modules :	flatten_tree (flat_tree.c)			*/
+/*			classify_flat (flat_tree.c)			*/
+/*			free_flat_tree (flat_tree.c)			*/
 /* Is called by modules :	main (mktree.c)				*/
 /************************************************************************/
-classify (points,no_of_points,root,output)
+classify (points,no_of_points,dimensions,root,root_count,output)
      POINT **points;
-     int no_of_points;
+     int no_of_points,dimensions,*root_count;
      char *output;
      struct tree_node *root;
 {
-  FILE *outfile; 
-  int i,j;
-  double myrandom();
-  struct tree_node *cur_node;
-  double sum;
- 
+  FLAT_TREE *tree;
+
   //if ((outfile = fopen(output,"w")) == NULL) outfile = stdout;
-  
-  for (i=1;i<=no_of_points;i++)
-    {
-      cur_node = root;
-      while (cur_node != NULL)
-	{
-	  sum = cur_node->coefficients[no_of_dimensions+1];
-	  for (j=1;j<=no_of_dimensions;j++)
-	    sum += cur_node->coefficients[j] * points[i]->dimension[j];
-	  if (sum < 0)
-	    {
-	      if (cur_node->left != NULL) 
-		cur_node = cur_node->left;
-	      else
-		{
-		  points[i]->category = cur_node->left_cat ;
-		  break;
-		}
-	    }
-	  else
-	    {
-	      if (cur_node->right != NULL) 
-		cur_node = cur_node->right;
-	      else
-		{
-		  points[i]->category = cur_node->right_cat ;
-		  break;
-		}
-	    }
-	}
-      //print_point(outfile,points[i],FALSE);
-    }
 
+  tree = flatten_tree(root,dimensions,no_of_categories,root_count);
+  if (tree == NULL) return;
+  classify_flat(tree,points,no_of_points);
+  free_flat_tree(tree);
+  //for (i=1;i<=no_of_points;i++) print_point(outfile,points[i],FALSE);
 }
 
 /************************************************************************/
@@ -131,6 +102,8 @@ print_point(out,cur_point,unlabeled)
 /* Parameters :	points : array of pointers to POINT structures.		*/
 /*		no_of_points : number of test samples			*/
 /*		root : pointer to the root of the decision tree		*/
+/*		root_count : training samples of each category, for a	*/
+/*			     tree that is a single leaf (root NULL).	*/
 /* Returns :	a structure "test_outcome", containing the details of	*/
 /*		classification (overall classification accuracy, 	*/
 /*		accuracies for individual classes, decision tree leaf	*/
@@ -138,8 +111,11 @@ print_point(out,cur_point,unlabeled)
 /* Calls modules :	ivector (util.c)				*/
 /*			free_ivector (util.c)				*/
 /*			error (util.c)					*/
-/*			leaf_count (classify_util.c)			*/
-/*		 	tree_depth (classify_util.c)			*/
+/*			flatten_tree (flat_tree.c)			*/
+/*			flat_tree_category (flat_tree.c)		*/
+/*			free_flat_tree (flat_tree.c)			*/
+/*			leaf_count (tree_util.c)			*/
+/*		 	tree_depth (tree_util.c)			*/
 /*			print_point              			*/	
 /* Is called by modules :	main (mktree.c)				*/
 /*				cross_validate (mktree.c)		*/
@@ -147,9 +123,9 @@ print_point(out,cur_point,unlabeled)
 /*		a decision tree only on datasets in which the class of 	*/
 /*		the objects is marked.					*/ 
 /************************************************************************/
-struct test_outcome estimate_accuracy(points,no_of_points,root)
+struct test_outcome estimate_accuracy(points,no_of_points,root,root_count)
      POINT **points;
-     int no_of_points;
+     int no_of_points,*root_count;
      struct tree_node *root;
 {
   FILE *infile,*outfile; 
@@ -157,11 +133,10 @@ struct test_outcome estimate_accuracy(points,no_of_points,root)
   int total_corrects,total_incorrects;
   int leaf_count(),tree_depth();
   int *correct,*incorrect;
-  struct tree_node *cur_node;
   struct test_outcome result;
-  double sum;
+  FLAT_TREE *tree;
  
-  if (root == NULL) 
+  if (root == NULL && root_count == NULL) 
     error("Esimate_Accuracy : Called with empty decision tree."); 
   if (strlen(misclassified_data)) outfile = fopen(misclassified_data,"w");
   else outfile = NULL;
@@ -171,47 +146,18 @@ struct test_outcome estimate_accuracy(points,no_of_points,root)
 
   for (i=1;i<=no_of_categories;i++) correct[i] = incorrect[i] = 0;
   
+  tree = flatten_tree(root,no_of_dimensions,no_of_categories,root_count);
   for (i=1;i<=no_of_points;i++)
     {
-      cur_node = root;
-      while (cur_node != NULL)
-	{
-	  sum = cur_node->coefficients[no_of_dimensions+1];
-	  for (j=1;j<=no_of_dimensions;j++)
-	    sum += cur_node->coefficients[j] * points[i]->dimension[j];
-	  
-	  if (sum < 0)
-	    {
-	      if (cur_node->left != NULL) 
-		cur_node = cur_node->left;
-	      else
-		{
-		  if (cur_node->left_cat == points[i]->category) 
-		    correct[points[i]->category]++; 
-		  else 
-		    { incorrect[points[i]->category]++; 
-		      print_point(outfile,points[i],FALSE);
-		    }
-		  break;
-		}
-	    }
-	  else
-	    {
-	      if (cur_node->right != NULL) 
-		cur_node = cur_node->right;
-	      else
-		{
-		  if (cur_node->right_cat == points[i]->category) 
-		    correct[points[i]->category]++; 
-		  else 
-		    { incorrect[points[i]->category]++; 
-		      print_point(outfile,points[i],FALSE);
-		    }
-		  break;
-		}
-	    }
+      cur_point_category = flat_tree_category(tree,points[i]->dimension);
+      if (cur_point_category == points[i]->category)
+	correct[points[i]->category]++;
+      else
+	{ incorrect[points[i]->category]++;
+	  print_point(outfile,points[i],FALSE);
 	}
     }
+  free_flat_tree(tree);
   
   result.leaf_count = leaf_count(root);
   result.tree_depth = tree_depth(root);
@@ -9,33 +9,65 @@
 /* Author : Sreerama K. Murthy					*/
 /* Last modified : July 1994					*/
 /* Contains modules :	compute_impurity			*/
+/*			select_criterion			*/
+/*			free_criterion_tables			*/
+/*			find_criterion				*/
+/*			impurity_decrease			*/
 /*			set_counts				*/
 /*			reset_counts				*/
 /*			largest_element				*/
 /* Uses modules in :	oc1.h					*/
 /*			util.c					*/ 
+/*			impurity_measures.c			*/
+/*			perturb.c				*/
 /* Is used by modules in :	mktree.c			*/
 /*				perturb.c			*/
+/*				_oblique.pyx			*/
 /****************************************************************/		
 #include "oc1.h"
 
-extern int no_of_dimensions;
-extern int *left_count,*right_count;
-extern int no_of_categories;
-extern int coeff_modified;
-extern double *coeff_array;
+double gini_index(),info_gain(),twoing(),hellinger_distance();
+double maxminority(),summinority(),variance();
+double split_sorted_gini_index(),split_sorted_info_gain(),split_sorted_any();
+
+/* How the impurity of a split relates to the number of points, for	*/
+/* impurity_decrease.							*/
+#define MEAN_IMPURITY	0 /* Averaged over the points. */
+#define TOTAL_IMPURITY	1 /* Summed over the points. */
+#define INVERSE_GAIN	2 /* The reciprocal of an average gain. */
+
+/* The criteria, in the order of their numbers (see oc1.h) : their	*/
+/* names, measures, sweeps for linear_split_sorted (perturb.c) and	*/
+/* scales. Only the Gini index and the information gain have sweeps of	*/
+/* their own, which keep the measure up to date as points cross the	*/
+/* split.								*/
+static struct criterion
+ {
+  char *name;
+  double (*impurity)();
+  double (*split_sorted)();
+  int scale;
+ }criteria[NO_OF_CRITERIA] =
+ {
+  {"gini", gini_index, split_sorted_gini_index, MEAN_IMPURITY},
+  {"entropy", info_gain, split_sorted_info_gain, INVERSE_GAIN},
+  {"twoing", twoing, split_sorted_any, INVERSE_GAIN},
+  {"hellinger", hellinger_distance, split_sorted_any, MEAN_IMPURITY},
+  {"maxminority", maxminority, split_sorted_any, TOTAL_IMPURITY},
+  {"summinority", summinority, split_sorted_any, TOTAL_IMPURITY},
+  {"variance", variance, split_sorted_any, TOTAL_IMPURITY}
+ };
 
 /************************************************************************/
 /* Module name : compute_impurity					*/
 /* Functionality : Front end to the routine to compute the		*/
 /*		   impurity of a given array of points.			*/
-/*		   The name of the actual impurity-computing routine	*/
-/*		   is given by the hash constant IMPURITY, which is	*/
-/*		   in turn defined by the user in oc1.h.		*/
+/*		   The actual impurity-computing routine is that of	*/
+/*		   the criterion of the context (see select_criterion).	*/
 /* Parameters : cur_no_of_points : Size of the point set whose impurity	*/
 /*		needs to be computed.                                   */
 /* Returns :	impurity.						*/
-/* Calls modules : IMPURITY						*/
+/* Calls modules : context->impurity					*/
 /* Is called by modules :	main (mktree.c)				*/
 /*				build_dt (mktree.c)			*/	
 /*				oblique_split (mktree.c)		*/
@@ -44,23 +76,150 @@ extern double *coeff_array;
 /*				perturb_randomly (perturb.c)		*/
 /*				linear_split (perturb.c)		*/
 /************************************************************************/
-double compute_impurity(cur_no_of_points)
+double compute_impurity(context, cur_no_of_points)
+     TRAINING_CONTEXT *context;
      int cur_no_of_points;
 {
-  int i,j=0,stop_splitting();
-  double IMPURITY;
+  int i,j=0,left=0,stop_splitting();
 
   
   if (cur_no_of_points <= 1) return(0);
 
-  for (i=1;i<=no_of_categories;i++) j += left_count[i]+right_count[i];
+  for (i=1;i<=context->no_of_categories;i++)
+    {
+      left += context->left_count[i];
+      j += context->left_count[i]+context->right_count[i];
+    }
   
   if (j != cur_no_of_points)
     error ("Compute_Impurity: Left_Count and Right_Count not correctly set.");
   
-  if (stop_splitting()) return(0);
+  /* Splits leaving too few points on a side are not to be chosen. */
+  if (TOO_SMALL_A_LEAF(context,left,j-left)) return(HUGE_VAL);
+
+  if (stop_splitting(context)) return(0);
   
-  return(IMPURITY);
+  return((*context->impurity)(context));
+}
+
+/************************************************************************/
+/* Module name : select_criterion					*/
+/* Functionality :	Points the impurity and split_sorted routines	*/
+/*			of a context to those of its criterion, and	*/
+/*			sets up the tables the measure uses.		*/
+/* Parameters : no_of_points : number of points the tree is grown on.	*/
+/* Returns : Nothing.							*/
+/* Calls modules : error (util.c)					*/
+/*		   dvector (util.c)					*/
+/*		   mylog2 (util.c)					*/
+/* Is called by modules :	build_tree (mktree.c)			*/
+/* Remarks :	This is done once per tree, so the criterion costs	*/
+/*		the split searches no more than a measure fixed at	*/
+/*		compile time : the sweeps are compiled separately for	*/
+/*		each of the measures they know (see perturb.c). The	*/
+/*		contexts copied from this one keep the routines, and	*/
+/*		share the tables.					*/
+/*		The counts of points are whole numbers up to		*/
+/*		no_of_points, so the logarithms of the information gain	*/
+/*		and the square roots of the Hellinger distance are	*/
+/*		looked up rather than computed at every split.		*/
+/************************************************************************/
+select_criterion(context, no_of_points)
+     TRAINING_CONTEXT *context;
+     int no_of_points;
+{
+  int c;
+  double mylog2();
+
+  if (context->criterion < 0 || context->criterion >= NO_OF_CRITERIA)
+    error("Select_Criterion : Unknown impurity measure.");
+  context->impurity = criteria[context->criterion].impurity;
+  context->split_sorted = criteria[context->criterion].split_sorted;
+
+  context->n_log_n = context->square_root = NULL;
+  if (context->criterion == INFO_GAIN)
+    {
+      context->n_log_n = dvector(0,no_of_points);
+      context->n_log_n[0] = 0;
+      for (c=1;c<=no_of_points;c++) context->n_log_n[c] = c * mylog2((double)c);
+    }
+  if (context->criterion == HELLINGER)
+    {
+      context->square_root = dvector(0,no_of_points);
+      for (c=0;c<=no_of_points;c++) context->square_root[c] = sqrt((double)c);
+    }
+}
+
+/************************************************************************/
+/* Module name : free_criterion_tables					*/
+/* Functionality :	Frees the tables set up by select_criterion.	*/
+/* Parameters : no_of_points : as for select_criterion.			*/
+/* Returns : Nothing.							*/
+/* Calls modules : free_dvector (util.c)				*/
+/* Is called by modules :	build_tree (mktree.c)			*/
+/************************************************************************/
+free_criterion_tables(context, no_of_points)
+     TRAINING_CONTEXT *context;
+     int no_of_points;
+{
+  if (context->n_log_n != NULL) free_dvector(context->n_log_n,0,no_of_points);
+  if (context->square_root != NULL) free_dvector(context->square_root,0,no_of_points);
+  context->n_log_n = context->square_root = NULL;
+}
+
+/************************************************************************/
+/* Module name : find_criterion						*/
+/* Functionality :	Finds the number of a criterion from its name.	*/
+/* Parameters :	name : gini, entropy, twoing, hellinger, maxminority,	*/
+/*		       summinority or variance.				*/
+/* Returns :	the number (GINI_INDEX etc.), or -1 if there is no	*/
+/*		criterion by that name.					*/
+/* Calls modules : None.						*/
+/* Is called by modules :	main (mktree.c)				*/
+/*				Tree.fit (_oblique.pyx)			*/
+/************************************************************************/
+int find_criterion(name)
+     char *name;
+{
+  int i;
+
+  for (i=0;i<NO_OF_CRITERIA;i++)
+    if (!strcmp(name,criteria[i].name)) return(i);
+  return(-1);
+}
+
+/************************************************************************/
+/* Module name : impurity_decrease					*/
+/* Functionality :	Measures how much a split of a node improves	*/
+/*			the tree, on the same scale for all the nodes.	*/
+/* Parameters : initial_impurity : impurity of the node unsplit.	*/
+/*		split_impurity : impurity of the split.			*/
+/*		cur_no_of_points : number of points in the node.	*/
+/* Returns :	the decrease of the impurity, summed over the points	*/
+/*		of the node (the gain, for the measures returning its	*/
+/*		reciprocal).						*/
+/* Calls modules : None.						*/
+/* Is called by modules :	split_node (mktree.c)			*/
+/*				add_frontier_node (mktree.c)		*/
+/* Remarks :	A split making both sides homogeneous has impurity 0;	*/
+/*		for the reciprocal gains that is the largest decrease.	*/
+/************************************************************************/
+double impurity_decrease(context, initial_impurity, split_impurity,
+			 cur_no_of_points)
+     TRAINING_CONTEXT *context;
+     double initial_impurity, split_impurity;
+     int cur_no_of_points;
+{
+  switch (criteria[context->criterion].scale)
+    {
+    case MEAN_IMPURITY:
+      return((initial_impurity - split_impurity) * cur_no_of_points);
+    case INVERSE_GAIN:
+      if (split_impurity == 0) return(HUGE_VAL);
+      return((1.0 / split_impurity - 1.0 / initial_impurity) * cur_no_of_points);
+    default:
+      return(initial_impurity - split_impurity);
+    }
 }
 
 /************************************************************************/
@@ -75,7 +234,7 @@ double compute_impurity(cur_no_of_points)
 /*			computing initial impurity before splitting).	*/
 /*			If "flag" is not zero, it is assumed that	*/
 /*			the "val" fields of points are correctly set.	*/
-/* Parameters :	cur_points :	Array of pointers to the POINT structs	*/
+/* Parameters :	cur_points :	Indices of the points in the store*/
 /*		cur_no_of_points : Number of points			*/
 /*		flag : 0 if initial impurity is to be computed		*/
 /* Returns :	Nothing.						*/
@@ -88,32 +247,35 @@ double compute_impurity(cur_no_of_points)
 /*		impurity, than considering a hypothetical hyperplane 	*/
 /*		onto one side of the point set. Suggestions ?		*/
 /************************************************************************/
-set_counts(cur_points,cur_no_of_points,flag)
-     POINT **cur_points;
+set_counts(context, cur_points,cur_no_of_points,flag)
+     TRAINING_CONTEXT *context;
+     int *cur_points;
      int cur_no_of_points;
      int flag;
 {
   int i;
+  int *category = context->store->category;
+  double *val = context->store->val;
 
-  reset_counts();
+  reset_counts(context);
 
   if (!flag){
     for (i=1;i<=cur_no_of_points;i++){
-        right_count[cur_points[i]->category]++;
+        context->right_count[category[cur_points[i]]]++;
     }
   }
   else
     {
-     if (coeff_modified == TRUE) 
+     if (context->coeff_modified == TRUE) 
        {
 	 fprintf(stderr,
 		 "Set_Counts: Val fields of points are incorrect. Recomputing..\n");
-	 find_values(cur_points,cur_no_of_points);
+	 find_values(context, cur_points,cur_no_of_points);
        }
      for (i=1;i<=cur_no_of_points;i++)
-       if (cur_points[i]->val < 0)
-	 left_count[cur_points[i]->category]++;
-       else right_count[cur_points[i]->category]++;
+       if (val[cur_points[i]] < 0)
+	 context->left_count[category[cur_points[i]]]++;
+       else context->right_count[category[cur_points[i]]]++;
    }
 }
 
@@ -130,12 +292,13 @@ set_counts(cur_points,cur_no_of_points,flag)
 /*				linear_split (perturb.c)		*/
 /*	
 /************************************************************************/
-reset_counts()
+reset_counts(context)
+     TRAINING_CONTEXT *context;
 {
   int i;
   
-  for (i=1;i<=no_of_categories;i++)
-    left_count[i] = right_count[i] = 0;
+  for (i=1;i<=context->no_of_categories;i++)
+    context->left_count[i] = context->right_count[i] = 0;
 }
 
 /************************************************************************/
@@ -178,21 +341,22 @@ int largest_element(array,count)
 /* Remarks : It is assumed that the arrays left_count and right_count   */
 /*           are set correctly.                                         */
 /************************************************************************/
-int stop_splitting()
+int stop_splitting(context)
+     TRAINING_CONTEXT *context;
 { 
   int i,lpt=0,rpt=0,left_cat,right_cat,largest_element();
   
-  for (i=1;i<=no_of_categories;i++)
+  for (i=1;i<=context->no_of_categories;i++)
     {
-      lpt += left_count[i];
-      rpt += right_count[i];
+      lpt += context->left_count[i];
+      rpt += context->right_count[i];
     }
   
-  left_cat = largest_element(left_count,no_of_categories);
-  right_cat = largest_element(right_count,no_of_categories);
+  left_cat = largest_element(context->left_count,context->no_of_categories);
+  right_cat = largest_element(context->right_count,context->no_of_categories);
   
-  if (left_count[left_cat] == lpt &&
-      right_count[right_cat] == rpt &&
+  if (context->left_count[left_cat] == lpt &&
+      context->right_count[right_cat] == rpt &&
       left_cat != right_cat) return(TRUE);
   else return(FALSE);
       
@@ -204,10 +368,10 @@ int stop_splitting()
 /*			by substituting the points into the equation	*/
 /*			of the current hyperplane (given by the array	*/
 /*			"coeff_array").					*/
-/* Parameters :	cur_points : Array of pointers to point structures.	*/
+/* Parameters :	cur_points : Indices of the points in the store.	*/
 /*		cur_no_of_points : number of points under consideration.*/
 /* Returns :	Nothing.						*/
-/* Calls modules : None.						*/
+/* Calls modules : hyperplane_values (vector_kernels.c)			*/
 /* Is called by modules :	suggest_perturnbation			*/
 /*				perturb_randomly			*/
 /*				axis_parallel_split (mktree.c)		*/
@@ -224,23 +388,22 @@ int stop_splitting()
 /*				set to FALSE when the "val" fields are	*/
 /*				computed.				*/
 /* Remarks :	A lot of the computation done in OC1 takes place in this*/
-/*		routine, and the qsort system call in "linear_split".	*/	
+/*		routine, and the sorting in "linear_split".		*/
+/*		So the substitution is done by a vectorized kernel,	*/
+/*		chosen for the CPU in vector_kernels.c.			*/
 /************************************************************************/
-find_values(cur_points,cur_no_of_points)
-     POINT **cur_points;
+find_values(context, cur_points,cur_no_of_points)
+     TRAINING_CONTEXT *context;
+     int *cur_points;
      int cur_no_of_points;
 {
-  int i,j;
-
-  if (coeff_modified == FALSE) return;
-  for (i=1;i<=cur_no_of_points;i++)
-    {
-      cur_points[i]->val = coeff_array[no_of_dimensions+1];
-      for (j=1;j<=no_of_dimensions;j++)
-	cur_points[i]->val += cur_points[i]->dimension[j] * coeff_array[j];
-    }
+  if (context->coeff_modified == FALSE) return;
+  /* Points are substituted straight from the row_major block, so 
+     each one is a single contiguous read. */
+  (*hyperplane_values)(context->store, context->coeff_array,
+		       cur_points, cur_no_of_points);
   
-  coeff_modified = FALSE;
+  context->coeff_modified = FALSE;
 }
  
 
@@ -5,16 +5,20 @@
 /****************************************************************/
 /* Contact : murthy@cs.jhu.edu					*/
 /****************************************************************/
-/* File Name : animate.c					*/
+/* File Name : display.c					*/
 /* Author : Sreerama K. Murthy					*/
 /* Last modified : July 1994					*/
 /* Contains modules : 	main					*/
 /*			set_extremes				*/
 /*			display_point				*/
+/*			replay_tree				*/
+/*			draw_hyperplane				*/
+/*			node_label				*/
 /*			display_edge				*/
+/*			erase_hyperplane			*/
+/*			psdelay					*/
 /*			find_edge				*/
 /*			prepare_ps				*/
-/*			recursive_draw				*/
 /*			finish_ps				*/
 /*			make_box				*/
 /*			intersection				*/
@@ -24,7 +28,7 @@
 /* Uses modules in : 	util.c					*/
 /*			oc1.h					*/
 /*			load_data.c				*/
-/*			classify_util.c				*/
+/*			tree_util.c				*/
 /* Is used by modules in :	None.				*/
 /* Remarks       :	This file contains modules to display	*/
 /*			datasets and/or decision trees, as 	*/
@@ -34,16 +38,15 @@
 
 char *pname;
 char point_file[LINESIZE];
-char extra_label[LINESIZE];
 char ps_file[LINESIZE];
-char decision_tree[LINESIZE], train_data[LINESIZE];
+char decision_tree[LINESIZE];
 int unlabeled=FALSE,no_of_samples,no_of_dimensions=0;
-int no_of_categories=0,no_of_coeffs,normalize = FALSE;
+int no_of_categories=0,normalize = FALSE;
+int no_of_coeffs=3; /* Only planar data and trees are displayed. */
 int erase = TRUE,no_of_missing_values=0;
 int verbose=FALSE;
 int wait_time=1;
 
-struct tree_node *extra_node;
 struct point **train_points;
 struct tree_node *box;
 double xmax=1.0,xmin=0.0,ymax=1.0,ymin=0.0,xmargin,ymargin;
@@ -59,14 +62,15 @@ FILE *psfile;
 /* Parameters :	argc,argv : See any C-reference manual.			*/
 /* Returns : 	Nothing.						*/
 /* Calls modules :	display_help					*/
-/*			read_tree               			*/
 /*			error (util.c)					*/
 /*			load_points (load_data.c)			*/
+/*			replay_tree					*/
+/*			leaf_count (tree_util.c)			*/
+/*			tree_depth (tree_util.c)			*/
 /*			prepare_ps					*/
 /*			set_extremes					*/
 /*			display_point					*/
 /*			make_box					*/
-/*			recursive_draw					*/
 /*			finish_ps					*/
 /* Is called by modules :	None.					*/
 /************************************************************************/
@@ -80,8 +84,8 @@ main(argc,argv)
   int leaf_count(),tree_depth();
   int load_points();
   char title[LINESIZE];
-  struct tree_node *root,*cur_node,*read_tree();
-  FILE *infile,*dtree;
+  struct tree_node *root,*cur_node,*replay_tree();
+  FILE *infile;
   
   strcpy(point_file,"\0");
   strcpy(decision_tree,"\0");
@@ -157,8 +161,6 @@ main(argc,argv)
 	}
       if (no_of_dimensions != 2) 
 	error("Display-Main : Only planar datasets can be displayed. ");
-     no_of_coeffs = no_of_dimensions+1;
-  
  }
 
   if (!strlen(ps_file)) psfile = stdout;
@@ -178,16 +180,13 @@ main(argc,argv)
   
   if (strlen(decision_tree))
     {
-      if ((dtree = fopen(decision_tree,"r")) == NULL)
-	error ("Display-Main: Decision Tree file can not be opened.");
-      root = read_tree(dtree);
+      root = replay_tree(psfile,decision_tree);
       if (verbose) 
 	{
 	  printf("Decision tree read from %s.\n",decision_tree);
 	  printf("Leaf Count = %d, Tree Depth = %d\n",
 		  leaf_count(root),tree_depth(root));
 	}
-      fclose(dtree);
     }
   
   finish_ps(psfile);
@@ -246,6 +245,7 @@ set_extremes(psfile)
 /* Returns :	Nothing.						*/
 /* Calls modules :	None.						*/
 /* Is called by modules : main						*/
+/*			  erase_hyperplane				*/
 /* Important Variables used :	translatex, translatey : Inline function*/
 /*				calls, defined in oc1.h, to scale 	*/
 /*				coordinates.				*/
@@ -264,17 +264,131 @@ display_point(psfile,p)
 }
 
 
+/************************************************************************/
+/* Module name : replay_tree						*/
+/* Functionality :	Reads a decision tree, or the animation of its	*/
+/*			induction written by mktree, and draws each	*/
+/*			hyperplane as it is read.			*/
+/* Parameters :	psfile : File to write PostScript(R) output		*/
+/*		decision_tree : Name of the file the tree is stored in.	*/
+/* Returns :	pointer to the root node of the tree.			*/
+/* Calls modules :	read_header (tree_util.c)			*/
+/*			read_hp (tree_util.c)				*/
+/*			draw_hyperplane					*/
+/*			erase_hyperplane				*/
+/*			psdelay						*/
+/*			error (util.c)					*/
+/* Is called by modules :	main					*/
+/* Remarks :	Consecutive hyperplanes with the same node id are the	*/
+/*		perturbations tried for that node (see write_hyperplane	*/
+/*		in mktree.c). Each replaces the one before it in the	*/
+/*		tree, which is erased first unless the -e option is	*/
+/*		given. A node must come after its parent, as in the	*/
+/*		files written by mktree, since find_edge needs the	*/
+/*		edges of its ancestors.					*/
+/*		A node whose split was searched for but not found stays	*/
+/*		in the tree, with its last hyperplane.			*/
+/************************************************************************/
+struct tree_node *replay_tree(psfile,decision_tree)
+     FILE *psfile;
+     char *decision_tree;
+{
+  FILE *dtree;
+  struct tree_node *root = NULL,*cur_node,*prev_node = NULL,*parent;
+  struct tree_node **nodes = NULL,*read_hp();
+  int i,parent_id,side,count = 0,size = 0;
+  int read_header();
+  
+  if ((dtree = fopen(decision_tree,"r")) == NULL)
+    error("Replay_Tree: Decision Tree file can not be opened.");
+  
+  if (!read_header(dtree)) 
+    error("Replay_Tree: Decision tree invalid/absent.");
+  if (no_of_dimensions != 2) 
+    error("Replay_Tree: Only planar trees can be displayed. ");
+  
+  while ((cur_node = read_hp(dtree,&parent_id,&side)) != NULL)
+    {
+      if (prev_node != NULL && cur_node->id == prev_node->id)
+	{
+	  if (erase == TRUE) 
+	    {
+	      psdelay(psfile,wait_time);
+	      erase_hyperplane(psfile,prev_node,count);
+	    }
+	  count++;
+	  parent = prev_node->parent;
+	  if (parent == box) root = cur_node;
+	  else if (parent->left == prev_node) parent->left = cur_node;
+	  else parent->right = cur_node;
+	}
+      else
+	{
+	  count = 1;
+	  if (cur_node->id > size)
+	    {
+	      i = size;
+	      size = (2 * size > cur_node->id) ? 2 * size : cur_node->id;
+	      nodes = (struct tree_node **)realloc((char *)nodes,
+					   (size+1) * sizeof(struct tree_node *));
+	      if (nodes == NULL)
+		error("Replay_Tree : Memory allocation failure.");
+	      for (i++;i<=size;i++) nodes[i] = NULL;
+	    }
+	  if (nodes[cur_node->id] != NULL)
+	    error("Replay_Tree: Two nodes with the same id.");
+	  
+	  if (parent_id == 0)
+	    {
+	      if (root != NULL) error("Replay_Tree: More than one root.");
+	      root = cur_node;
+	      /* The edges of the box bound the regions of the nodes, */
+	      /* see find_edge.                                        */
+	      parent = box;
+	    }
+	  else
+	    {
+	      if (parent_id > size || (parent = nodes[parent_id]) == NULL)
+		error("Replay_Tree: Parent of a node absent.");
+	      if (side == LEFT)
+		{
+		  if (parent->left != NULL)
+		    error("Replay_Tree: Two left children.");
+		  parent->left = cur_node;
+		}
+	      else
+		{
+		  if (parent->right != NULL)
+		    error("Replay_Tree: Two right children.");
+		  parent->right = cur_node;
+		}
+	    }
+	}
+      cur_node->parent = parent;
+      nodes[cur_node->id] = cur_node;
+      draw_hyperplane(psfile,cur_node,count);
+      prev_node = cur_node;
+    }
+  fclose(dtree);
+  
+  if (root == NULL) error("Replay_Tree: Decision tree invalid/absent.");
+  free((char *)nodes);
+  return(root);
+}
+
 /************************************************************************/
 /* Module name : draw_hyperplane					*/
 /* Functionality :	Draws a node of the decision tree.	        */
 /*			ie., Determines the edge corresponding to the	*/
-/*			hyperplane at the current node, displays it,	*/
+/*			hyperplane at the current node, displays it.	*/
 /* Parameters :	psfile : File to write PostScript(R) output		*/
 /*		cur_node : Pointer to anode in the decision tree.	*/
+/*		count : serial number of this perturbation of the node.	*/
 /* Returns :	Nothing.						*/
 /* Calls modules :	find_edge					*/
+/*			node_label					*/
 /*			display_edge					*/
-/* Is called by modules :	main					*/
+/* Is called by modules :	replay_tree				*/
 /************************************************************************/
 draw_hyperplane(psfile,cur_node,count)
      struct tree_node *cur_node;
@@ -282,15 +396,34 @@ draw_hyperplane(psfile,cur_node,count)
      int count;
 {
   EDGE l,find_edge();
-  int i;
+  char label[LINESIZE];
   
   if (cur_node == NULL) return;
   
   l = find_edge(cur_node);
   if (l.from.x == l.to.x && l.from.y == l.to.y) return;
-  if (strlen(cur_node->label) == 0)
-    display_edge(psfile,l, "Root",count,0);
-  else display_edge(psfile,l, cur_node->label,count,0);
+  node_label(cur_node,label);
+  display_edge(psfile,l,label,count,0);
+}
+
+/************************************************************************/
+/* Module name : node_label						*/
+/* Functionality :	Makes the label an edge is displayed with.	*/
+/* Parameters :	cur_node : a node of the decision tree, or of the box.	*/
+/*		label : set to "Root" for the root, to the id of the	*/
+/*		        node for the others, and to "" for the box.	*/
+/* Returns :	Nothing.						*/
+/* Calls modules :	None.						*/
+/* Is called by modules :	draw_hyperplane				*/
+/*				erase_hyperplane			*/
+/************************************************************************/
+node_label(cur_node,label)
+     struct tree_node *cur_node;
+     char *label;
+{
+  if (cur_node->id == 0) strcpy(label,"");
+  else if (cur_node->parent == box) strcpy(label,"Root");
+  else sprintf(label,"%d",cur_node->id);
 }
 
 /************************************************************************/
@@ -351,7 +484,7 @@ finish_ps (psfile)
 /*			onedge						*/
 /*			correct_side					*/
 /*			error (util.c)					*/
-/* Is called by modules :	recursive_draw				*/
+/* Is called by modules :	draw_hyperplane				*/
 /* Important Variables used :	box : Root of a tree of four nodes, 	*/
 /*				each representing an edge of the 	*/
 /*				bounding box. 				*/ 
@@ -387,7 +520,7 @@ EDGE find_edge(cur_node)
     {
       p = intersection(cur_node->coefficients,cur_ancestor->coefficients);
       
-      if ( p.x != HUGE && p.y != HUGE 
+      if ( p.x != HUGE_VAL && p.y != HUGE_VAL 
 	  && onedge(p,cur_ancestor->edge)
 	  && correct_side(p,cur_node))
 	{
@@ -478,15 +611,11 @@ make_box()
   (right->edge).to.x  = (bottom->edge).from.x = xmax;
   (right->edge).to.y  = (bottom->edge).from.y = ymin;
   
+  left->id = top->id = right->id = bottom->id = 0; /* See node_label. */
   bottom->parent = right;
   right->parent = top;
   top->parent = left;
   left->parent = NULL;
-   
-  strcpy(bottom->label,"X");
-  strcpy(right ->label,"Y");
-  strcpy(top   ->label,"X");
-  strcpy(left  ->label,"Y");
   
   box = bottom;
 }
@@ -504,7 +633,8 @@ make_box()
 /*                       1 - reverse video (used for erasing).          */
 /* Returns :	Nothing.						*/
 /* Calls modules :	None.						*/
-/* Is called by modules : recursive_draw				*/
+/* Is called by modules : draw_hyperplane				*/
+/*			  erase_hyperplane				*/
 /* Important Variables used :	translatex, translatey : Inline function*/
 /*				calls, defined in oc1.h, to scale 	*/
 /*				coordinates.				*/
@@ -515,7 +645,6 @@ display_edge (psfile, e, label,count,reverse)
      char *label;
      int count,reverse;
 {
-  int i;
   struct endpoint p1, p2;
   double x,y;
   double angle;
@@ -555,17 +684,19 @@ display_edge (psfile, e, label,count,reverse)
 /************************************************************************/
 /* Module name : Erase Hyperplane                                       */
 /* Functionality : While showing the animation of tree induction, if    */
-/*                 the -e option is chosen, each hyperplane is erased   */
-/*                 before the next hyperplane is displayed. This module */
-/*                 erases a given hyperplane.                           */
+/*                 the -e option is not chosen, each hyperplane is      */
+/*                 erased before the next hyperplane tried for the same */
+/*                 node is displayed. This module erases a given        */
+/*                 hyperplane.                                          */
 /* Parameters :  psfile : Postscript file pointer.                      */
 /*               cur_node : Tree node containing current hyperplane.    */
 /*               count: serial number of the hyperplane being considered*/
 /*                      e.g: root-1,root-2,... etc                      */
 /* Returns : Nothing.                                                   */
-/* Calls modules : display_edge                                         */
+/* Calls modules : node_label                                           */
+/*                 display_edge                                         */
 /*                 display_point                                        */
-/* Is called by modules :                                               */
+/* Is called by modules : replay_tree                                   */
 /************************************************************************/
 erase_hyperplane(psfile,cur_node,count)
      FILE *psfile;
@@ -575,10 +706,10 @@ erase_hyperplane(psfile,cur_node,count)
   int i;
   double d;
   struct tree_node *node;
+  char label[LINESIZE];
   
-  if (!strlen(cur_node->label))
-    display_edge(psfile,cur_node->edge,"Root",count,1);
-  else display_edge(psfile,cur_node->edge,cur_node->label,count,1);
+  node_label(cur_node,label);
+  display_edge(psfile,cur_node->edge,label,count,1);
   
   /* Redraw points near the erased line. */
   for (i=1;i<=no_of_samples;i++)
@@ -595,24 +726,41 @@ erase_hyperplane(psfile,cur_node,count)
 	display_point(psfile,train_points[i]);
     }
 
-  /*Redraw all hyperplanes that are ancestors of the current one. */
+  /*Redraw all hyperplanes that are ancestors of the current one, and */
+  /*the edges of the box. */
   node = cur_node->parent;
   while (node != NULL)
     {
-      if (!strlen(node->label))
-	display_edge(psfile,node->edge,"Root",0,0);
-      else display_edge(psfile,node->edge,node->label,0,0);
+      node_label(node,label);
+      display_edge(psfile,node->edge,label,0,0);
       node = node->parent;
     }
 }
 
+/************************************************************************/
+/* Module name : psdelay                                                */
+/* Functionality : Makes the PostScript(R) interpreter wait a while,    */
+/*                 between the hyperplanes of an animation.             */
+/* Parameters : out : Postscript file pointer.                          */
+/*              t : time to wait, in arbitrary units.                   */
+/* Returns : Nothing.                                                   */
+/* Calls modules : None.                                                */
+/* Is called by modules : replay_tree                                   */
+/************************************************************************/
+psdelay(out,t)
+FILE *out;
+int t;
+{
+  fprintf(out, "0 1 %d 1 {add} for pop\n", t);
+}
+
 /************************************************************************/
 /* Module name : intersection						*/ 
 /* Functionality :	Computes the intersection point of two 		*/
 /*			hyperplanes.					*/
 /* Parameters :	c1,c2 : two coefficient arrays, each of length 3.	*/
 /* Returns :	the intersection point, stored in an "endpoint" struct.	*/
-/*		(HUGE,HUGE) if there is no intersection.		*/
+/*		(HUGE_VAL,HUGE_VAL) if there is no intersection.	*/
 /* Calls modules :	None.						*/
 /* Is called by modules :	find_edge				*/
 /************************************************************************/
@@ -624,7 +772,7 @@ struct endpoint intersection(c1,c2)
     
   denom = c2[2] * c1[1] - c2[1] * c1[2];
   if (!denom)
-    { p.x = HUGE; p.y = HUGE; return(p);}
+    { p.x = HUGE_VAL; p.y = HUGE_VAL; return(p);}
   
   p.x = (c2[3] * c1[2] - c2[2] * c1[3]) / denom;
   p.y = (c2[1] * c1[3] - c2[3] * c1[1]) / denom;
@@ -715,419 +863,5 @@ int correct_side(p,cur_node)
   else return(FALSE);
 }
 
-/************************************************************************/
-/* Module name :	read_tree					*/ 
-/* Functionality : High level routine for reading in a decision tree	*/
-/* Parameters :	dtree : decision tree file pointer              	*/
-/* Returns :	pointer to the root node of the tree.			*/
-/* Calls modules :	read_subtree					*/
-/*			read_header					*/
-/*			read_hp						*/
-/*			error (util.c)					*/
-/* Is called by modules :	main (mktree.c)				*/
-/*				main (gen_data.c)			*/
-/* Remarks : 	It is assumed that the file "decision_tree" is		*/
-/* 		written in a format similar to the output of the	*/
-/*		write_tree module (tree_util.c). A sample decision	*/
-/*		tree is available in sample.dt.				*/ 
-/************************************************************************/
-struct tree_node *read_tree(dtree)
-     FILE *dtree;
-{
-  struct tree_node *root,*cur_node,*read_hp(),*read_perturbations();
-  char *read_label();
-  int read_header();
-  
-  if (!read_header(dtree)) 
-    error("Read_Tree: Decision tree invalid/absent.");
-
-  if (no_of_samples == 0)
-    {
-      if (verbose)
-	printf("Attributes = %d, Classes = %d\n",no_of_dimensions,
-	       no_of_categories);
-      if (no_of_dimensions != 2) 
-	error("Read_Tree: Only planar trees can be displayed. ");
-      no_of_coeffs = no_of_dimensions+1;
-  }
-  
-  strcpy(extra_label,read_label(dtree));
-  if ((root = read_hp(dtree)) == NULL)
-    error("Read_Tree: Decision tree invalid/absent.");
-
-/*root->parent = NULL;*/
-  root->parent = box ;
-  draw_hyperplane(psfile,root,1);
-  if (!strcmp(root->label,extra_label))
-    root = read_perturbations(root,dtree);
-/*root->parent = NULL;*/
-  root->parent = box ;
-  
-  extra_node = NULL;
-  read_subtree(root,dtree);
-  
-  return(root);
-}
-
-
-/************************************************************************/
-/* Module name :	read_subtree					*/ 
-/* Functionality :	recursively reads in the hyperplane, left 	*/
-/*			subtree and the right subtree at a node of 	*/
-/*			the decision tree. 				*/
-/* Parameters :	root : node, the subtree at which is to be read.	*/
-/*		dtree: file pointer where the tree is available.	*/
-/* Returns :	nothing.						*/
-/* Calls modules :	read_subtree					*/
-/*			read_hp			         		*/
-/*			isleftchild					*/
-/*			isrightchild					*/
-/* Is called by modules :	read_tree				*/
-/*				read_subtree				*/
-/* Important Variables Used :	extra_node 				*/
-/*	Hyperplanes are read from the file "dtree" in the order "parent,*/
-/*	left child, right child". In case a node does not have either a	*/
-/* 	left child or a right child or both, this routine reads one 	*/
-/*	hyperplane before it is needed. Such hyperplanes, that are read	*/
-/*	before they are needed, are stored in extra_node.		*/
-/************************************************************************/
-read_subtree(root,dtree)
-     struct tree_node *root;
-     FILE *dtree;
-{
-  struct tree_node *cur_node,*read_hp(),*read_perturbations();
-  int isleftchild(),isrightchild();
-  
-  if (extra_node != NULL)
-    {
-      cur_node = extra_node;
-      extra_node = NULL;
-    }
-  else cur_node = read_hp(dtree);
-  
-  if (cur_node == NULL) return;
-  
-  if (isleftchild(cur_node,root))
-    {
-      cur_node->parent = root;
-      root->left = cur_node;
-      draw_hyperplane(psfile,cur_node,1);
-      if (!strcmp(cur_node->label,extra_label))
-	{
-	  cur_node = read_perturbations(cur_node,dtree);
-	  cur_node->parent = root;
-	  root->left = cur_node;
-	}
-      read_subtree(cur_node,dtree);
-      /* Read the next node */
-      if (extra_node != NULL)
-	{
-	  cur_node = extra_node;
-	  extra_node = NULL;
-	}
-      else
-	cur_node = read_hp(dtree);
-      if (cur_node == NULL) return;
-    }
-
-  if (isrightchild(cur_node,root))
-    {
-      cur_node->parent = root;
-      root->right = cur_node;
-      draw_hyperplane(psfile,cur_node,1);
-      if (!strcmp(cur_node->label,extra_label))
-	{
-	  cur_node = read_perturbations(cur_node,dtree);
-	  cur_node->parent = root;
-	  root->right = cur_node;
-	}
-      read_subtree(cur_node,dtree);
-    }
-  else 
-    extra_node = cur_node;
-  
-}
-
-/************************************************************************/
-/* Module name : read_perturbations                                     */
-/* Functionality : Used to read the perturbations of a single hyperplane*/
-/*                 for showing its animation.                           */
-/* Parameters : cur_node : tree node under consideration.               */
-/*              dtree : file pointer to the decision tree file.         */
-/* Returns : the next hyperplane in the tree - the one after the        */
-/*           one for which all the perturbations are read in this module*/
-/* Calls modules : erase_hyperplane                                     */
-/* Is called by modules :                                               */
-/************************************************************************/
-struct tree_node *read_perturbations(cur_node,dtree)
-     struct tree_node *cur_node;
-     FILE *dtree;
-{
-  struct tree_node *read_hp(),*next_node;
-  char cur_label[LINESIZE];
-  int count=1;
-
-  next_node = read_hp(dtree);
-  while (next_node != NULL)
-    {
-      if (erase == TRUE) 
-        {
-          psdelay(psfile,wait_time);
-          erase_hyperplane(psfile,cur_node,count);
-        }
-
-      count++;
-/*    if (cur_node->parent != NULL)*/
-      if (cur_node->parent != box)
-	{
-	  if ((cur_node->parent)->left == cur_node)
-	    cur_node->parent->left = next_node;
-	  else
-	    cur_node->parent->right = next_node;
-	}
-      next_node->parent = cur_node->parent;
-      
-      draw_hyperplane(psfile,next_node,count); 
-      cur_node = next_node;
-      if (!strcmp(cur_node->label,extra_label))
-	next_node = read_hp(dtree);
-      else next_node = NULL;
-    }
- 
-  return(cur_node);
-}
-
-
-
-psdelay(out,t)
-FILE *out;
-int t;
-{
-  fprintf(out, "0 1 %d 1 {add} for pop\n", t);
-}
-
-/************************************************************************/
-/* Module name : Read_Label                                             */
-/* Functionality : Reads the label of a hyperplane.                     */
-/* Parameters : dtree : File pointer of the input file.                 */
-/* Returns : character label                                            */
-/* Calls modules : None.                                                */
-/************************************************************************/
-char *read_label(dtree)
-     FILE *dtree;
-{
-  char c,label[LINESIZE];
-  
-  while (isspace(c = getc(dtree)));
-  ungetc(c,dtree); 
-  if (fscanf(dtree,"%[^' '] Hyperplane:",label) != 1)
-    return("NONE");
-  
-  if (!strcmp(label,"Root")) strcpy(label,"");
-  return(label);
-}
-
-/************************************************************************/
-/* Module name : read_hp						*/
-/* Functionality :	Reads a hyperplane (one node of the decision	*/
-/*			tree).						*/
-/* Parameters :	dtree : file pointer to the decision tree file.		*/
-/* Returns : pointer to the decision tree node read.			*/
-/* Calls modules :	vector (util.c)					*/
-/*			error (util.c)					*/
-/* Is called by modules :	read_tree				*/
-/*				read_subtree				*/
-/* Remarks :	Rather strict adherance to format.			*/
-/*		Please carefully follow the format in sample.dt, if	*/
-/*		your decision tree files are not produced by "mktree".	*/
-/************************************************************************/
-struct tree_node *read_hp(dtree)
-     FILE *dtree;
-{
-  struct tree_node *cur_node;
-  double temp;
-  char c,*read_label();
-  int i;
-  
-  cur_node = (struct tree_node *)malloc(sizeof(struct tree_node));
-  cur_node->coefficients = vector(1,no_of_coeffs);
-  cur_node->left_count = ivector(1,no_of_categories);
-  cur_node->right_count = ivector(1,no_of_categories);
-  
-  for (i=1;i<=no_of_coeffs;i++) cur_node->coefficients[i] = 0;
-  
-  cur_node->left = cur_node->right = NULL;
-  
-  while (isspace(c = getc(dtree)));
-  ungetc(c,dtree); 
-  
-  if (fscanf(dtree, "Left = [") != 0)
-    return(NULL);
-  
-  for (i=1;i<no_of_categories;i++)
-    if (fscanf(dtree,"%d,",&cur_node->left_count[i]) != 1)
-      return(NULL); 
-  if (fscanf(dtree,"%d], Right = [",
-	     &cur_node->left_count[no_of_categories]) != 1)
-    return(NULL); 
-  for (i=1;i<no_of_categories;i++)
-    if (fscanf(dtree,"%d,",&cur_node->right_count[i]) != 1)
-      return(NULL); 
-  if (fscanf(dtree,"%d]\n", &cur_node->right_count[no_of_categories]) != 1)
-    return(NULL); 
-
-
-  while (TRUE)
-    {
-      if ((fscanf(dtree,"%f %c",&temp,&c)) != 2)
-	error("Read_Hp: Invalid/Absent hyperplane equation.");
-      if (c == 'x')
-	{ 
-	  if ((fscanf(dtree,"[%d] +",&i)) != 1) 
-	    error("Read_Hp: Invalid hyperplane equation.");
-	  if (i <= 0 || i > no_of_coeffs) 
-	    error("Read_Hp: Invalid coefficient index in decision tree.");
-	  cur_node->coefficients[i] = temp;
-	}
-      else if (c == '=')
-	{
-	  fscanf(dtree," 0\n\n");
-	  cur_node->coefficients[no_of_coeffs] = temp;
-	  break;
-	}
-    }
-
-
-  cur_node->no_of_points = 0;
-  cur_node->left_cat = cur_node->right_cat = 1;
-  for (i=1;i<=no_of_categories;i++)
-    {
-      cur_node->no_of_points += cur_node->left_count[i] + 
-	cur_node->right_count[i];
-      if (cur_node->left_count[i] > cur_node->left_count[cur_node->left_cat])
-	cur_node->left_cat = i;
-      if (cur_node->right_count[i] > cur_node->right_count[cur_node->right_cat])
-	cur_node->right_cat = i;
-    }
-
-  strcpy(cur_node->label,extra_label);
-  strcpy(extra_label,read_label(dtree));
-  
-  return(cur_node);
-}
-
-
-/************************************************************************/
-/* Module name : isleftchild						*/
-/* Functionality : 	Checks if node x is a left child of node y.	*/
-/*			i.e., checks if the label of node x is the same	*/
-/*			as label of y, concatenated with "l".		*/
-/* Parameters : x,y : pointers to two decision tree nodes.		*/
-/* Returns :	1 : if x is the left child of y				*/
-/*		0 : otherwise						*/
-/* Calls modules :	none.						*/
-/* Is called by modules :	read_subtree				*/
-/************************************************************************/
-int isleftchild(x,y)
-     struct tree_node *x,*y;
-{
-  char temp[MAX_DT_DEPTH];
-  
-  strcpy(temp,y->label);
-  if (!strcmp(strcat(temp,"l"),x->label)) return(1);
-  else return(0);
-}
-
-/************************************************************************/
-/* Module name : isrightchild						*/
-/* Functionality : 	Checks if node x is a right child of node y.	*/
-/*			i.e., checks if the label of node x is the same	*/
-/*			as label of y, concatenated with "l".		*/
-/* Parameters : x,y : pointers to two decision tree nodes.		*/
-/* Returns :	1 : if x is the right child of y			*/
-/*		0 : otherwise						*/
-/* Calls modules :	none.						*/
-/* Is called by modules :	read_subtree				*/
-/************************************************************************/
-int isrightchild(x,y)
-     struct tree_node *x,*y;
-{
-  char temp[MAX_DT_DEPTH];
-
-  strcpy(temp,y->label);
-  if (!strcmp(strcat(temp,"r"),x->label)) return(1);
-  else return(0);
-}
-
-/************************************************************************/
-/* Module name : read_header						*/
-/* Functionality :	Reads the header information in a decision tree	*/
-/*			file.						*/
-/* Parameters :	dtree : file pointer to the decision tree file.		*/
-/* Returns : 	1 : if the header is successfully read.			*/
-/*		0 : otherwise.						*/
-/* Calls modules : none.						*/
-/* Is called by modules :	read_tree				*/
-/* Remarks :	Rather strict adherance to format.			*/
-/*		Please carefully follow the format in sample.dt, if	*/
-/*		your decision tree files are not produced by "mktree".	*/
-/************************************************************************/
-int read_header(dtree)
-     FILE *dtree;
-{
-  if ((fscanf(dtree,"Training set: %s ",train_data)) != 1) return(0);
-  if ((fscanf(dtree,"Dimensions: %d, Categories: %d\n",
-	      &no_of_dimensions,&no_of_categories)) != 2) return(0);
-  return(1);
-}
-
-/************************************************************************/
-/* Module name : leaf_count						*/
-/* Functionality :      Calculate the number of leaves of the decision  */
-/*                      tree. Each branch of the decision tree ends in	*/
-/*			a leaf.						*/
-/* Parameters : cur_node :      pointer to the root of the subtree whose*/
-/*                              leaves are to be counted.               */
-/* Returns :    number of leaves of the subtree pointed to by "cur_node"*/
-/* Calls modules :      leaf_count                                 	*/
-/* Is called by modules :       estimate_accuracy (classify.c)          */
-/*				main (display.c)			*/
-/************************************************************************/
-int leaf_count(cur_node)
-     struct tree_node *cur_node;
-{
-  int leaf_count();
-  
-  if (cur_node == NULL) return(1);
-  else return( leaf_count(cur_node->left)+leaf_count(cur_node->right));
-  
-}
-
-/************************************************************************/
-/* Module name : tree_depth                                             */
-/* Functionality :      Calculate the maximum depth of any node in a    */
-/*                      decision tree.					*/
-/*                      Depth of a node is its distance (in terms of the*/
-/*                      number of intermediate nodes) from the root.    */
-/* Parameters : cur_node :      pointer to the root of the subtree whose*/
-/*                              leaves are to be counted.               */
-/* Returns :    max depth of any node in the subtree pointed to by      */
-/*              "cur_node"                                              */
-/* Calls modules :      tree_depth                                      */
-/* Is called by modules :       estimate_accuracy (classify.c)          */
-/*				main (display.c)			*/
-/************************************************************************/
-int tree_depth(cur_node)
-     struct tree_node *cur_node;
-{
-  int left_depth, right_depth, tree_depth();
-  
-  if (cur_node == NULL) return(0);
-  left_depth = tree_depth(cur_node->left);
-  right_depth = tree_depth(cur_node->right);
-  if (left_depth >= right_depth) return(left_depth+1);
-  return(right_depth+1);
-}
- 
 /************************************************************************/
 /************************************************************************/
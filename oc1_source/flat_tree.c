@@ -0,0 +1,592 @@
+/****************************************************************/
+/* File Name : flat_tree.c					*/
+/* Contains modules :	flatten_tree				*/
+/*			flatten_subtree				*/
+/*			add_leaf				*/
+/*			count_nodes				*/
+/*			free_flat_tree				*/
+/*			flat_tree_leaf				*/
+/*			flat_tree_category			*/
+/*			classify_flat				*/
+/*			classify_rows				*/
+/*			rows_probabilities			*/
+/*			find_leaves				*/
+/*			route_block				*/
+/*			node_values				*/
+/* Uses modules in :	oc1.h					*/
+/*			util.c					*/
+/*			vector_kernels.c			*/
+/* Is used by modules in :	classify.c			*/
+/*				_oblique.pyx			*/
+/* Remarks       :	Classifying a point with the tree built	*/
+/*			by build_tree follows pointers between	*/
+/*			separately allocated nodes, and reads	*/
+/*			each hyperplane from an allocation of	*/
+/*			its own. Once the tree is grown, it is	*/
+/*			copied here into a FLAT_TREE (oc1.h):	*/
+/*			arrays of hyperplanes and of child	*/
+/*			indices, with the nodes in depth first	*/
+/*			order, so that a node and its left	*/
+/*			child are adjacent and a subtree	*/
+/*			occupies a contiguous block. (Breadth	*/
+/*			first order puts the children of deep	*/
+/*			nodes far apart, and was slower on the	*/
+/*			deep trees OC1 grows.)			*/
+/*			Axis parallel splits become a single	*/
+/*			comparison, and hyperplanes with few	*/
+/*			nonzero coefficients keep only those,	*/
+/*			so a node costs time and memory in	*/
+/*			proportion to the attributes it uses.	*/
+/*			The nonzero terms are added up in the	*/
+/*			same order as in classify, and x + c	*/
+/*			is negative exactly when x < -c, so	*/
+/*			the categories assigned are the same.	*/
+/*			The leaves keep the fractions of the	*/
+/*			training samples of each category that	*/
+/*			reached them, as class probabilities.	*/
+/****************************************************************/
+#include "oc1.h"
+#include <sys/mman.h>
+
+int count_nodes(), add_leaf(), flat_tree_leaf();
+void flatten_subtree(), find_leaves(), route_block(), node_values();
+
+/************************************************************************/
+/* Module name : flatten_tree                                           */
+/* Functionality : Copies a decision tree into a FLAT_TREE.             */
+/* Parameters : root : pointer to the root of the decision tree, NULL   */
+/*              if the root was not split.                              */
+/*              dimensions : number of attributes of the samples.       */
+/*              categories : number of categories.                      */
+/*              root_count : number of training samples of each         */
+/*              category (1..categories), for the leaf of a tree whose  */
+/*              root was not split. May be NULL if root is not.         */
+/* Returns : pointer to the FLAT_TREE, or NULL if the tree is empty.    */
+/* Calls modules : count_nodes                                          */
+/*                 flatten_subtree                                      */
+/*                 add_leaf                                             */
+/*                 error (util.c)                                       */
+/*                 ivector (util.c)                                     */
+/* Is called by modules : main (mktree.c)                               */
+/*                        classify (classify.c)                         */
+/*                        estimate_accuracy (classify.c)                */
+/*                        Tree.fit (_oblique.pyx)                       */
+/* Remarks : A tree whose root was not split has no nodes, and a single */
+/*           leaf assigning the most frequent category.                 */
+/************************************************************************/
+FLAT_TREE *flatten_tree(root, dimensions, categories, root_count)
+struct tree_node *root;
+int dimensions, categories, *root_count;
+{
+  FLAT_TREE *tree;
+  struct tree_node **nodes;
+  int i, j, k, no_of_nodes, no_of_terms, next, room, category;
+
+  if (root == NULL && root_count == NULL) return (NULL);
+
+  no_of_nodes = count_nodes(root);
+  room = (no_of_nodes > 0) ? no_of_nodes : 1; /* malloc(0) may return NULL. */
+  tree = (FLAT_TREE *) malloc(sizeof(FLAT_TREE));
+  nodes = (struct tree_node **) malloc(room * sizeof(struct tree_node *));
+  if (tree == NULL || nodes == NULL)
+    error("Flatten_Tree : Memory allocation failure.");
+  tree -> no_of_nodes = no_of_nodes;
+  tree -> no_of_dimensions = dimensions;
+  tree -> kind = (char *) malloc(room * sizeof(char));
+  tree -> first_term = (int *) malloc((no_of_nodes + 1) * sizeof(int));
+  tree -> constant = (double *) malloc(room * sizeof(double));
+  tree -> children = (int *) malloc(2 * room * sizeof(int));
+  /* A binary tree has one more leaf than it has internal nodes. */
+  tree -> no_of_categories = categories;
+  tree -> no_of_leaves = 0;
+  tree -> image = NULL;
+  tree -> leaf_category = ivector(1, no_of_nodes + 1);
+  tree -> leaf_probabilities = (double *) malloc((no_of_nodes + 1) * categories * sizeof(double));
+  if (tree -> kind == NULL || tree -> first_term == NULL || tree -> constant == NULL ||
+      tree -> children == NULL || tree -> leaf_probabilities == NULL)
+    error("Flatten_Tree : Memory allocation failure.");
+
+  /* Number the nodes and leaves, and find the kind and number of terms */
+  /* of each node.                                                      */
+  if (root != NULL) {
+    next = 1;
+    flatten_subtree(tree, root, 0, &next, nodes);
+  } else {
+    category = 1;
+    for (i = 2; i <= categories; i++)
+      if (root_count[i] > root_count[category]) category = i;
+    add_leaf(tree, root_count, category);
+  }
+
+  no_of_terms = 0;
+  for (k = 0; k < no_of_nodes; k++) {
+    i = tree -> first_term[k + 1];
+    tree -> first_term[k] = no_of_terms;
+    no_of_terms += i;
+  }
+  tree -> first_term[no_of_nodes] = no_of_terms;
+
+  tree -> attributes = (int *) malloc((no_of_terms + 1) * sizeof(int));
+  tree -> coefficients = (double *) malloc((no_of_terms + 1) * sizeof(double));
+  if (tree -> attributes == NULL || tree -> coefficients == NULL)
+    error("Flatten_Tree : Memory allocation failure.");
+
+  for (k = 0; k < no_of_nodes; k++) {
+    i = tree -> first_term[k];
+    for (j = 1; j <= dimensions; j++)
+      if (tree -> kind[k] == DENSE_NODE || nodes[k] -> coefficients[j] != 0) {
+        tree -> attributes[i] = j;
+        tree -> coefficients[i++] = nodes[k] -> coefficients[j];
+      }
+    if (tree -> kind[k] == DENSE_NODE) {
+      tree -> attributes[i] = dimensions + 1;
+      tree -> coefficients[i] = nodes[k] -> coefficients[dimensions + 1];
+    }
+  }
+
+  free((char *) nodes);
+  return (tree);
+}
+
+/************************************************************************/
+/* Module name : flatten_subtree                                        */
+/* Functionality : Numbers the nodes of a subtree in depth first order, */
+/*                 and sets their children, kinds and constants, and    */
+/*                 adds its leaves.                                     */
+/* Parameters : tree : the FLAT_TREE being filled.                      */
+/*              cur_node : root of the subtree.                         */
+/*              index : the number of cur_node.                         */
+/*              next : the first free number, advanced past the nodes   */
+/*              of the subtree.                                         */
+/*              nodes : set to the tree_node of each number.            */
+/* Returns : Nothing.                                                   */
+/* Calls modules : flatten_subtree                                      */
+/*                 add_leaf                                             */
+/* Is called by modules : flatten_tree                                  */
+/*                        flatten_subtree                               */
+/* Remarks : The number of terms of node k is left in first_term[k+1],  */
+/*           for flatten_tree to add up.                                */
+/************************************************************************/
+void flatten_subtree(tree, cur_node, index, next, nodes)
+FLAT_TREE *tree;
+struct tree_node *cur_node, **nodes;
+int index, *next;
+{
+  int j, nonzero, last = 0, dimensions = tree -> no_of_dimensions;
+  double *coefficients = cur_node -> coefficients;
+
+  nodes[index] = cur_node;
+
+  nonzero = 0;
+  for (j = 1; j <= dimensions; j++)
+    if (coefficients[j] != 0) {
+      nonzero++;
+      last = j;
+    }
+
+  if (nonzero == 1 && coefficients[last] == 1) {
+    tree -> kind[index] = THRESHOLD_NODE;
+    tree -> constant[index] = -coefficients[dimensions + 1];
+    tree -> first_term[index + 1] = 1;
+  } else if (nonzero <= SPARSE_NODE_FRACTION * dimensions) {
+    tree -> kind[index] = SPARSE_NODE;
+    tree -> constant[index] = coefficients[dimensions + 1];
+    tree -> first_term[index + 1] = nonzero;
+  } else {
+    tree -> kind[index] = DENSE_NODE;
+    tree -> constant[index] = coefficients[dimensions + 1];
+    tree -> first_term[index + 1] = dimensions + 1;
+  }
+
+  if (cur_node -> left != NULL) {
+    tree -> children[2 * index] = (*next)++;
+    flatten_subtree(tree, cur_node -> left, tree -> children[2 * index], next, nodes);
+  } else tree -> children[2 * index] = -add_leaf(tree, cur_node -> left_count, cur_node -> left_cat);
+
+  if (cur_node -> right != NULL) {
+    tree -> children[2 * index + 1] = (*next)++;
+    flatten_subtree(tree, cur_node -> right, tree -> children[2 * index + 1], next, nodes);
+  } else tree -> children[2 * index + 1] = -add_leaf(tree, cur_node -> right_count, cur_node -> right_cat);
+}
+
+/************************************************************************/
+/* Module name : add_leaf                                               */
+/* Functionality : Adds a leaf to a FLAT_TREE.                          */
+/* Parameters : tree : the FLAT_TREE being filled.                      */
+/*              count : number of training samples of each category     */
+/*              that reached the leaf (1..no_of_categories).            */
+/*              category : the category the leaf assigns.               */
+/* Returns : the number of the leaf.                                    */
+/* Calls modules : None.                                                */
+/* Is called by modules : flatten_tree                                  */
+/*                        flatten_subtree                               */
+/* Remarks : A leaf no training sample reached gets all of its          */
+/*           probability on its category.                               */
+/************************************************************************/
+int add_leaf(tree, count, category)
+FLAT_TREE *tree;
+int *count, category;
+{
+  int i, total, leaf = ++tree -> no_of_leaves;
+  double *probabilities = LEAF_PROBABILITIES(tree, leaf);
+
+  tree -> leaf_category[leaf] = category;
+
+  total = 0;
+  for (i = 1; i <= tree -> no_of_categories; i++) total += count[i];
+  for (i = 1; i <= tree -> no_of_categories; i++)
+    if (total > 0) probabilities[i] = (double) count[i] / total;
+    else probabilities[i] = (i == category);
+
+  return (leaf);
+}
+
+/************************************************************************/
+/* Module name : count_nodes                                            */
+/* Functionality : Counts the nodes of a decision tree.                 */
+/* Parameters : cur_node : root of the (sub)tree.                       */
+/* Returns : the number of nodes.                                       */
+/* Calls modules : count_nodes                                          */
+/* Is called by modules : flatten_tree                                  */
+/*                        count_nodes                                   */
+/************************************************************************/
+int count_nodes(cur_node)
+struct tree_node *cur_node;
+{
+  if (cur_node == NULL) return (0);
+  return (1 + count_nodes(cur_node -> left) + count_nodes(cur_node -> right));
+}
+
+/************************************************************************/
+/* Module name : free_flat_tree                                         */
+/* Functionality : Frees the memory allocated to a FLAT_TREE.           */
+/* Parameters : tree : the FLAT_TREE (may be NULL).                     */
+/* Returns : Nothing.                                                   */
+/* Calls modules : None.                                                */
+/* Is called by modules : classify (classify.c)                         */
+/*                        estimate_accuracy (classify.c)                */
+/*                        Tree.fit, Tree.__dealloc__ (_oblique.pyx)     */
+/************************************************************************/
+void free_flat_tree(tree)
+FLAT_TREE *tree;
+{
+  if (tree == NULL) return;
+  if (tree -> image != NULL) {
+    if (tree -> image_mapped) munmap(tree -> image, tree -> image_size);
+    else free(tree -> image);
+    free((char *) tree);
+    return;
+  }
+  free((char *) tree -> kind);
+  free((char *) tree -> first_term);
+  free((char *) tree -> attributes);
+  free((char *) tree -> coefficients);
+  free((char *) tree -> constant);
+  free((char *) tree -> children);
+  free_ivector(tree -> leaf_category, 1, tree -> no_of_nodes + 1);
+  free((char *) tree -> leaf_probabilities);
+  free((char *) tree);
+}
+
+/************************************************************************/
+/* Module name : flat_tree_leaf                                         */
+/* Functionality : Finds the leaf of a FLAT_TREE a sample reaches.      */
+/* Parameters : tree : the FLAT_TREE.                                   */
+/*              attributes : the attributes of the sample, indexed      */
+/*              1..no_of_dimensions (as the "dimension" field of a      */
+/*              POINT).                                                 */
+/* Returns : the number of the leaf.                                    */
+/* Calls modules : None.                                                */
+/* Is called by modules : flat_tree_category                            */
+/* Remarks : The child is chosen with a branch rather than by indexing  */
+/*           with the outcome of the comparison, so that the processor  */
+/*           can start loading the predicted child before the sum is    */
+/*           known.                                                     */
+/************************************************************************/
+int flat_tree_leaf(tree, attributes)
+FLAT_TREE *tree;
+double *attributes;
+{
+  int i, j, last, node, left;
+  double sum;
+
+  if (tree -> no_of_nodes == 0) return (1); /* The root is a leaf. */
+  node = 0;
+  do {
+    i = tree -> first_term[node];
+    if (tree -> kind[node] == THRESHOLD_NODE)
+      left = attributes[tree -> attributes[i]] < tree -> constant[node];
+    else {
+      sum = tree -> constant[node];
+      if (tree -> kind[node] == DENSE_NODE)
+        for (j = 1; j <= tree -> no_of_dimensions; j++, i++)
+          sum += tree -> coefficients[i] * attributes[j];
+      else
+        for (last = tree -> first_term[node + 1]; i < last; i++)
+          sum += tree -> coefficients[i] * attributes[tree -> attributes[i]];
+      left = sum < 0;
+    }
+    if (left) node = tree -> children[2 * node];
+    else node = tree -> children[2 * node + 1];
+  } while (node > 0);
+
+  return (-node);
+}
+
+/************************************************************************/
+/* Module name : flat_tree_category                                     */
+/* Functionality : Classifies one sample with a FLAT_TREE.              */
+/* Parameters : tree : the FLAT_TREE.                                   */
+/*              attributes : the attributes of the sample (1..).        */
+/* Returns : the category assigned to the sample.                       */
+/* Calls modules : flat_tree_leaf                                       */
+/* Is called by modules : classify_flat                                 */
+/*                        estimate_accuracy (classify.c)                */
+/************************************************************************/
+int flat_tree_category(tree, attributes)
+FLAT_TREE *tree;
+double *attributes;
+{
+  return (tree -> leaf_category[flat_tree_leaf(tree, attributes)]);
+}
+
+/************************************************************************/
+/* Module name : classify_flat                                          */
+/* Functionality : Sets the category of each of "points" to the one     */
+/*                 assigned by a FLAT_TREE.                             */
+/* Parameters : tree : the FLAT_TREE.                                   */
+/*              points : array of pointers to POINT structures.         */
+/*              no_of_points : number of samples.                       */
+/* Returns : Nothing.                                                   */
+/* Calls modules : flat_tree_category                                   */
+/* Is called by modules : classify (classify.c)                         */
+/************************************************************************/
+void classify_flat(tree, points, no_of_points)
+FLAT_TREE *tree;
+POINT **points;
+int no_of_points;
+{
+  int i;
+
+  for (i = 1; i <= no_of_points; i++)
+    points[i] -> category = flat_tree_category(tree, points[i] -> dimension);
+}
+
+/************************************************************************/
+/* Module name : classify_rows                                          */
+/* Functionality : Classifies a matrix of samples with a FLAT_TREE.     */
+/* Parameters : tree : the FLAT_TREE.                                   */
+/*              rows : the attributes of the samples, one sample after  */
+/*              the other (no_of_rows * no_of_dimensions values).       */
+/*              no_of_rows : number of samples.                         */
+/*              categories : set to the categories assigned to the     */
+/*              samples (1..no_of_rows).                                */
+/* Returns : Nothing.                                                   */
+/* Calls modules : find_leaves                                          */
+/* Is called by modules : Tree.predict (_oblique.pyx)                   */
+/************************************************************************/
+void classify_rows(tree, rows, no_of_rows, categories)
+FLAT_TREE *tree;
+double *rows;
+int no_of_rows, *categories;
+{
+  int i;
+
+  find_leaves(tree, rows, no_of_rows, categories);
+  for (i = 1; i <= no_of_rows; i++)
+    categories[i] = tree -> leaf_category[categories[i]];
+}
+
+/************************************************************************/
+/* Module name : rows_probabilities                                     */
+/* Functionality : Finds the probability of each category for a matrix */
+/*                 of samples, from the leaves of a FLAT_TREE.          */
+/* Parameters : tree : the FLAT_TREE.                                   */
+/*              rows : the attributes of the samples, one sample after  */
+/*              the other (no_of_rows * no_of_dimensions values).       */
+/*              no_of_rows : number of samples.                         */
+/*              probabilities : set to the probabilities, one sample    */
+/*              after the other (no_of_rows * no_of_categories values). */
+/* Returns : Nothing.                                                   */
+/* Calls modules : find_leaves                                          */
+/*                 ivector (util.c)                                     */
+/*                 free_ivector (util.c)                                */
+/* Is called by modules : Tree.predict_proba (_oblique.pyx)             */
+/************************************************************************/
+void rows_probabilities(tree, rows, no_of_rows, probabilities)
+FLAT_TREE *tree;
+double *rows, *probabilities;
+int no_of_rows;
+{
+  int i, *leaves, categories = tree -> no_of_categories;
+
+  if (no_of_rows <= 0) return;
+  leaves = ivector(1, no_of_rows);
+  find_leaves(tree, rows, no_of_rows, leaves);
+  for (i = 1; i <= no_of_rows; i++)
+    memcpy(probabilities + (size_t) (i - 1) * categories,
+           LEAF_PROBABILITIES(tree, leaves[i]) + 1, categories * sizeof(double));
+  free_ivector(leaves, 1, no_of_rows);
+}
+
+/************************************************************************/
+/* Module name : find_leaves                                            */
+/* Functionality : Finds the leaves a matrix of samples reach in a      */
+/*                 FLAT_TREE, a block of rows at a time.                */
+/* Parameters : tree : the FLAT_TREE.                                   */
+/*              rows : the attributes of the samples, one sample after  */
+/*              the other (no_of_rows * no_of_dimensions values).       */
+/*              no_of_rows : number of samples.                         */
+/*              leaves : set to the numbers of the leaves the samples   */
+/*              reach (1..no_of_rows).                                  */
+/* Returns : Nothing.                                                   */
+/* Calls modules : select_vector_kernels (vector_kernels.c)             */
+/*                 route_block                                          */
+/*                 error (util.c)                                       */
+/* Is called by modules : classify_rows                                 */
+/*                        rows_probabilities                            */
+/* Remarks : Instead of taking each sample from the root to a leaf, all */
+/*           the samples of a block are substituted into the root's     */
+/*           hyperplane, split into the ones going left and right, and  */
+/*           so on down the tree. Each hyperplane is then read once per */
+/*           block and applied to all the samples reaching it (by the   */
+/*           hyperplane_values kernel for DENSE_NODEs), while the block */
+/*           stays in cache.                                            */
+/*           The sums are the same as in flat_tree_leaf, and so are the */
+/*           leaves.                                                    */
+/************************************************************************/
+void find_leaves(tree, rows, no_of_rows, leaves)
+FLAT_TREE *tree;
+double *rows;
+int no_of_rows, *leaves;
+{
+  POINT_STORE block;
+  int i, first, block_size, *points;
+
+  if (no_of_rows <= 0) return;
+  if (tree -> no_of_nodes == 0) { /* The root is a leaf. */
+    for (i = 1; i <= no_of_rows; i++) leaves[i] = 1;
+    return;
+  }
+  select_vector_kernels();
+
+  block_size = CLASSIFY_BLOCK_SIZE;
+  if (block_size > no_of_rows) block_size = no_of_rows;
+
+  points = (int *) malloc(block_size * sizeof(int));
+  block.val = (double *) malloc(block_size * sizeof(double));
+  if (points == NULL || block.val == NULL)
+    error("Find_Leaves : Memory allocation failure.");
+  points--;
+  block.val--;
+  block.no_of_dimensions = tree -> no_of_dimensions;
+  block.column_major = NULL;
+  block.category = NULL;
+
+  for (first = 0; first < no_of_rows; first += block.no_of_points) {
+    block.no_of_points = no_of_rows - first;
+    if (block.no_of_points > block_size) block.no_of_points = block_size;
+    block.row_major = rows + (size_t) first * tree -> no_of_dimensions - 1;
+    for (i = 1; i <= block.no_of_points; i++) points[i] = i;
+    route_block(tree, &block, 0, points, block.no_of_points, leaves + first);
+  }
+
+  free((char *) (points + 1));
+  free((char *) (block.val + 1));
+}
+
+/************************************************************************/
+/* Module name : route_block                                            */
+/* Functionality : Finds the leaves the samples of a block that reach a */
+/*                 node go on to.                                       */
+/* Parameters : tree : the FLAT_TREE.                                   */
+/*              block : the samples of the block, as a point store.     */
+/*              node : the node.                                        */
+/*              points : indices (in the block) of the samples reaching */
+/*              the node (1..no_of_points). Reordered.                  */
+/*              no_of_points : number of such samples.                  */
+/*              leaves : leaves of the samples of the block.            */
+/* Returns : Nothing.                                                   */
+/* Calls modules : node_values                                          */
+/*                 route_block                                          */
+/* Is called by modules : find_leaves                                   */
+/*                        route_block                                   */
+/************************************************************************/
+void route_block(tree, block, node, points, no_of_points, leaves)
+FLAT_TREE *tree;
+POINT_STORE *block;
+int node, *points, no_of_points, *leaves;
+{
+  int i, left, right, temp, child;
+
+  if (no_of_points == 0) return;
+
+  node_values(tree, block, node, points, no_of_points);
+
+  /* Move the points going left to the front. */
+  left = 1;
+  right = no_of_points;
+  while (left <= right) {
+    if (block -> val[points[left]] < 0) left++;
+    else {
+      temp = points[left];
+      points[left] = points[right];
+      points[right--] = temp;
+    }
+  }
+
+  child = tree -> children[2 * node];
+  if (child > 0) route_block(tree, block, child, points, left - 1, leaves);
+  else for (i = 1; i < left; i++) leaves[points[i]] = -child;
+
+  child = tree -> children[2 * node + 1];
+  if (child > 0) route_block(tree, block, child, points + left - 1, no_of_points - left + 1, leaves);
+  else for (i = left; i <= no_of_points; i++) leaves[points[i]] = -child;
+}
+
+/************************************************************************/
+/* Module name : node_values                                            */
+/* Functionality : Sets the "val" fields of the samples of a block that */
+/*                 reach a node, to a number that is negative exactly   */
+/*                 when the sample goes left.                           */
+/* Parameters : tree : the FLAT_TREE.                                   */
+/*              block : the samples of the block, as a point store.     */
+/*              node : the node.                                        */
+/*              points : indices (in the block) of the samples          */
+/*              (1..no_of_points).                                      */
+/*              no_of_points : number of samples.                       */
+/* Returns : Nothing.                                                   */
+/* Calls modules : hyperplane_values (vector_kernels.c)                 */
+/* Is called by modules : route_block                                   */
+/************************************************************************/
+void node_values(tree, block, node, points, no_of_points)
+FLAT_TREE *tree;
+POINT_STORE *block;
+int node, *points, no_of_points;
+{
+  int i, j, first = tree -> first_term[node], last = tree -> first_term[node + 1];
+  double sum, *row;
+
+  switch (tree -> kind[node]) {
+  case DENSE_NODE:
+    (*hyperplane_values)(block, tree -> coefficients + first - 1, points, no_of_points);
+    break;
+  case SPARSE_NODE:
+    for (i = 1; i <= no_of_points; i++) {
+      row = ROW(block, points[i]);
+      sum = tree -> constant[node];
+      for (j = first; j < last; j++)
+        sum += tree -> coefficients[j] * row[tree -> attributes[j]];
+      block -> val[points[i]] = sum;
+    }
+    break;
+  case THRESHOLD_NODE:
+    j = tree -> attributes[first];
+    for (i = 1; i <= no_of_points; i++)
+      block -> val[points[i]] = ROW(block, points[i])[j] - tree -> constant[node];
+    break;
+  }
+}
+
+/************************************************************************/
+/************************************************************************/
@@ -21,7 +21,7 @@ char *pname;
 char test_data[LINESIZE],misclassified_data[LINESIZE];
 int unlabeled=FALSE,no_of_dimensions=0,no_of_categories=0;
 int verbose=FALSE,no_of_missing_values = 0;
-void srand48();
+extern unsigned short random_state[3];
 
 /************************************************************************/
 /* Module name : main							*/ 
@@ -91,7 +91,7 @@ main(argc,argv)
 	strcpy(test_data,optarg);
 	break;
       case 's':   /*Seed for the random number generator */
-	srand48(atol(optarg));
+	seed_random_state(random_state,atol(optarg));
 	break;
       case 't':
 	strcpy(test_data,optarg);
@@ -134,7 +134,7 @@ main(argc,argv)
   if (unlabeled != TRUE)
     {
       if (root != NULL)
-	classify(points_array,no_of_samples,root,test_data);
+	classify(points_array,no_of_samples,no_of_dimensions,root,NULL,test_data);
       else
 	{
 	  for (i=1;i<=no_of_samples;i++)
@@ -162,11 +162,10 @@ main(argc,argv)
       
       for (i=1;i<=no_of_categories;i++)
 	fprintf(stderr,"\tCategory %d : %d points\n",i,point_count[i]);
+      free_ivector(point_count,1,no_of_categories);
     }
   
   if (strlen(test_data)) printf("Instances written to %s.\n", test_data);
-  
-  free_ivector(point_count,1,no_of_categories);
 }
 
 /************************************************************************/
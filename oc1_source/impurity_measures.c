@@ -25,23 +25,24 @@
 /*			this file, so that the user needn't 	*/
 /*			bother with the global declarations and	*/
 /*			changing the makefile.			*/
-/*                      Note that none of the measure use any   */
-/*                      input parameters. The  only information */
-/*                      used is the number of dimensions, the   */
-/*                      number of  classes (categories) and the */
-/*                      counts of points of each class on the   */
-/*                      left and right of the hyperplane.       */
+/*                      Note that every measure takes only the  */
+/*                      TRAINING_CONTEXT as input. The only     */
+/*                      information used from it is the number  */
+/*                      of dimensions, the number of classes    */
+/*                      (categories) and the counts of points   */
+/*                      of each class on the left and right of  */
+/*                      the hyperplane.                         */
 /*                      All measures return a nonnegative double */
 /*                      impurity value, where the lower the     */
 /*                      impurity, the better the hyperplane.    */
 /*                      All measures are called from the module */
-/*                      Compute_Impurity.                       */
+/*                      Compute_Impurity, and from the sweeps   */
+/*                      of linear_split (perturb.c). A new one  */
+/*                      also needs an entry in the table of     */
+/*                      criteria in compute_impurity.c.         */
 /****************************************************************/		
 
 #include "oc1.h"
-extern int no_of_dimensions;
-extern int *left_count,*right_count;
-extern int no_of_categories;
 
 int largest_element();
 
@@ -57,19 +58,20 @@ int largest_element();
 /*		except the class with the highest count.)		*/
 /* Calls modules :	largest_element (compute_impurity.c)		*/
 /************************************************************************/
-double maxminority()
+double maxminority(context)
+     TRAINING_CONTEXT *context;
 {
   int i,j,lminor=0,rminor=0;
   
-  i = largest_element(left_count,no_of_categories);
-  if (i <= no_of_categories)
-    for (j=1;j<=no_of_categories ;j++) 
-      if (i != j) lminor += left_count[j];
+  i = largest_element(context->left_count,context->no_of_categories);
+  if (i <= context->no_of_categories)
+    for (j=1;j<=context->no_of_categories ;j++) 
+      if (i != j) lminor += context->left_count[j];
 
-  i = largest_element(right_count,no_of_categories);
-  if (i <= no_of_categories)
-    for (j=1;j<=no_of_categories ;j++) 
-      if (i != j) rminor += right_count[j];
+  i = largest_element(context->right_count,context->no_of_categories);
+  if (i <= context->no_of_categories)
+    for (j=1;j<=context->no_of_categories ;j++) 
+      if (i != j) rminor += context->right_count[j];
   
   if (lminor > rminor) 
     return((double)lminor);
@@ -88,19 +90,20 @@ double maxminority()
 /*		except the class with the highest count.)		*/
 /* Calls modules :	largest_element (compute_impurity.c)		*/
 /************************************************************************/
-double summinority()
+double summinority(context)
+     TRAINING_CONTEXT *context;
 {
   int i,j,lminor=0,rminor=0;
   
-  i = largest_element(left_count,no_of_categories);
-  if (i <= no_of_categories)
-    for (j=1;j<=no_of_categories ;j++) 
-      if (i != j) lminor += left_count[j];
+  i = largest_element(context->left_count,context->no_of_categories);
+  if (i <= context->no_of_categories)
+    for (j=1;j<=context->no_of_categories ;j++) 
+      if (i != j) lminor += context->left_count[j];
   
-  i = largest_element(right_count,no_of_categories);
-  if (i <= no_of_categories)
-    for (j=1;j<=no_of_categories ;j++) 
-      if (i != j) rminor += right_count[j];
+  i = largest_element(context->right_count,context->no_of_categories);
+  if (i <= context->no_of_categories)
+    for (j=1;j<=context->no_of_categories ;j++) 
+      if (i != j) rminor += context->right_count[j];
   
   return((double)(lminor+rminor));
 }
@@ -117,57 +120,58 @@ double summinority()
 /*		points on that side of the hyperplane, and		*/
 /*		avg = (x1+x2+..+xk)/k.					*/
 /************************************************************************/
-double variance()
+double variance(context)
+     TRAINING_CONTEXT *context;
 {
   double lavg=0,ravg=0,lerror = 0,rerror = 0;
   int i,lsum1=0,rsum1=0,lsum2=0,rsum2=0;
   int *temp1=NULL,*temp2=NULL;
   int var_compare();
 
-  if (no_of_categories > 2)
+  if (context->no_of_categories > 2)
     /* Renumber categories in descending order of their proportion of
        occurance. This removes the possibility for a biased impurity
        estimate. */
     {
-      temp1 = ivector(1,no_of_categories);
-      temp2 = ivector(1,no_of_categories);
-      for (i=1;i<=no_of_categories;i++)
+      temp1 = ivector(1,context->no_of_categories);
+      temp2 = ivector(1,context->no_of_categories);
+      for (i=1;i<=context->no_of_categories;i++)
 	{
-	  temp1[i] = left_count[i];
-	  temp2[i] = right_count[i];
+	  temp1[i] = context->left_count[i];
+	  temp2[i] = context->right_count[i];
 	} 
-      qsort((char *)(left_count+1),no_of_categories,sizeof(int),var_compare);
-      qsort((char *)(right_count+1),no_of_categories,sizeof(int),var_compare);
+      qsort((char *)(context->left_count+1),context->no_of_categories,sizeof(int),var_compare);
+      qsort((char *)(context->right_count+1),context->no_of_categories,sizeof(int),var_compare);
     }
      
-  for (i=1;i<=no_of_categories;i++)
+  for (i=1;i<=context->no_of_categories;i++)
     { 
-      lsum1 += left_count[i]; 
-      lsum2 += i * left_count[i];
-      rsum1 += right_count[i]; 
-      rsum2 += i * right_count[i];
+      lsum1 += context->left_count[i]; 
+      lsum2 += i * context->left_count[i];
+      rsum1 += context->right_count[i]; 
+      rsum2 += i * context->right_count[i];
     }
 
   if (lsum1 != 0) lavg = (double)lsum2/lsum1;
   if (rsum1 != 0) ravg = (double)rsum2/rsum1;
   
-  for (i=1;i<=no_of_categories;i++)
+  for (i=1;i<=context->no_of_categories;i++)
     {
-      lerror += left_count[i] * (i - lavg) * (i - lavg);
-      rerror += right_count[i] * (i - ravg) * (i - ravg);
+      lerror += context->left_count[i] * (i - lavg) * (i - lavg);
+      rerror += context->right_count[i] * (i - ravg) * (i - ravg);
     }
 
-  if (no_of_categories > 2)
+  if (context->no_of_categories > 2)
     /* Restore original left_count and right_count arrays.
        Remember, they are read_only. */
     {
-      for (i=1;i<=no_of_categories;i++)
+      for (i=1;i<=context->no_of_categories;i++)
 	{
-	  left_count[i] = temp1[i];
-	  right_count[i] = temp2[i];
+	  context->left_count[i] = temp1[i];
+	  context->right_count[i] = temp2[i];
 	} 
-      free_ivector(temp1,1,no_of_categories);
-      free_ivector(temp2,1,no_of_categories);
+      free_ivector(temp1,1,context->no_of_categories);
+      free_ivector(temp2,1,context->no_of_categories);
     }
 
   return (lerror+rerror);
@@ -198,56 +202,41 @@ int *p1,*p2;
 /*			the computed gain.				*/
 /* Remarks : Much less efficient to compute than the minority measures. */
 /*           But often works much better.                               */
+/*           The entropy of counts c_i adding up to n is                */
+/*           (n log n - sum c_i log c_i) / n, and the c log c are       */
+/*           looked up in context->n_log_n (see select_criterion).      */
 /************************************************************************/
-double info_gain()
+double info_gain(context)
+     TRAINING_CONTEXT *context;
 {
-  double presplit_info=0,postsplit_info=0,left_info=0,right_info=0;
-  double ratio,infogain;
+  double presplit_info=0,postsplit_info=0;
+  double infogain,*n_log_n = context->n_log_n;
   int i,total_count=0,total_left_count=0,total_right_count=0;
-  double mylog2();
   
-  for (i = 1;i<=no_of_categories;i++) 
+  for (i = 1;i<=context->no_of_categories;i++) 
     {
-      total_left_count += left_count[i];
-      total_right_count += right_count[i];
+      total_left_count += context->left_count[i];
+      total_right_count += context->right_count[i];
+      presplit_info -= n_log_n[context->left_count[i]+context->right_count[i]];
+      postsplit_info -= n_log_n[context->left_count[i]] + n_log_n[context->right_count[i]];
     }
   total_count = total_left_count + total_right_count;
+  if (!total_count) return(0);
 
-  if (total_count)
-    for (i = 1;i<=no_of_categories;i++)
-      {
-	ratio = (double)(left_count[i]+right_count[i])/total_count;
-	if (ratio) presplit_info += -1.0 * ratio * mylog2(ratio);
-      }
-  
-  if (total_left_count)
-    {
-      for (i = 1;i<=no_of_categories;i++)
-	{
-	  ratio = (double)left_count[i]/total_left_count;
-	  if (ratio) left_info += -1.0 * ratio * mylog2(ratio);
-	}
-      postsplit_info += total_left_count * left_info / total_count;
-    }
+  /* Both multiplied by total_count. */
+  presplit_info += n_log_n[total_count];
+  postsplit_info += n_log_n[total_left_count] + n_log_n[total_right_count];
   
-  if (total_right_count)
-    {
-      for (i = 1;i<=no_of_categories;i++)
-	{
-	  ratio = (double)right_count[i]/total_right_count;
-	  if (ratio) right_info += -1.0 * ratio * mylog2(ratio);
-	}
-      postsplit_info += total_right_count * right_info / total_count;
-    }
-  
-  infogain = presplit_info - postsplit_info;
+  infogain = (presplit_info - postsplit_info) / total_count;
   
-  if (infogain == 0) /*No information gained due to this split.
+  if (infogain <= NO_GAIN * presplit_info / total_count)
+                    /*No information gained due to this split.
 		       i.e., Either the region is homogenous or impurity 
-		       is as large as it can be. */
+		       is as large as it can be. (The two infos then
+		       differ by rounding errors only, either way.) */
     {
-      for (i=1;i<=no_of_categories;i++)
-	if (left_count[i] + right_count[i] == total_count) return(0);
+      for (i=1;i<=context->no_of_categories;i++)
+	if (context->left_count[i] + context->right_count[i] == total_count) return(0);
       return(HUGE_VAL);
     }
   else return(1.0/infogain);
@@ -262,23 +251,24 @@ double info_gain()
 /* Remarks : Efficient to compute - No log computations.                */
 /*           Performs quite well.                                       */
 /************************************************************************/
-double gini_index()
+double gini_index(context)
+     TRAINING_CONTEXT *context;
 {
   int total_left_count=0,total_right_count=0;
   double temp,gini_left=0,gini_right=0,gini_value;
   int i,j;
 
-  for (i=1;i<=no_of_categories;i++)
+  for (i=1;i<=context->no_of_categories;i++)
     {
-      total_left_count += left_count[i];
-      total_right_count += right_count[i];
+      total_left_count += context->left_count[i];
+      total_right_count += context->right_count[i];
     }
   
   if (total_left_count)
     {
-      for (i=1;i<=no_of_categories;i++)
+      for (i=1;i<=context->no_of_categories;i++)
 	{
-	  temp = (1.0 * left_count[i]) / total_left_count;
+	  temp = (1.0 * context->left_count[i]) / total_left_count;
 	  gini_left += temp * temp;
 	}
       gini_left = 1.0 - gini_left;
@@ -286,9 +276,9 @@ double gini_index()
   
   if (total_right_count)
     {
-      for (i=1;i<=no_of_categories;i++)
+      for (i=1;i<=context->no_of_categories;i++)
 	{
-	  temp = (1.0 * right_count[i]) / total_right_count;
+	  temp = (1.0 * context->right_count[i]) / total_right_count;
 	  gini_right += temp * temp;
 	}
       gini_right = 1.0 - gini_right;
@@ -304,49 +294,39 @@ double gini_index()
 /* Functionality :      Computes hellinger_distance of a hyperplane split.                                */
 /*                      A statistical measure of probability distribution divergence.  D. Cieslak, 2011.  */
 /* Remarks : Performs well on imbalanced data                                                             */
+/*           On a side with n points, c_i of category i (k categories), the sum over the pairs i < j of   */
+/*           (sqrt(c_i/n) - sqrt(c_j/n))^2 is k - (sum of the sqrt(c_i))^2 / n, as the c_i add up to n.   */
+/*           So it takes one pass over the categories, with the square roots looked up in                 */
+/*           context->square_root (see select_criterion).                                                 */
 /**********************************************************************************************************/
-double hellinger_distance()
+double hellinger_distance(context)
+     TRAINING_CONTEXT *context;
 {
   int total_left_count=0,total_right_count=0;
-  double class_i_prob,class_j_prob,hellinger_left=0,hellinger_right=0,dimension,hellinger_value;
-  int i,j;
+  double left_roots=0,right_roots=0,hellinger_left=0,hellinger_right=0,hellinger_value;
+  double *square_root = context->square_root;
+  int i,k = context->no_of_categories;
   double SQRT_TWO = sqrt(2);
 
-  for (i=1;i<=no_of_categories;i++)
+  for (i=1;i<=k;i++)
     {
-      total_left_count += left_count[i];
-      total_right_count += right_count[i];
+      total_left_count += context->left_count[i];
+      total_right_count += context->right_count[i];
+      left_roots += square_root[context->left_count[i]];
+      right_roots += square_root[context->right_count[i]];
     }
 
   if (total_left_count)
     {
-      for (i=1;i<=no_of_categories;i++)
-        {
-          for(j=i+1;j<=no_of_categories;j++)
-	    {
-              class_i_prob = (1.0 * left_count[i]) / total_left_count;
-              class_j_prob = (1.0 * left_count[j]) / total_left_count;
-              dimension = sqrt(class_i_prob) - sqrt(class_j_prob);
-              dimension *= dimension;
-              hellinger_left += dimension;
-            }	
-        }
+      hellinger_left = k - left_roots * left_roots / total_left_count;
+      if (hellinger_left < 0) hellinger_left = 0; /* Rounding errors. */
       hellinger_left = SQRT_TWO - sqrt(hellinger_left);
     }
 
   if (total_right_count)
     {
-      for (i=1;i<=no_of_categories;i++)
-        {
-          for(j=i+1;j<=no_of_categories;j++)
-            {
-              class_i_prob = (1.0 * right_count[i]) / total_right_count;
-              class_j_prob = (1.0 * right_count[j]) / total_right_count;
-	      dimension = sqrt(class_i_prob) - sqrt(class_j_prob);
-              dimension *= dimension;
-              hellinger_right += dimension;
-            }   
-        }
+      hellinger_right = k - right_roots * right_roots / total_right_count;
+      if (hellinger_right < 0) hellinger_right = 0;
       hellinger_right = SQRT_TWO - sqrt(hellinger_right);
     }
   hellinger_value = (total_left_count * hellinger_left + total_right_count * hellinger_right)/
@@ -364,26 +344,27 @@ double hellinger_distance()
 /*			The twoing measure is described in detail  	*/
 /*			by Leo Breiman et al in their CART book (1984).	*/
 /************************************************************************/
-double twoing()
+double twoing(context)
+     TRAINING_CONTEXT *context;
 {
   double total_left_count=0,total_right_count=0,total_count;
   double goodness=0,temp,twoing_val;
   int i;
   
-  for (i=1;i<=no_of_categories;i++)
+  for (i=1;i<=context->no_of_categories;i++)
     {
-      total_left_count += left_count[i];
-      total_right_count += right_count[i];
+      total_left_count += context->left_count[i];
+      total_right_count += context->right_count[i];
     }
   
   total_count = total_left_count + total_right_count;
   if (!total_count) return(0);
   
-  for (i=1;i<=no_of_categories;i++)
+  for (i=1;i<=context->no_of_categories;i++)
     {
       temp = 0;
-      if (total_left_count) temp = left_count[i]/total_left_count;
-      if (total_right_count) temp -= right_count[i]/total_right_count;
+      if (total_left_count) temp = context->left_count[i]/total_left_count;
+      if (total_right_count) temp -= context->right_count[i]/total_right_count;
       
       if (temp < 0) goodness += -1.0 * temp;
       else goodness += temp;
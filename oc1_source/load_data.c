@@ -10,6 +10,8 @@
 /* Last modified : June 1995					*/
 /* Contains modules : 	load_points				*/
 /*			allocate_point_array			*/
+/*			allocate_point_store			*/
+/*			free_point_store			*/
 /*			shuffle_points				*/
 /* Uses modules in :	oc1.h 					*/
 /*			util.c					*/
@@ -150,7 +152,7 @@ POINT ** * points_ptr; {
           no_of_missing_values++;
         } else {
           ungetc(c, infile);
-          fscanf(infile, "%f", & temp);
+          fscanf(infile, "%lf", & temp);
         }
       }
     } else {
@@ -163,7 +165,7 @@ POINT ** * points_ptr; {
           i = 1;
         } else {
           ungetc(c, infile);
-          i = fscanf(infile, "%f", & (array_name[point_count] -> dimension[j]));
+          i = fscanf(infile, "%lf", & (array_name[point_count] -> dimension[j]));
           if (i != 1) {
             if (j > 1) error("Load_Points1: Object with too few attributes.");
             else break;
@@ -298,6 +300,81 @@ int size, prev_size; {
   return (array_name);
 }
 
+/************************************************************************/
+/* Module name :	allocate_point_store				*/
+/* Functionality :	Copies an array of points into a POINT_STORE,	*/
+/*			laying out the attribute values contiguously	*/
+/*			both point after point and attribute after	*/
+/*			attribute (see oc1.h).				*/
+/* Parameters :	points : array of pointers to POINT structures.		*/
+/*		no_of_points : number of points.			*/
+/*		dimensions : number of attributes of each point.	*/
+/* Returns :	pointer to the allocated store.				*/
+/* Calls modules :	error (util.c)					*/
+/*			ivector (util.c)				*/
+/*			dvector (util.c)				*/
+/* Is called by modules : 	build_tree (mktree.c)			*/
+/************************************************************************/
+POINT_STORE * allocate_point_store(points, no_of_points, dimensions)
+POINT ** points;
+int no_of_points, dimensions; {
+  POINT_STORE * store;
+  size_t size;
+  int i, j;
+  double * row;
+
+  store = (POINT_STORE * ) malloc(sizeof(POINT_STORE));
+  if (!store)
+    error("Allocate_Point_Store : Memory Allocation Failure 1.");
+
+  store -> no_of_points = no_of_points;
+  store -> no_of_dimensions = dimensions;
+
+  size = (size_t) no_of_points * dimensions;
+  store -> row_major = (double * ) malloc((size + 1) * sizeof(double));
+  store -> column_major = (double * ) malloc((size + 1) * sizeof(double));
+  if (!store -> row_major || !store -> column_major)
+    error("Allocate_Point_Store : Memory Allocation Failure 2.");
+  /* All indices start from 1 */
+  store -> row_major -= 1;
+  store -> column_major -= 1;
+
+  store -> category = ivector(1, no_of_points);
+  store -> val = dvector(1, no_of_points);
+
+  for (i = 1; i <= no_of_points; i++) {
+    row = ROW(store, i);
+    for (j = 1; j <= dimensions; j++) {
+      row[j] = points[i] -> dimension[j];
+      COLUMN(store, j)[i] = points[i] -> dimension[j];
+    }
+    store -> category[i] = points[i] -> category;
+    store -> val[i] = points[i] -> val;
+  }
+
+  return (store);
+}
+
+/************************************************************************/
+/* Module name :	free_point_store				*/
+/* Functionality :	Frees a store allocated by allocate_point_store.*/
+/* Parameters :	store : pointer to the store.				*/
+/* Returns :	Nothing.						*/
+/* Calls modules :	free_ivector (util.c)				*/
+/*			free_dvector (util.c)				*/
+/* Is called by modules : 	build_tree (mktree.c)			*/
+/************************************************************************/
+free_point_store(store)
+POINT_STORE * store; {
+  if (store == NULL) return;
+
+  free((char * )(store -> row_major + 1));
+  free((char * )(store -> column_major + 1));
+  free_ivector(store -> category, 1, store -> no_of_points);
+  free_dvector(store -> val, 1, store -> no_of_points);
+  free((char * ) store);
+}
+
 /************************************************************************/
 /* Module name :	shuffle_points					*/
 /* Functionality :	Pseudo-randomly shuffles the points in the	*/
@@ -12,10 +12,27 @@
 /* Contains modules : 	main					*/
 /*			allocate_structures			*/
 /*			deallocate_structures			*/
+/*			initialize_context			*/
+/*			allocate_workers			*/
+/*			deallocate_workers			*/
+/*			allocate_restarts			*/
+/*			deallocate_restarts			*/
+/*			fork_context				*/
+/*			free_forked_context			*/
 /*			build_tree				*/
+/*			presort_points				*/
 /*			build_subtree				*/
+/*			split_node				*/
+/*			grow_best_first				*/
+/*			add_frontier_node			*/
+/*			pop_frontier_node			*/
+/*			partition_points			*/
+/*			partition_sorted_points			*/
+/*			grow_subtree				*/
 /*			axis_parallel_split			*/
 /*			oblique_split				*/
+/*			run_restart				*/
+/*			hill_climb				*/
 /*			cross_validate				*/
 /*			print_log_and_exit			*/
 /*			mktree_help				*/
@@ -23,11 +40,15 @@
 /*			util.c					*/
 /*			load_data.c				*/
 /*			classify.c				*/
-/*			train_util.c				*/
-/*			classify_util.c				*/
+/*			tree_util.c				*/
 /*			compute_impurity.c			*/
 /*			perturb.c				*/
 /*			prune.c					*/
+/*			thread_pool.c				*/
+/*			vector_kernels.c			*/
+/*			sort.c					*/
+/*			flat_tree.c				*/
+/*			model_file.c				*/
 /* Is used by modules in :	None.				*/
 /* Remarks       :	This file has the OC1 modules, that	*/
 /*			build the decision trees recursively.	*/
@@ -37,8 +58,11 @@
 char * pname;
 char dt_file[LINESIZE], animation_file[LINESIZE], train_data[LINESIZE];
 char test_data[LINESIZE], misclassified_data[LINESIZE];
-char log_file[LINESIZE];
+char log_file[LINESIZE], model_file[LINESIZE];
 
+/* Settings from the command line. The tree growing modules do not use */
+/* these directly; initialize_context copies them into the            */
+/* TRAINING_CONTEXT of each tree.                                      */
 int no_of_dimensions = 0, no_of_coeffs, no_of_categories = 0;
 int no_of_restarts = 20, no_of_folds = 0;
 int normalize = TRUE;
@@ -47,33 +71,33 @@ int order_of_perturbation = BEST_FIRST;
 int oblique = TRUE;
 int axis_parallel = TRUE;
 int cart_mode = FALSE;
-int coeff_modified = FALSE;
+int presort = FALSE;
+int max_bins = 0;
+int criterion = GINI_INDEX;
+int max_leaf_nodes = 0;
+int max_depth = 0, min_samples_split = 2, min_samples_leaf = 1;
+double min_impurity_decrease = 0;
+int max_climb_points = 0;
+int max_features = 0;
 int cycle_count = 0;
-int * left_count = NULL, * right_count = NULL;
 int max_no_of_random_perturbations = 5;
-int no_of_stagnant_perturbations, no_of_missing_values = 0;
+int no_of_threads = 1;
+int no_of_missing_values = 0;
 int no_of_train_points = 0, no_of_test_points = 0;
 int stop_splitting();
 
 double compute_impurity();
-double * coeff_array, * modified_coeff_array, * best_coeff_array;
 double prune_portion = 0.1;
 double myabs(), ap_bias = 1.0;
 double zeroing_tendency = 0.1;
-double * attribute_min, * attribute_avg, * attribute_sdev;
-double * temp_val;
 
-void srand48();
+extern unsigned short random_state[3];
 
-struct unidim * candidates;
 struct test_outcome estimate_accuracy();
 
-FILE * animationfile = NULL;
 FILE * perturb_file = NULL;
 
 POINT ** train_points = NULL, ** test_points = NULL;
-struct tree_node * sklearn_root_node = NULL;
-int no_of_train_points;
 /************************************************************************/
 /* Module name : main							*/
 /* Functionality :	Accepts user's options as input, sets control	*/
@@ -83,14 +107,20 @@ int no_of_train_points;
 /* Parameters :	argc,argv : See any standard C textbook for details.	*/
 /* Returns :	nothing.						*/
 /* Calls modules :	mktree_help 					*/
+/*			find_criterion (compute_impurity.c)		*/
 /*			print_log_and_exit				*/
 /*			read_data (load_data.c)				*/
+/*			initialize_context				*/
 /*			allocate_structures				*/
 /*			build_tree					*/
-/*			write_tree (train_util.c)			*/
+/*			write_header (tree_util.c)			*/
+/*			write_tree (tree_util.c)			*/
+/*			flatten_tree (flat_tree.c)			*/
+/*			write_model (model_file.c)			*/
+/*			free_flat_tree (flat_tree.c)			*/
 /*			cross_validate					*/
 /*			deallocate_structures				*/
-/*			read_tree (classify_util.c)			*/
+/*			read_tree (tree_util.c)			*/
 /*			estimate_accuracy (classify.c)			*/
 /*			classify (classify.c)				*/
 /* Is called by modules : None.						*/
@@ -103,12 +133,15 @@ char * argv[]; {
   int c1, leaf_count(), tree_depth();
   int i, j, no_of_correctly_classified_test_points;
   struct tree_node * root = NULL, * build_tree(), * read_tree();
+  int * root_count = NULL; /* Set once a tree is grown, if only a leaf. */
   struct test_outcome result;
+  TRAINING_CONTEXT context;
   double accuracy;
 
   strcpy(train_data, "\0");
   strcpy(test_data, "\0");
   strcpy(dt_file, "\0");
+  strcpy(model_file, "\0");
   strcpy(animation_file, "\0");
   strcpy(misclassified_data, "\0");
   strcpy(log_file, "oc1.log");
@@ -116,7 +149,7 @@ char * argv[]; {
   pname = argv[0];
   if (argc == 1) usage(pname);
   while ((c1 =
-      getopt(argc, argv, "aA:b:Bc:d:D:i:j:Kl:m:M:n:Nop:r:R:s:t:T:uvV:")) !=
+      getopt(argc, argv, "aA:b:Bc:C:d:D:E:f:F:g:H:i:j:Kl:L:m:M:n:NoP:p:q:Q:r:R:s:St:T:uvV:x:")) !=
     EOF)
 
     switch (c1) {
@@ -150,6 +183,13 @@ char * argv[]; {
       no_of_categories = atoi(optarg);
       if (no_of_categories <= 0) usage(pname);
       break;
+    case 'C':
+      /*Impurity measure : gini (the default), entropy,
+        twoing, hellinger, maxminority, summinority or
+        variance. */
+      criterion = find_criterion(optarg);
+      if (criterion < 0) usage(pname);
+      break;
     case 'd':
       no_of_dimensions = atoi(optarg);
       if (no_of_dimensions <= 0) usage(pname);
@@ -162,6 +202,40 @@ char * argv[]; {
       	  from this file. */
       strcpy(dt_file, optarg);
       break;
+    case 'E':
+      /*Minimum decrease of the impurity (see
+        split_node) for a node to be split.
+        Default = 0. */
+      min_impurity_decrease = atof(optarg);
+      if (min_impurity_decrease < 0) usage(pname);
+      break;
+    case 'f':
+      /*Number of attributes, chosen at random at each
+        node, the split of the node is searched on.
+        Default = 0, all the attributes. */
+      max_features = atoi(optarg);
+      if (max_features < 0) usage(pname);
+      break;
+    case 'F':
+      /*File into which the tree is written in the
+        binary model format of model_file.c, for
+        classification. */
+      strcpy(model_file, optarg);
+      break;
+    case 'g':
+      /*Number of points the hill climbing of an
+        oblique split is run on, at larger nodes.
+        Default = 0, all the points of the node. */
+      max_climb_points = atoi(optarg);
+      if (max_climb_points < 0) usage(pname);
+      break;
+    case 'H':
+      /*Number of bins the values are put in, when
+        searching for the best split of a large node.
+        Default = 0, search over all the values. */
+      max_bins = atoi(optarg);
+      if (max_bins < 2) usage(pname);
+      break;
     case 'i':
       /*No. of restarts at each node of the tree.
       	  Retained for compatibility with previous
@@ -186,6 +260,14 @@ char * argv[]; {
       	  OC1 is written. Default=oc1.log*/
       strcpy(log_file, optarg);
       break;
+    case 'L':
+      /*Maximum number of leaves. The tree is grown
+        best first, splitting the leaf that decreases
+        the impurity most, until it has this many.
+        Default = 0, no maximum. */
+      max_leaf_nodes = atoi(optarg);
+      if (max_leaf_nodes < 2) usage(pname);
+      break;
     case 'm':
       /*Maximum number of random perturbations tried when
       	  stuck in a local minimum. */
@@ -211,11 +293,30 @@ char * argv[]; {
       /*Oblique splits only */
       axis_parallel = FALSE;
       break;
+    case 'P':
+      /*Number of threads the tree is grown on. The
+        restarts at a node, and sibling subtrees, are
+        run in parallel. */
+      no_of_threads = atoi(optarg);
+      if (no_of_threads <= 0) usage(pname);
+      break;
     case 'p':
       prune_portion = atof(optarg);
       if (prune_portion < 0 ||
         prune_portion >= 1) usage(pname);
       break;
+    case 'q':
+      /*Minimum number of points in a node, for it
+        to be split. Default = 2. */
+      min_samples_split = atoi(optarg);
+      if (min_samples_split < 2) usage(pname);
+      break;
+    case 'Q':
+      /*Minimum number of points on each side of a
+        split. Default = 1. */
+      min_samples_leaf = atoi(optarg);
+      if (min_samples_leaf < 1) usage(pname);
+      break;
     case 'r':
       /*Number of restarts at each node of the tree. */
       if (oblique == FALSE) usage(pname);
@@ -229,7 +330,12 @@ char * argv[]; {
       break;
     case 's':
       /*Seed for the random number generator */
-      srand48(atol(optarg));
+      seed_random_state(random_state, atol(optarg));
+      break;
+    case 'S':
+      /*Sort the attribute values once, rather than at
+        every node, for the axis parallel splits. */
+      presort = TRUE;
       break;
     case 't':
       /*Data for training. */
@@ -255,6 +361,12 @@ char * argv[]; {
          This number can be -1, denoting "leave-one-out"
          cross-validation. */
       break;
+    case 'x':
+      /*Maximum depth of the tree, the root being at
+        depth 0. Default = 0, no maximum. */
+      max_depth = atoi(optarg);
+      if (max_depth < 1) usage(pname);
+      break;
     default:
       usage(pname);
     }
@@ -290,19 +402,44 @@ char * argv[]; {
         no_of_dimensions, no_of_categories);
     }
 
-    allocate_structures(no_of_train_points);
+    initialize_context( & context);
+    allocate_structures( & context, no_of_train_points);
+
+    /* initialize the animation file */
+    if (strlen(animation_file) && no_of_dimensions == 2 && no_of_folds == 0 &&
+      no_of_threads == 1) {
+      context.animationfile = fopen(animation_file, "w");
+      write_header(context.animationfile);
+      if (verbose) {
+        printf("All hyperplane perturbations being written to %s.\n",
+          animation_file);
+        printf("Use the Display() program for animation.\n");
+      }
+    }
 
     if (no_of_folds == 0) /* No cross validation. */ {
       if (!strlen(dt_file)) sprintf(dt_file, "%s.dt", train_data);
-      root = build_tree(train_points, no_of_train_points, dt_file);
+      root = build_tree( & context, train_points, no_of_train_points, dt_file);
+      root_count = context.root_count;
+      if (strlen(model_file)) {
+        FLAT_TREE *model = flatten_tree(root, no_of_dimensions, no_of_categories,
+          root_count);
+
+        if (!write_model(model, model_file)) {
+          fprintf(stderr, "Mktree: Cannot write %s.\n", model_file);
+          print_log_and_exit();
+        }
+        if (verbose) printf("Model written to %s.\n", model_file);
+        free_flat_tree(model);
+      }
     } else {
       if (no_of_folds == -1) no_of_folds = no_of_train_points;
       if (no_of_folds <= 1 || no_of_folds > no_of_train_points) usage(pname);
 
-      cross_validate(train_points, no_of_train_points);
+      cross_validate( & context, train_points, no_of_train_points);
     }
 
-    deallocate_structures(no_of_train_points);
+    deallocate_structures( & context, no_of_train_points);
 
     if (no_of_folds != 0) print_log_and_exit();
   }
@@ -319,7 +456,7 @@ char * argv[]; {
   }
 
   if (no_of_test_points) {
-    if (root == NULL) {
+    if (root == NULL && root_count == NULL) {
       if ((root = read_tree(dt_file)) != NULL) {
         if (verbose) printf("Decision tree read from %s.\n", dt_file);
       } else {
@@ -333,10 +470,11 @@ char * argv[]; {
       FILE * outfile;
 
       sprintf(out_file, "%s.classified", test_data);
-      classify(test_points, no_of_test_points, root, out_file);
+      classify(test_points, no_of_test_points, no_of_dimensions, root, root_count,
+        out_file);
       printf("Test instances with labels written to %s.\n", out_file);
     } else {
-      result = estimate_accuracy(test_points, no_of_test_points, root);
+      result = estimate_accuracy(test_points, no_of_test_points, root, root_count);
       printf("accuracy = %.2f\t#leaves = %.2f\tmax depth = %.2f\n",
         result.accuracy, result.leaf_count, result.tree_depth);
 
@@ -348,7 +486,7 @@ char * argv[]; {
               result.class[2 * i - 1], result.class[2 * i]);
     }
   } else {
-    result = estimate_accuracy(train_points, no_of_train_points, root);
+    result = estimate_accuracy(train_points, no_of_train_points, root, root_count);
     printf("acc. on training set = %.2f\t#leaves = %.0f\tmax depth = %.0f\n",
       result.accuracy, result.leaf_count, result.tree_depth);
 
@@ -365,96 +503,419 @@ char * argv[]; {
 
 /************************************************************************/
 /* Module name : allocate_structures					*/
-/* Functionality :	Allocates space for some global data structures.*/
-/* Parameters : no_of_points : size of the training dataset.		*/
+/* Functionality :	Allocates the work areas of a training context.	*/
+/* Parameters : context : the context, with no_of_dimensions and	*/
+/*		          no_of_categories set.				*/
+/*		no_of_points : size of the training dataset.		*/
 /* Returns :	nothing.						*/
 /* Calls modules :	vector (util.c)					*/
 /*			ivector (util.c)				*/
 /*			dvector (util.c)				*/
 /* Is called by modules :	main					*/
 /************************************************************************/
-allocate_structures(no_of_points)
+allocate_structures(context, no_of_points)
+TRAINING_CONTEXT * context;
 int no_of_points; {
   int i;
 
-  no_of_coeffs = no_of_dimensions + 1;
-  coeff_array = vector(1, no_of_coeffs);
-  modified_coeff_array = vector(1, no_of_coeffs);
-  best_coeff_array = vector(1, no_of_coeffs);
-  left_count = ivector(1, no_of_categories);
-  right_count = ivector(1, no_of_categories);
-  candidates = (struct unidim * ) malloc((unsigned) no_of_points *
+  context -> no_of_coeffs = context -> no_of_dimensions + 1;
+  context -> coeff_array = vector(1, context -> no_of_coeffs);
+  context -> modified_coeff_array = vector(1, context -> no_of_coeffs);
+  context -> left_count = ivector(1, context -> no_of_categories);
+  context -> right_count = ivector(1, context -> no_of_categories);
+  context -> candidates = (struct unidim * ) malloc((unsigned) no_of_points *
     sizeof(struct unidim));
-  candidates -= 1;
-  attribute_min = vector(1, no_of_dimensions);
-  attribute_avg = vector(1, no_of_dimensions);
-  attribute_sdev = vector(1, no_of_dimensions);
-  temp_val = dvector(1, no_of_points);
+  context -> candidates -= 1;
+  context -> sort_buffer = (struct unidim * ) malloc((unsigned) no_of_points *
+    sizeof(struct unidim));
+  context -> sort_keys = (unsigned long long * ) malloc((unsigned) 2 *
+    no_of_points * sizeof(unsigned long long));
+  context -> attribute_min = vector(1, context -> no_of_dimensions);
+  context -> temp_val = dvector(1, no_of_points);
+  context -> random_vector = vector(1, context -> no_of_coeffs);
+  context -> partition_buffer = ivector(1, no_of_points);
+  context -> features = ivector(1, context -> no_of_dimensions);
+  for (i = 1; i <= context -> no_of_dimensions; i++) context -> features[i] = i;
+  context -> no_of_features = context -> no_of_dimensions;
+  context -> climb_points = context -> climb_counts = NULL;
+  if (context -> max_climb_points && no_of_points > context -> max_climb_points) {
+    context -> climb_points = ivector(1, context -> max_climb_points +
+      context -> no_of_categories);
+    context -> climb_counts = ivector(1, 2 * context -> no_of_categories);
+  }
+  context -> bin_sample = NULL;
+  if (context -> max_bins) {
+    context -> bin_sample = (struct unidim * ) malloc((unsigned)
+      HISTOGRAM_SAMPLES_PER_BIN * context -> max_bins * sizeof(struct unidim));
+    context -> bin_sample -= 1;
+    context -> bin_edges = dvector(1, context -> max_bins);
+    context -> bin_min = dvector(1, context -> max_bins);
+    context -> bin_max = dvector(1, context -> max_bins);
+    context -> bin_counts = ivector(1, context -> max_bins * context -> no_of_categories);
+  }
 }
 
 /************************************************************************/
 /* Module name : deallocate_structures					*/
-/* Functionality : Frees space allocated to some global data structures.*/
-/* Parameters : no_of_points : size of the training dataset.		*/
+/* Functionality : Frees the work areas of a training context.		*/
+/* Parameters : context : the context passed to allocate_structures.	*/
+/*		no_of_points : size of the training dataset.		*/
 /* Returns :	nothing.						*/
 /* Calls modules :	free_vector (util.c)				*/
 /*			free_ivector (util.c)				*/
 /*			free_dvector (util.c)				*/
 /* Is called by modules :	main					*/
 /************************************************************************/
-deallocate_structures(no_of_points)
+deallocate_structures(context, no_of_points)
+TRAINING_CONTEXT * context;
+int no_of_points; {
+  free_vector(context -> coeff_array, 1, context -> no_of_coeffs);
+  free_vector(context -> modified_coeff_array, 1, context -> no_of_coeffs);
+  free_ivector(context -> left_count, 1, context -> no_of_categories);
+  free_ivector(context -> right_count, 1, context -> no_of_categories);
+  free((char * )(context -> candidates + 1));
+  free((char * ) context -> sort_buffer);
+  free((char * ) context -> sort_keys);
+  free_vector(context -> attribute_min, 1, context -> no_of_dimensions);
+  free_dvector(context -> temp_val, 1, no_of_points);
+  free_vector(context -> random_vector, 1, context -> no_of_coeffs);
+  free_ivector(context -> partition_buffer, 1, no_of_points);
+  free_ivector(context -> features, 1, context -> no_of_dimensions);
+  if (context -> climb_points != NULL) {
+    free_ivector(context -> climb_points, 1, context -> max_climb_points +
+      context -> no_of_categories);
+    free_ivector(context -> climb_counts, 1, 2 * context -> no_of_categories);
+  }
+  if (context -> bin_sample != NULL) {
+    free((char * )(context -> bin_sample + 1));
+    free_dvector(context -> bin_edges, 1, context -> max_bins);
+    free_dvector(context -> bin_min, 1, context -> max_bins);
+    free_dvector(context -> bin_max, 1, context -> max_bins);
+    free_ivector(context -> bin_counts, 1, context -> max_bins * context -> no_of_categories);
+  }
+  context -> coeff_array = context -> modified_coeff_array = NULL;
+  context -> attribute_min = NULL;
+  context -> left_count = context -> right_count = NULL;
+  context -> candidates = NULL;
+  context -> sort_buffer = NULL;
+  context -> sort_keys = NULL;
+  context -> partition_buffer = NULL;
+  context -> features = NULL;
+  context -> climb_points = context -> climb_counts = NULL;
+  context -> bin_sample = NULL;
+  context -> temp_val = NULL;
+  context -> random_vector = NULL;
+}
+
+/************************************************************************/
+/* Module name : initialize_context                                     */
+/* Functionality : Sets the parameters of a training context to the     */
+/*                 current settings (from the command line, or the      */
+/*                 defaults above), and clears its work areas.          */
+/* Parameters : context : the context to be initialized.                */
+/* Returns : Nothing.                                                   */
+/* Calls modules : None.                                                */
+/* Is called by modules : main                                          */
+/*                        Tree.fit (_oblique.pyx)                       */
+/* Remarks : The context continues the random number sequence of        */
+/*           myrandom (util.c), so a run seeded with -s grows the same  */
+/*           tree as it did when all the state was global.              */
+/************************************************************************/
+initialize_context(context)
+TRAINING_CONTEXT * context; {
+  int i;
+
+  context -> no_of_dimensions = no_of_dimensions;
+  context -> no_of_categories = no_of_categories;
+  context -> no_of_restarts = no_of_restarts;
+  context -> max_no_of_random_perturbations = max_no_of_random_perturbations;
+  context -> order_of_perturbation = order_of_perturbation;
+  context -> cycle_count = cycle_count;
+  context -> oblique = oblique;
+  context -> axis_parallel = axis_parallel;
+  context -> cart_mode = cart_mode;
+  context -> normalize = normalize;
+  context -> presort = presort;
+  context -> max_bins = max_bins;
+  context -> criterion = criterion;
+  context -> max_leaf_nodes = max_leaf_nodes;
+  context -> max_depth = max_depth;
+  context -> min_samples_split = min_samples_split;
+  context -> min_samples_leaf = min_samples_leaf;
+  context -> min_impurity_decrease = min_impurity_decrease;
+  context -> max_climb_points = max_climb_points;
+  context -> max_features = max_features;
+  context -> verbose = verbose;
+  context -> veryverbose = veryverbose;
+  context -> ap_bias = ap_bias;
+  context -> animationfile = NULL;
+  context -> last_split_id = context -> split_id = 0;
+  context -> split_parent = 0;
+  context -> split_side = LEFT;
+  for (i = 0; i < 3; i++) context -> random_state[i] = random_state[i];
+  context -> no_of_threads = no_of_threads;
+
+  context -> no_of_coeffs = no_of_dimensions + 1;
+  context -> coeff_array = context -> modified_coeff_array = NULL;
+  context -> attribute_min = NULL;
+  context -> left_count = context -> right_count = NULL;
+  context -> candidates = NULL;
+  context -> sort_buffer = NULL;
+  context -> sort_keys = NULL;
+  context -> partition_buffer = NULL;
+  context -> features = NULL;
+  context -> climb_points = context -> climb_counts = NULL;
+  context -> bin_sample = NULL;
+  context -> temp_val = NULL;
+  context -> random_vector = NULL;
+  context -> coeff_modified = FALSE;
+  context -> no_of_stagnant_perturbations = 0;
+  context -> n_log_n = context -> square_root = NULL;
+  context -> store = NULL;
+  context -> pool = NULL;
+  context -> thread_index = 0;
+  context -> presorted = NULL;
+  context -> workers = NULL;
+  context -> restarts = NULL;
+  context -> arena = NULL;
+  context -> arena_block = NULL;
+  context -> root = NULL;
+  context -> root_count = NULL;
+}
+
+/************************************************************************/
+/* Module name : allocate_workers                                       */
+/* Functionality : Sets up what oblique_split needs to run its restarts */
+/*                 in parallel : a worker context for each thread of    */
+/*                 context -> pool, and the restart structures.         */
+/* Parameters : context : a context with its work areas and store set.  */
+/* Returns : Nothing.                                                   */
+/* Calls modules : allocate_structures                                  */
+/*                 allocate_restarts                                    */
+/*                 dvector (util.c)                                     */
+/*                 error (util.c)                                       */
+/* Is called by modules : build_tree                                    */
+/* Remarks : A worker shares the attribute values and categories in the */
+/*           store of the context, but has its own "val" fields, as it  */
+/*           substitutes the points into its own hyperplanes.           */
+/************************************************************************/
+allocate_workers(context)
+TRAINING_CONTEXT * context; {
+  TRAINING_CONTEXT * worker;
+  int t, no_of_points = context -> store -> no_of_points;
+
+  if (context -> no_of_threads < 1) context -> no_of_threads = 1;
+  context -> workers = (TRAINING_CONTEXT * )
+    malloc(context -> no_of_threads * sizeof(TRAINING_CONTEXT));
+  if (context -> workers == NULL)
+    error("Allocate_Workers : Memory allocation failure.");
+
+  for (t = 0; t < context -> no_of_threads; t++) {
+    worker = & context -> workers[t];
+    * worker = * context;
+    allocate_structures(worker, no_of_points);
+    worker -> store = (POINT_STORE * ) malloc(sizeof(POINT_STORE));
+    if (worker -> store == NULL)
+      error("Allocate_Workers : Memory allocation failure.");
+    * worker -> store = * context -> store;
+    worker -> store -> val = dvector(1, no_of_points);
+    worker -> pool = NULL;
+    worker -> thread_index = t;
+    worker -> workers = NULL;
+    worker -> restarts = NULL;
+    worker -> arena_block = NULL;
+    worker -> root = NULL;
+  }
+
+  allocate_restarts(context);
+}
+
+/************************************************************************/
+/* Module name : deallocate_workers                                     */
+/* Functionality : Frees the worker contexts and restart structures set */
+/*                 up by allocate_workers.                              */
+/* Parameters : context : the context passed to allocate_workers.       */
+/* Returns : Nothing.                                                   */
+/* Calls modules : deallocate_restarts                                  */
+/*                 deallocate_structures                                */
+/*                 free_dvector (util.c)                                */
+/* Is called by modules : build_tree                                    */
+/************************************************************************/
+deallocate_workers(context)
+TRAINING_CONTEXT * context; {
+  TRAINING_CONTEXT * worker;
+  int t, no_of_points = context -> store -> no_of_points;
+
+  if (context -> workers == NULL) return;
+
+  deallocate_restarts(context);
+
+  for (t = 0; t < context -> no_of_threads; t++) {
+    worker = & context -> workers[t];
+    free_dvector(worker -> store -> val, 1, no_of_points);
+    free((char * ) worker -> store);
+    deallocate_structures(worker, no_of_points);
+  }
+  free((char * ) context -> workers);
+  context -> workers = NULL;
+}
+
+/************************************************************************/
+/* Module name : allocate_restarts                                      */
+/* Functionality : Allocates the restart structures of a context, that  */
+/*                 oblique_split keeps the hyperplanes of the restarts  */
+/*                 in.                                                  */
+/* Parameters : context : the context, with no_of_restarts set.         */
+/* Returns : Nothing.                                                   */
+/* Calls modules : vector (util.c)                                      */
+/*                 error (util.c)                                       */
+/* Is called by modules : allocate_workers                              */
+/*                        fork_context                                  */
+/************************************************************************/
+allocate_restarts(context)
+TRAINING_CONTEXT * context; {
+  int r;
+
+  context -> restarts = (struct restart * )
+    malloc(context -> no_of_restarts * sizeof(struct restart));
+  if (context -> restarts == NULL)
+    error("Allocate_Restarts : Memory allocation failure.");
+  context -> restarts -= 1;
+  for (r = 1; r <= context -> no_of_restarts; r++)
+    context -> restarts[r].coefficients = vector(1, context -> no_of_coeffs);
+}
+
+/************************************************************************/
+/* Module name : deallocate_restarts                                    */
+/* Functionality : Frees the restart structures of a context.           */
+/* Parameters : context : the context passed to allocate_restarts.      */
+/* Returns : Nothing.                                                   */
+/* Calls modules : free_vector (util.c)                                 */
+/* Is called by modules : deallocate_workers                            */
+/*                        free_forked_context                           */
+/************************************************************************/
+deallocate_restarts(context)
+TRAINING_CONTEXT * context; {
+  int r;
+
+  if (context -> restarts == NULL) return;
+
+  for (r = 1; r <= context -> no_of_restarts; r++)
+    free_vector(context -> restarts[r].coefficients, 1, context -> no_of_coeffs);
+  free((char * )(context -> restarts + 1));
+  context -> restarts = NULL;
+}
+
+/************************************************************************/
+/* Module name : fork_context                                           */
+/* Functionality : Creates a context for growing a subtree alongside    */
+/*                 the rest of the tree.                                */
+/* Parameters : context : the context the rest of the tree is grown in.*/
+/*              no_of_points : number of points in the subtree.         */
+/* Returns : the new context. It has its own work areas, sized for the  */
+/*           subtree, restart structures and arena block, and shares    */
+/*           the pool, workers, store and arena of "context".           */
+/* Calls modules : allocate_structures                                  */
+/*                 allocate_restarts                                    */
+/*                 error (util.c)                                       */
+/* Is called by modules : build_subtree                                 */
+/* Remarks : The store (including the "val" fields) can be shared, as   */
+/*           the subtrees grown at the same time have no points in      */
+/*           common.                                                    */
+/************************************************************************/
+TRAINING_CONTEXT * fork_context(context, no_of_points)
+TRAINING_CONTEXT * context;
 int no_of_points; {
-  free_vector(coeff_array, 1, no_of_coeffs);
-  free_vector(modified_coeff_array, 1, no_of_coeffs);
-  free_ivector(left_count, 1, no_of_categories);
-  free_ivector(right_count, 1, no_of_categories);
-  free_vector(best_coeff_array, 1, no_of_coeffs);
-  free((char * )(candidates + 1));
-  free_vector(attribute_min, 1, no_of_dimensions);
-  free_vector(attribute_avg, 1, no_of_dimensions);
-  free_vector(attribute_sdev, 1, no_of_dimensions);
-  free_dvector(temp_val, 1, no_of_points);
+  TRAINING_CONTEXT * fork;
+
+  fork = (TRAINING_CONTEXT * ) malloc(sizeof(TRAINING_CONTEXT));
+  if (fork == NULL) error("Fork_Context : Memory allocation failure.");
+
+  * fork = * context;
+  allocate_structures(fork, no_of_points);
+  fork -> restarts = NULL;
+  if (context -> workers != NULL) allocate_restarts(fork);
+  fork -> coeff_modified = FALSE;
+  fork -> arena_block = NULL;
+  fork -> root = NULL;
+  return (fork);
+}
+
+/************************************************************************/
+/* Module name : free_forked_context                                    */
+/* Functionality : Frees a context created by fork_context.             */
+/* Parameters : context : the context.                                  */
+/*              no_of_points : as passed to fork_context.               */
+/* Returns : Nothing.                                                   */
+/* Calls modules : deallocate_restarts                                  */
+/*                 deallocate_structures                                */
+/* Is called by modules : grow_subtree                                  */
+/************************************************************************/
+free_forked_context(context, no_of_points)
+TRAINING_CONTEXT * context;
+int no_of_points; {
+  deallocate_restarts(context);
+  deallocate_structures(context, no_of_points);
+  free((char * ) context);
 }
 
 /************************************************************************/
 /* Module name : Build_Tree                                             */
 /* Functionality : Top level tree to induce, prune and write a decision */
 /*                 tree to a file.                                      */
-/* Parameters : points = array of training instances                    */
+/* Parameters : context = training context, see initialize_context     */
+/*              points = array of training instances                    */
 /*              no_of_points = instance count                           */
 /*              dt_file = file into which the decision tree is to be    */
 /*                        written.                                      */
-/* Returns :    Pointer to the root of the tree induced.                */
+/* Returns :    Pointer to the root of the tree induced (also left in   */
+/*              context -> root), NULL if no split could be found. The  */
+/*              tree is then a single leaf, with the samples of each    */
+/*              category in context -> root_count.                      */
+/*              The tree lasts until free_arena(context -> arena).      */
 /* Calls modules :  build_subtree                                       */
+/*                  grow_best_first                                     */
 /*                  prune (prune.c)                                     */
-/*                  write_tree (train_util.c)                           */
+/*                  write_tree (tree_util.c)                            */
+/*                  number_nodes (tree_util.c)                          */
 /*                  allocate_point_array (load_data.c)                  */
+/*                  allocate_point_store (load_data.c)                  */
+/*                  free_point_store (load_data.c)                      */
+/*                  select_vector_kernels (vector_kernels.c)            */
+/*                  select_criterion (compute_impurity.c)               */
+/*                  free_criterion_tables (compute_impurity.c)          */
+/*                  create_thread_pool (thread_pool.c)                  */
+/*                  destroy_thread_pool (thread_pool.c)                 */
+/*                  create_arena (arena.c)                              */
+/*                  arena_allocate (arena.c)                            */
+/*                  allocate_workers                                    */
+/*                  deallocate_workers                                  */
+/*                  presort_points                                      */
 /* Is called by modules : main                                          */
 /*                        cross_validate                                */
-/* Important Variables used :                                           */
+/* Important Variables used : context -> store : contiguous copy of    */
+/*                            "points" that the tree growing modules    */
+/*                            work on.                                  */
+/*                            context -> presorted : the points sorted  */
+/*                            along each attribute, if presort is set   */
+/*                            and axis parallel splits are searched.    */
 /* Remarks :                                                            */
 /************************************************************************/
-struct tree_node * build_tree(points, no_of_points, dt_file)
+struct tree_node * build_tree(context, points, no_of_points, dt_file)
+TRAINING_CONTEXT * context;
 struct point ** points;
 int no_of_points;
 char * dt_file; {
-  struct tree_node * prune(), * root, * build_subtree();
+  struct tree_node * prune(), * root, * build_subtree(), * grow_best_first();
+  int * presort_points();
   struct point ** allocate_point_array(), ** ptest_points = NULL;
   struct point ** train_points = NULL;
   struct test_outcome result;
   struct tree_node * proot;
+  POINT_STORE * allocate_point_store();
+  THREAD_POOL * create_thread_pool();
   int i, j, k, no_of_ptest_points, no_of_train_points;
-  /* initialize the animation file */
-  if (strlen(animation_file) && no_of_dimensions == 2 && no_of_folds == 0) {
-    animationfile = fopen(animation_file, "w");
-    if (verbose) {
-      printf("All hyperplane perturbations being written to %s.\n",
-        animation_file);
-      printf("Use the Display() program for animation.\n");
-    }
-  }
-
-//  write_header(animationfile);
+  int * train_index;
 
 //  /* divide the training instances into a training set and a pruning set*/
 //  no_of_ptest_points = (int)(no_of_points * prune_portion);
@@ -489,14 +950,47 @@ char * dt_file; {
 
 
 
-  /* Build the tree recursively. */
-  root = build_subtree("\0", train_points, no_of_train_points);
+  context -> store = allocate_point_store(train_points, no_of_train_points,
+    context -> no_of_dimensions);
+  train_index = ivector(1, no_of_train_points);
+  for (i = 1; i <= no_of_train_points; i++) train_index[i] = i;
+  select_vector_kernels();
+  select_criterion(context, no_of_train_points);
+  context -> arena = create_arena();
+  context -> arena_block = NULL;
+  context -> root_count = (int *) arena_allocate(context,
+    context -> no_of_categories * sizeof(int)) - 1;
+  for (i = 1; i <= context -> no_of_categories; i++) context -> root_count[i] = 0;
+  for (i = 1; i <= no_of_train_points; i++)
+    context -> root_count[train_points[i] -> category]++;
+  context -> pool = create_thread_pool(context -> no_of_threads);
+  context -> thread_index = 0;
+  context -> last_split_id = context -> split_parent = 0;
+  if (context -> oblique && !context -> cart_mode) allocate_workers(context);
+  if (context -> presort && (context -> axis_parallel || context -> cart_mode))
+    context -> presorted = presort_points(context);
+
+  /* Build the tree recursively, or best first within max_leaf_nodes. */
+  if (context -> max_leaf_nodes)
+    root = grow_best_first(context, train_index, no_of_train_points,
+      context -> presorted);
+  else root = build_subtree(context, 0, train_index, no_of_train_points,
+    context -> presorted);
+
+  if (context -> presorted != NULL) {
+    free_ivector(context -> presorted, 1,
+      context -> no_of_dimensions * no_of_train_points);
+    context -> presorted = NULL;
+  }
+  deallocate_workers(context);
+  destroy_thread_pool(context -> pool);
+  context -> pool = NULL;
+  free_criterion_tables(context, no_of_train_points);
+  free_ivector(train_index, 1, no_of_train_points);
+  free_point_store(context -> store);
+  context -> store = NULL;
 
-  if (root == NULL) {
-    fprintf(stderr, "No split could be found with the current parameter settings.\n");
-    fprintf(stderr, "Try increasing the values of restarts and random jumps.\n");
-    print_log_and_exit();
-  } else root -> parent = NULL;
+  if (root != NULL) root -> parent = NULL;
 
 //  /* Prune.*/
 //  if (prune_portion != 0)
@@ -521,180 +1015,581 @@ char * dt_file; {
 //  }
 
   root = proot;
+  number_nodes(root, 1, 0);
+  context -> root = root;
   return (root);
 
 }
 
+/************************************************************************/
+/* Module name : presort_points                                         */
+/* Functionality : Sorts all the points of the store along each         */
+/*                 attribute, for the root of the tree.                 */
+/* Parameters : context : a context with its work areas and store set.  */
+/* Returns : the sorted lists, laid out as described at SORTED (oc1.h). */
+/* Calls modules : ivector (util.c)                                     */
+/*                 sort_candidates (sort.c)                             */
+/* Is called by modules : build_tree                                    */
+/* Remarks : The "cat" fields of the candidates are used for the        */
+/*           indices of the points, while sorting.                      */
+/************************************************************************/
+int * presort_points(context)
+TRAINING_CONTEXT * context; {
+  POINT_STORE * store = context -> store;
+  int i, j, * presorted, * sorted;
+  double * column;
+
+  presorted = ivector(1, store -> no_of_dimensions * store -> no_of_points);
+  for (j = 1; j <= store -> no_of_dimensions; j++) {
+    column = COLUMN(store, j);
+    for (i = 1; i <= store -> no_of_points; i++) {
+      context -> candidates[i].value = column[i];
+      context -> candidates[i].cat = i;
+    }
+    sort_candidates(context -> candidates, store -> no_of_points,
+      context -> sort_buffer, context -> sort_keys);
+
+    sorted = SORTED(store, presorted, j);
+    for (i = 1; i <= store -> no_of_points; i++)
+      sorted[i] = context -> candidates[i].cat;
+  }
+  return (presorted);
+}
+
 /************************************************************************/
 /* Module name : build_subtree						*/
 /* Functionality :	Recursively builds a decision tree. i.e., finds	*/
 /*			the best (heuristic) hyperplane separating the 	*/
 /*			given set of points, and recurses on both sides	*/
-/*			of the hyperplane. The best axis-parallel split	*/
-/*			is considered if -o option is not chosen, 	*/
-/*			before computing oblique splits.		*/
-/* Parameters :	node_str : Label to be assigned to the decision tree	*/
-/*		           node to be created. 				*/
-/*		cur_points : array of pointers to the points under	*/
-/*		             consideration.			       	*/
+/*			of the hyperplane.				*/
+/* Parameters :	depth : depth of the decision tree node to be created,	*/
+/*		        0 for the root.					*/
+/*		cur_points : indices (in the store) of the points	*/
+/*		             under consideration.		       	*/
 /*		cur_no_of_points : Number of points.	                */
+/*		sorted_points : the points sorted along each attribute	*/
+/*		                (see SORTED in oc1.h), or NULL if the	*/
+/*		                tree is grown without presort.		*/
 /* Returns :	pointer to the decision tree node created.		*/
 /*		NULL, if a node couldn't be created.			*/
-/* Calls modules :	set_counts (compute_impurity.c)			*/
-/*			compute_impurity (compute_impurity.c)		*/
-/*			axis_parallel_split				*/
-/*			vector (util.c)					*/
-/*			oblique_split					*/
-/*			free_vector (util.c)				*/
-/*			error (util.c)					*/
-/*			find_values (perturb.c)				*/
-/*			largest_element (compute_impurity.c)		*/
+/* Calls modules :	split_node					*/
 /*			build_subtree					*/
+/*			myrandom_r (util.c)				*/
+/*			seed_random_state (util.c)			*/
+/*			fork_context					*/
+/*			partition_points				*/
+/*			partition_sorted_points				*/
+/*			submit_task (thread_pool.c)			*/
+/*			wait_for_tasks (thread_pool.c)			*/
 /* Is called by modules : 	main					*/
 /*				build_tree				*/
 /*				build_subtree				*/
+/*				grow_subtree				*/
 /*				cross_validate				*/
-/* Important Variables used : 	initial_impurity: "inherent" impurity in*/
-/*				the point set under consideration. ie.,	*/
-/*				impurity when the separating hyperplane	*/
-/*				lies on one side of the point set.	*/
-/*				If any amount of perturbations (bounded	*/
-/*				by the parametric settings) can not	*/
-/*				result in a hyperplane that has a lesser*/
-/*				impurity than this value, no new tree	*/
-/*				node is created.			*/
-/************************************************************************/
-struct tree_node * build_subtree(node_str, cur_points, cur_no_of_points)
-char * node_str;
-POINT ** cur_points;
-int cur_no_of_points; {
+/* Remarks :	The points of the node are split in place into those of	*/
+/*		the children: the left child gets the first lpt entries	*/
+/*		of cur_points, and the right child the rest. With	*/
+/*		presort, the sorted lists of the node are split the	*/
+/*		same way. So the points of the nodes being grown are	*/
+/*		disjoint ranges of the index array of build_tree, and	*/
+/*		need no more memory than those of the root.		*/
+/************************************************************************/
+struct tree_node * build_subtree(context, depth, cur_points, cur_no_of_points,
+  sorted_points)
+TRAINING_CONTEXT * context;
+int depth;
+int * cur_points;
+int cur_no_of_points;
+int * sorted_points; {
   struct tree_node * cur_node;
-  struct tree_node * build_subtree(), * create_tree_node();
-  POINT ** lpoints = NULL, ** rpoints = NULL;
-  int i, lindex, rindex, lpt, rpt;
-  double oblique_split(), axis_parallel_split(), cart_split();
+  struct tree_node * build_subtree(), * split_node();
+  struct subtree subtrees[2], * subtree;
+  TRAINING_CONTEXT * fork_context();
+  TASK_GROUP tasks;
+  int i, side, lpt, rpt;
   double initial_impurity, cur_impurity;
-  char lnode_str[MAX_DT_DEPTH], rnode_str[MAX_DT_DEPTH];
+  void grow_subtree();
+
+  cur_node = split_node(context, depth, cur_points, cur_no_of_points,
+    sorted_points, & initial_impurity, & cur_impurity);
+  if (cur_node == NULL) return (NULL);
+  if (cur_impurity == 0) return (cur_node);
+
+  for (i = 1, lpt = 0, rpt = 0; i <= context -> no_of_categories; i++) {
+    lpt += context -> left_count[i];
+    rpt += context -> right_count[i];
+  }
+
+  partition_points(context, cur_points, cur_no_of_points);
+  if (sorted_points != NULL)
+    partition_sorted_points(context, sorted_points, cur_no_of_points);
+
+  /* Each subtree gets a random number sequence of its own, so that the */
+  /* tree does not depend on the order the subtrees are grown in. The   */
+  /* left subtree is grown by another thread, if one is free and it is  */
+  /* worth the overhead; the right one by this thread. Homogeneous      */
+  /* regions are left as leaves (cur_points NULL).                      */
+  subtrees[LEFT].cur_points =
+    (context -> left_count[cur_node -> left_cat] != lpt) ? cur_points : NULL;
+  subtrees[LEFT].cur_no_of_points = lpt;
+  subtrees[LEFT].sorted_points = sorted_points;
+  subtrees[RIGHT].cur_points =
+    (context -> right_count[cur_node -> right_cat] != rpt) ? cur_points + lpt : NULL;
+  subtrees[RIGHT].cur_no_of_points = rpt;
+  subtrees[RIGHT].sorted_points =
+    (sorted_points == NULL) ? NULL : sorted_points + lpt;
+  tasks.pending = 0;
+
+  for (side = LEFT; side <= RIGHT; side++) {
+    subtree = & subtrees[side];
+    subtree -> context = context;
+    subtree -> root = NULL;
+    subtree -> depth = depth + 1;
+    seed_random_state(subtree -> random_state,
+      (long) myrandom_r(0.0, 2147483647.0, context -> random_state));
+  }
+
+  for (side = LEFT; side <= RIGHT; side++) {
+    subtree = & subtrees[side];
+    if (subtree -> cur_points == NULL) continue;
+    if (side == LEFT && subtrees[RIGHT].cur_points != NULL &&
+      context -> pool != NULL &&
+      lpt >= TOO_SMALL_FOR_SUBTREE_TASK) {
+      subtree -> context = fork_context(context, lpt);
+      submit_task(context -> pool, & tasks, grow_subtree, subtree,
+        context -> thread_index);
+    } else {
+      for (i = 0; i < 3; i++) context -> random_state[i] = subtree -> random_state[i];
+      context -> split_parent = cur_node -> id;
+      context -> split_side = side;
+      subtree -> root = build_subtree(context, subtree -> depth,
+        subtree -> cur_points, subtree -> cur_no_of_points,
+        subtree -> sorted_points);
+    }
+  }
+  wait_for_tasks(context -> pool, & tasks, context -> thread_index);
+
+  cur_node -> left = subtrees[LEFT].root;
+  if (cur_node -> left != NULL)(cur_node -> left) -> parent = cur_node;
+  cur_node -> right = subtrees[RIGHT].root;
+  if (cur_node -> right != NULL)(cur_node -> right) -> parent = cur_node;
+
+  return (cur_node);
+
+}
+
+/************************************************************************/
+/* Module name : split_node						*/
+/* Functionality :	Finds the best (heuristic) hyperplane separating*/
+/*			the given set of points, and makes a tree node	*/
+/*			of it. The best axis-parallel split is		*/
+/*			considered if -o option is not chosen, before	*/
+/*			computing oblique splits.			*/
+/* Parameters :	as for build_subtree.					*/
+/*		initial_impurity : set to the "inherent" impurity of	*/
+/*		                   the point set under consideration.	*/
+/*		                   ie., impurity when the separating	*/
+/*		                   hyperplane lies on one side of the	*/
+/*		                   point set.				*/
+/*		split_impurity : set to the impurity of the hyperplane.	*/
+/* Returns :	pointer to the decision tree node created, without	*/
+/*		children. The "val" fields of the points are left set	*/
+/*		to the hyperplane, as partition_points needs them.	*/
+/*		NULL, if any amount of perturbations (bounded by the	*/
+/*		parametric settings) can not result in a hyperplane	*/
+/*		that has a lesser impurity than the initial one, or	*/
+/*		if the node is not to be split (see Remarks).		*/
+/* Calls modules :	choose_features					*/
+/*			set_counts (compute_impurity.c)			*/
+/*			compute_impurity (compute_impurity.c)		*/
+/*			axis_parallel_split				*/
+/*			vector (util.c)					*/
+/*			oblique_split					*/
+/*			free_vector (util.c)				*/
+/*			find_values (perturb.c)				*/
+/*			impurity_decrease (compute_impurity.c)		*/
+/*			create_tree_node				*/
+/*			write_hyperplane				*/
+/* Is called by modules : 	build_subtree				*/
+/*				add_frontier_node			*/
+/* Remarks :	Nodes deeper than max_depth, or with fewer points than	*/
+/*		min_samples_split or two leaves of min_samples_leaf,	*/
+/*		are not split, and are not searched. Splits leaving	*/
+/*		fewer than min_samples_leaf points on a side are	*/
+/*		passed over by the search (see compute_impurity). A	*/
+/*		split must also decrease the impurity, summed over the	*/
+/*		points of the node and averaged over the training set,	*/
+/*		by min_impurity_decrease at least.			*/
+/*		With max_features, the split is searched on a random	*/
+/*		subset of the attributes (see choose_features).		*/
+/*		The impurity of the split is recomputed from the counts	*/
+/*		of the hyperplane found, and a hyperplane leaving all	*/
+/*		the points on one side is not a split.			*/
+/*		With an animation file, the node is given the next	*/
+/*		provisional id before it is searched (see		*/
+/*		write_hyperplane). The tree is numbered again once it	*/
+/*		is grown.						*/
+/************************************************************************/
+struct tree_node * split_node(context, depth, cur_points, cur_no_of_points,
+  sorted_points, initial_impurity, split_impurity)
+TRAINING_CONTEXT * context;
+int depth;
+int * cur_points;
+int cur_no_of_points;
+int * sorted_points;
+double * initial_impurity, * split_impurity; {
+  struct tree_node * cur_node, * create_tree_node();
+  int i;
+  double oblique_split(), axis_parallel_split(), cart_split();
+  double cur_impurity, impurity_decrease();
+  int lpt, rpt;
 
   //printf("Current number of points %i\n", cur_no_of_points);
   /* Validation checks */
   if (cur_no_of_points <= TOO_SMALL_FOR_ANY_SPLIT) return (NULL);
-  if (strlen(node_str) + 1 > MAX_DT_DEPTH) {
-    fprintf(stderr, "Tree growing aborted along this branch. \n");
-    fprintf(stderr, "Depth cannot be more than MAX_DT_DEPTH, set in oc1.h.\n");
-    return (NULL);
-  }
+  if (context -> max_depth && depth >= context -> max_depth) return (NULL);
+  if (cur_no_of_points < context -> min_samples_split ||
+    cur_no_of_points < 2 * context -> min_samples_leaf) return (NULL);
 
-  set_counts(cur_points, cur_no_of_points, 0);
+  if (context -> animationfile != NULL) context -> split_id = ++context -> last_split_id;
 
-  cur_impurity = initial_impurity = compute_impurity(cur_no_of_points);
+  if (context -> max_features && context -> max_features < context -> no_of_dimensions)
+    choose_features(context);
+
+  set_counts(context, cur_points, cur_no_of_points, 0);
+
+  cur_impurity = * initial_impurity = compute_impurity(context, cur_no_of_points);
   if (cur_impurity == 0.0) return (NULL);
 
-  if (cart_mode) {
-    cur_impurity = axis_parallel_split(cur_points, cur_no_of_points);
-    if (cur_impurity && (strlen(node_str) == 0 ||
-        cur_no_of_points > TOO_SMALL_FOR_OBLIQUE_SPLIT))
-      cur_impurity = cart_split(cur_points, cur_no_of_points, node_str);
+  if (context -> cart_mode) {
+    cur_impurity = axis_parallel_split(context, cur_points, cur_no_of_points,
+      sorted_points);
+    if (cur_impurity && (depth == 0 ||
+        cur_no_of_points > TOO_SMALL_FOR_OBLIQUE_SPLIT(context)))
+      cur_impurity = cart_split(context, cur_points, cur_no_of_points);
   } else {
-    if (axis_parallel)
-      cur_impurity = axis_parallel_split(cur_points, cur_no_of_points);
+    if (context -> axis_parallel)
+      cur_impurity = axis_parallel_split(context, cur_points, cur_no_of_points,
+        sorted_points);
 
-    if (cur_impurity && oblique && cur_no_of_points > TOO_SMALL_FOR_OBLIQUE_SPLIT) {
+    if (cur_impurity && context -> oblique &&
+      cur_no_of_points > TOO_SMALL_FOR_OBLIQUE_SPLIT(context)) {
       double * ap_coeff_array, oblique_impurity;
 
-      ap_coeff_array = vector(1, no_of_coeffs);
-      for (i = 1; i <= no_of_coeffs; i++) ap_coeff_array[i] = coeff_array[i];
+      ap_coeff_array = vector(1, context -> no_of_coeffs);
+      for (i = 1; i <= context -> no_of_coeffs; i++) ap_coeff_array[i] = context -> coeff_array[i];
 
-      if (normalize) normalize_data(cur_points, cur_no_of_points);
-      oblique_impurity = oblique_split(cur_points, cur_no_of_points, node_str);
-      if (normalize) {
-        unnormalize_data(cur_points, cur_no_of_points);
-        unnormalize_hyperplane();
-        for (i = 1; i <= no_of_dimensions; i++) attribute_min[i] = 0;
+      if (context -> normalize) normalize_data(context, cur_points, cur_no_of_points);
+      oblique_impurity = oblique_split(context, cur_points, cur_no_of_points);
+      if (context -> normalize) {
+        unnormalize_data(context, cur_points, cur_no_of_points);
+        unnormalize_hyperplane(context);
+        for (i = 1; i <= context -> no_of_dimensions; i++) context -> attribute_min[i] = 0;
       }
 
-      if (ap_bias * oblique_impurity >= cur_impurity) {
-        for (i = 1; i <= no_of_coeffs; i++) coeff_array[i] = ap_coeff_array[i];
-        coeff_modified = TRUE;
+      if (context -> ap_bias * oblique_impurity >= cur_impurity) {
+        for (i = 1; i <= context -> no_of_coeffs; i++) context -> coeff_array[i] = ap_coeff_array[i];
+        context -> coeff_modified = TRUE;
       } else cur_impurity = oblique_impurity;
 
-      free_vector(ap_coeff_array, 1, no_of_coeffs);
+      free_vector(ap_coeff_array, 1, context -> no_of_coeffs);
     }
   }
 
-  if (cur_impurity >= initial_impurity) return (NULL);
-  /*Can not find any split given current parameter settings. */
+  find_values(context, cur_points, cur_no_of_points);
+  set_counts(context, cur_points, cur_no_of_points, 1);
 
-  find_values(cur_points, cur_no_of_points);
-  set_counts(cur_points, cur_no_of_points, 1);
+  for (i = 1, lpt = 0, rpt = 0; i <= context -> no_of_categories; i++) {
+    lpt += context -> left_count[i];
+    rpt += context -> right_count[i];
+  }
+  /* A hyperplane with all the points on one side does not split the  */
+  /* node, whatever impurity the search reported for it.              */
+  if (lpt == 0 || rpt == 0) return (NULL);
+  if (TOO_SMALL_A_LEAF(context, lpt, rpt)) return (NULL);
+
+  /* The impurity of the split is taken from the counts it leaves, */
+  /* the ones the children are grown from.                          */
+  cur_impurity = compute_impurity(context, cur_no_of_points);
+  if (cur_impurity >= * initial_impurity) return (NULL);
+  /*Can not find any split given current parameter settings. */
+  if (impurity_decrease(context, * initial_impurity, cur_impurity,
+      cur_no_of_points) < context -> min_impurity_decrease *
+    context -> store -> no_of_points) return (NULL);
 
-  if (verbose) {
-    if (strlen(node_str)) printf("** \"%s\": ", node_str);
+  if (context -> verbose) {
+    if (depth) printf("** Depth %d: ", depth);
     else printf("** Root: ");
     printf("Left:[");
-    for (i = 1; i < no_of_categories; i++) printf("%d,", left_count[i]);
-    printf("%d] Right:[", left_count[no_of_categories]);
-    for (i = 1; i < no_of_categories; i++) printf("%d,", right_count[i]);
-    printf("%d]\n", right_count[no_of_categories]);
-  }
-
-  for (i = 1, lpt = 0, rpt = 0; i <= no_of_categories; i++) {
-    lpt += left_count[i];
-    rpt += right_count[i];
+    for (i = 1; i < context -> no_of_categories; i++) printf("%d,", context -> left_count[i]);
+    printf("%d] Right:[", context -> left_count[context -> no_of_categories]);
+    for (i = 1; i < context -> no_of_categories; i++) printf("%d,", context -> right_count[i]);
+    printf("%d]\n", context -> right_count[context -> no_of_categories]);
   }
 
-  cur_node = create_tree_node();
+  cur_node = create_tree_node(context);
   cur_node -> no_of_points = cur_no_of_points;
-  strcpy(cur_node -> label, node_str);
-  write_hp(cur_node, animationfile);
+  cur_node -> depth = depth;
+  cur_node -> id = context -> split_id; /* Renumbered by build_tree. */
+  write_hyperplane(context, context -> animationfile);
 
-  if (cur_impurity == 0) return (cur_node);
+  * split_impurity = cur_impurity;
+  return (cur_node);
+}
 
-  lpoints = rpoints = NULL;
-  if (left_count[cur_node -> left_cat] != lpt)
-  /* Left region is not homogeneous. */
-  {
-    if ((lpoints = (POINT ** ) malloc((unsigned) lpt * sizeof(POINT * ))) ==
-      NULL) error("BUILD_DT : Memory allocation failure.");
-    lpoints--;
-    lindex = 0;
+/************************************************************************/
+/* Module name : grow_best_first                                        */
+/* Functionality : Builds a decision tree best first : of the leaves    */
+/*                 that can be split, the one whose split decreases the */
+/*                 impurity most is split next, until the tree has      */
+/*                 context -> max_leaf_nodes leaves or no leaf can be   */
+/*                 split.                                               */
+/* Parameters : as for build_subtree, for the root.                     */
+/* Returns : the root of the tree, NULL if no split could be found.     */
+/* Calls modules : add_frontier_node                                    */
+/*                 pop_frontier_node                                    */
+/*                 partition_points                                     */
+/*                 partition_sorted_points                              */
+/*                 myrandom_r (util.c)                                  */
+/*                 seed_random_state (util.c)                           */
+/*                 error (util.c)                                       */
+/* Is called by modules : build_tree                                    */
+/* Remarks : The leaves that can be split, with their splits, are kept  */
+/*           in a heap (see add_frontier_node). A split is found with   */
+/*           the random numbers build_subtree would have used for it,   */
+/*           so as long as the tree has fewer than max_leaf_nodes       */
+/*           leaves, it is the tree build_subtree grows. The splits are */
+/*           found one at a time; only the restarts of oblique_split    */
+/*           run in parallel. The splits found for the leaves left      */
+/*           unsplit stay in the arena of the tree, unused.             */
+/************************************************************************/
+struct tree_node * grow_best_first(context, cur_points, cur_no_of_points,
+  sorted_points)
+TRAINING_CONTEXT * context;
+int * cur_points;
+int cur_no_of_points;
+int * sorted_points; {
+  struct frontier_node * heap, best;
+  struct tree_node * root = NULL;
+  unsigned short seeds[2][3];
+  int i, side, lpt, rpt, heap_size = 0, order = 0, no_of_leaves = 1;
+  int max_heap_size = context -> max_leaf_nodes;
+
+  /* Only leaves are in the heap, and there are at most as many leaves */
+  /* as points.                                                         */
+  if (max_heap_size > cur_no_of_points) max_heap_size = cur_no_of_points;
+  heap = (struct frontier_node * ) malloc((unsigned) max_heap_size *
+    sizeof(struct frontier_node));
+  if (heap == NULL) error("Grow_Best_First : Memory allocation failure.");
+  heap -= 1;
+
+  add_frontier_node(context, heap, & heap_size, & order, NULL, LEFT, 0,
+    cur_points, cur_no_of_points, sorted_points);
+
+  while (heap_size > 0 && no_of_leaves < context -> max_leaf_nodes) {
+    pop_frontier_node(heap, & heap_size, & best);
+    if (best.parent == NULL) root = best.node;
+    else if (best.side == LEFT) best.parent -> left = best.node;
+    else best.parent -> right = best.node;
+    best.node -> parent = best.parent;
+    no_of_leaves++;
+    if (no_of_leaves == context -> max_leaf_nodes) break;
+    if (best.split_impurity == 0) continue;
+
+    /* Split the leaf, and find the splits of its children, as       */
+    /* build_subtree does.                                           */
+    for (i = 1, lpt = 0, rpt = 0; i <= context -> no_of_categories; i++) {
+      lpt += best.node -> left_count[i];
+      rpt += best.node -> right_count[i];
+    }
+    partition_points(context, best.cur_points, best.cur_no_of_points);
+    if (best.sorted_points != NULL)
+      partition_sorted_points(context, best.sorted_points, best.cur_no_of_points);
+
+    for (i = 0; i < 3; i++) context -> random_state[i] = best.random_state[i];
+    for (side = LEFT; side <= RIGHT; side++)
+      seed_random_state(seeds[side],
+        (long) myrandom_r(0.0, 2147483647.0, context -> random_state));
+
+    for (side = LEFT; side <= RIGHT; side++) {
+      if (side == LEFT ? best.node -> left_count[best.node -> left_cat] == lpt :
+        best.node -> right_count[best.node -> right_cat] == rpt) continue;
+      for (i = 0; i < 3; i++) context -> random_state[i] = seeds[side][i];
+      if (side == LEFT)
+        add_frontier_node(context, heap, & heap_size, & order, best.node, LEFT,
+          best.node -> depth + 1, best.cur_points, lpt, best.sorted_points);
+      else
+        add_frontier_node(context, heap, & heap_size, & order, best.node, RIGHT,
+          best.node -> depth + 1, best.cur_points + lpt, rpt,
+          (best.sorted_points == NULL) ? NULL : best.sorted_points + lpt);
+    }
   }
 
-  if (right_count[cur_node -> right_cat] != rpt)
-  /* Right region is not homogeneous. */
-  {
-    if ((rpoints = (POINT ** ) malloc((unsigned) rpt * sizeof(POINT * ))) ==
-      NULL) error("BUILD_DT : Memory allocation failure.");
-    rpoints--;
-    rindex = 0;
-  }
+  free((char * )(heap + 1));
+  return (root);
+}
 
-  for (i = 1; i <= cur_no_of_points; i++)
-    if (cur_points[i] -> val < 0) {
-      if (lpoints != NULL) lpoints[++lindex] = cur_points[i];
-    }
-  else {
-    if (rpoints != NULL) rpoints[++rindex] = cur_points[i];
-  }
+/* Whether frontier node a is split before b. */
+#define SPLIT_BEFORE(a, b) ((a).decrease > (b).decrease || \
+  ((a).decrease == (b).decrease && (a).order < (b).order))
 
-  if (lpoints != NULL) {
-    strcpy(lnode_str, node_str);
-    strcat(lnode_str, "l");
-    cur_node -> left = build_subtree(lnode_str, lpoints, lpt);
-    if (cur_node -> left != NULL)(cur_node -> left) -> parent = cur_node;
-    free((char * )(lpoints + 1));
+/************************************************************************/
+/* Module name : add_frontier_node                                      */
+/* Functionality : Finds the split of a leaf of a tree grown best first,*/
+/*                 and adds the leaf to the heap of those that can be   */
+/*                 split.                                               */
+/* Parameters : heap, heap_size : the heap, heap[1] the leaf to split   */
+/*                                first (see SPLIT_BEFORE).             */
+/*              order : number of leaves added so far.                  */
+/*              parent, side : where the leaf is in the tree.           */
+/*              depth, cur_points, cur_no_of_points, sorted_points :    */
+/*                as for build_subtree.                                 */
+/* Returns : Nothing. Leaves that cannot be split are not added.        */
+/* Calls modules : split_node                                           */
+/*                 impurity_decrease (compute_impurity.c)               */
+/* Is called by modules : grow_best_first                               */
+/************************************************************************/
+add_frontier_node(context, heap, heap_size, order, parent, side, depth,
+  cur_points, cur_no_of_points, sorted_points)
+TRAINING_CONTEXT * context;
+struct frontier_node * heap;
+int * heap_size, * order;
+struct tree_node * parent;
+int side;
+int depth;
+int * cur_points;
+int cur_no_of_points;
+int * sorted_points; {
+  struct frontier_node leaf;
+  struct tree_node * split_node();
+  double initial_impurity, impurity_decrease();
+  int i;
+
+  context -> split_parent = (parent == NULL) ? 0 : parent -> id;
+  context -> split_side = side;
+  leaf.node = split_node(context, depth, cur_points, cur_no_of_points,
+    sorted_points, & initial_impurity, & leaf.split_impurity);
+  if (leaf.node == NULL) return;
+  leaf.parent = parent;
+  leaf.side = side;
+  leaf.cur_points = cur_points;
+  leaf.cur_no_of_points = cur_no_of_points;
+  leaf.sorted_points = sorted_points;
+  leaf.decrease = impurity_decrease(context, initial_impurity,
+    leaf.split_impurity, cur_no_of_points);
+  leaf.order = ( * order) ++;
+  for (i = 0; i < 3; i++) leaf.random_state[i] = context -> random_state[i];
+
+  for (i = ++( * heap_size); i > 1 && SPLIT_BEFORE(leaf, heap[i / 2]); i /= 2)
+    heap[i] = heap[i / 2];
+  heap[i] = leaf;
+}
+
+/************************************************************************/
+/* Module name : pop_frontier_node                                      */
+/* Functionality : Takes the leaf to split first out of the heap of     */
+/*                 add_frontier_node.                                   */
+/* Parameters : heap, heap_size : the heap, not empty.                  */
+/*              leaf : set to the leaf.                                 */
+/* Returns : Nothing.                                                   */
+/* Calls modules : None.                                                */
+/* Is called by modules : grow_best_first                               */
+/************************************************************************/
+pop_frontier_node(heap, heap_size, leaf)
+struct frontier_node * heap;
+int * heap_size;
+struct frontier_node * leaf; {
+  struct frontier_node last = heap[ * heap_size];
+  int i, child;
+
+  * leaf = heap[1];
+  ( * heap_size) --;
+  for (i = 1; (child = 2 * i) <= * heap_size; i = child) {
+    if (child < * heap_size && SPLIT_BEFORE(heap[child + 1], heap[child]))
+      child++;
+    if (!SPLIT_BEFORE(heap[child], last)) break;
+    heap[i] = heap[child];
   }
+  heap[i] = last;
+}
 
-  if (rpoints != NULL) {
-    strcpy(rnode_str, node_str);
-    strcat(rnode_str, "r");
-    cur_node -> right = build_subtree(rnode_str, rpoints, rpt);
-    if (cur_node -> right != NULL)(cur_node -> right) -> parent = cur_node;
-    free((char * )(rpoints + 1));
+/************************************************************************/
+/* Module name : partition_points                                       */
+/* Functionality : Splits a list of the points of a tree node into      */
+/*                 those of its children, in place, keeping their order.*/
+/* Parameters : points : the list (indices in the store), from index 1. */
+/*              cur_no_of_points : number of points in the node.        */
+/* Returns : Nothing. The points on the left of the hyperplane (with    */
+/*           negative "val" fields) are moved to the front of the list. */
+/* Calls modules : None.                                                */
+/* Is called by modules : build_subtree                                 */
+/*                        partition_sorted_points                       */
+/* Remarks : The points on the right go through                         */
+/*           context -> partition_buffer. Keeping the order keeps the    */
+/*           ties between points broken as they were.                   */
+/************************************************************************/
+partition_points(context, points, cur_no_of_points)
+TRAINING_CONTEXT * context;
+int * points;
+int cur_no_of_points; {
+  int i, point, lindex, rindex;
+  int * buffer = context -> partition_buffer;
+  double * val = context -> store -> val;
+
+  for (i = 1, lindex = 0, rindex = 0; i <= cur_no_of_points; i++) {
+    point = points[i];
+    if (val[point] < 0) points[++lindex] = point;
+    else buffer[++rindex] = point;
   }
+  for (i = 1; i <= rindex; i++) points[lindex + i] = buffer[i];
+}
 
-  return (cur_node);
+/************************************************************************/
+/* Module name : partition_sorted_points                                */
+/* Functionality : Splits the sorted lists of a tree node into those of */
+/*                 its children, keeping the order of each list.        */
+/* Parameters : sorted_points : the lists of the node (see SORTED).     */
+/*              cur_no_of_points : number of points in the node.        */
+/* Returns : Nothing. The points on the left of the hyperplane (with    */
+/*           negative "val" fields) are moved to the front of each list.*/
+/* Calls modules : partition_points                                     */
+/* Is called by modules : build_subtree                                 */
+/************************************************************************/
+partition_sorted_points(context, sorted_points, cur_no_of_points)
+TRAINING_CONTEXT * context;
+int * sorted_points;
+int cur_no_of_points; {
+  int j;
+
+  for (j = 1; j <= context -> no_of_dimensions; j++)
+    partition_points(context, SORTED(context -> store, sorted_points, j),
+      cur_no_of_points);
+}
+
+/************************************************************************/
+/* Module name : grow_subtree                                           */
+/* Functionality : Grows a subtree as a task of its own, in the context */
+/*                 forked for it by build_subtree.                      */
+/* Parameters : subtree : the subtree, set up by build_subtree.         */
+/*              thread_index : index of the thread in context -> pool.  */
+/* Returns : Nothing. The root of the subtree is left in subtree -> root*/
+/* Calls modules : build_subtree                                        */
+/*                 free_forked_context                                  */
+/* Is called by modules : build_subtree (through submit_task)           */
+/************************************************************************/
+void grow_subtree(subtree, thread_index)
+struct subtree * subtree;
+int thread_index; {
+  TRAINING_CONTEXT * context = subtree -> context;
+  struct tree_node * build_subtree();
+  int i;
 
+  context -> thread_index = thread_index;
+  for (i = 0; i < 3; i++) context -> random_state[i] = subtree -> random_state[i];
+  subtree -> root = build_subtree(context, subtree -> depth,
+    subtree -> cur_points, subtree -> cur_no_of_points,
+    subtree -> sorted_points);
+  free_forked_context(context, subtree -> cur_no_of_points);
 }
 
 /************************************************************************/
@@ -702,10 +1597,8 @@ int cur_no_of_points; {
 /* Functionality : Implements the CART-Linear Combinations (Breiman et  */
 /*                 al, 1984, Chapter 5) hill climbing coefficient       */
 /*                 perturbation algorithm.                              */
-/* Parameters : cur_points: Array of pointers to the current points.    */
+/* Parameters : cur_points: Indices (in the store) of current points.   */
 /*              cur_no_of_points:                                       */
-/*              cur_label: Label of the tree node for which current     */
-/*                         split is being induced.                      */
 /* Returns : impurity of the induced hyperplane.                        */
 /* Calls modules : cart_perturb (perturb.c)                             */
 /*                 cart_perturb_constant (perturb.c)                    */
@@ -715,53 +1608,55 @@ int cur_no_of_points; {
 /* Is called by modules : build_subtree                                 */
 /* Remarks : See the CART book for a description of the algorithm.      */
 /************************************************************************/
-double cart_split(cur_points, cur_no_of_points, cur_label)
-POINT ** cur_points;
-int cur_no_of_points;
-char * cur_label; {
-  int cur_coeff;
+double cart_split(context, cur_points, cur_no_of_points)
+TRAINING_CONTEXT * context;
+int * cur_points;
+int cur_no_of_points; {
+  int f, cur_coeff;
   double cur_error, new_error, prev_impurity, myabs();
   double cart_perturb(), cart_perturb_constant();
 
   /*Starts with the best axis parallel hyperplane. */
-  write_hyperplane(animationfile, cur_label);
-  find_values(cur_points, cur_no_of_points);
-  set_counts(cur_points, cur_no_of_points, 1);
-  cur_error = compute_impurity(cur_no_of_points);
-  cycle_count = 0;
+  write_hyperplane(context, context -> animationfile);
+  find_values(context, cur_points, cur_no_of_points);
+  set_counts(context, cur_points, cur_no_of_points, 1);
+  cur_error = compute_impurity(context, cur_no_of_points);
+  context -> cycle_count = 0;
 
   while (TRUE) {
     if (cur_error == 0.0) break;
-    cycle_count++;
-    if (cycle_count != 1) prev_impurity = cur_error;
-
-    for (cur_coeff = 1; cur_coeff < no_of_coeffs; cur_coeff++) {
-      new_error = cart_perturb(cur_points, cur_no_of_points, cur_coeff, cur_error);
-      if (alter_coefficients(cur_points, cur_no_of_points)) {
-        if (veryverbose)
+    context -> cycle_count++;
+    if (context -> cycle_count != 1) prev_impurity = cur_error;
+
+    for (f = 1; f <= context -> no_of_features; f++) {
+      cur_coeff = context -> features[f];
+      new_error = cart_perturb(context, cur_points, cur_no_of_points, cur_coeff, cur_error);
+      if (alter_coefficients(context, cur_points, cur_no_of_points)) {
+        if (context -> veryverbose)
           printf("\tCART hill climbing for coeff. %d. impurity %.3f -> %.3f\n",
             cur_coeff, cur_error, new_error);
         cur_error = new_error;
-        write_hyperplane(animationfile, cur_label);
+        write_hyperplane(context, context -> animationfile);
         if (cur_error == 0) break;
       }
     }
     if (cur_error != 0) {
-      new_error = cart_perturb_constant(cur_points, cur_no_of_points, cur_error);
-      if (alter_coefficients(cur_points, cur_no_of_points)) {
-        if (veryverbose)
+      new_error = cart_perturb_constant(context, cur_points, cur_no_of_points, cur_error);
+      if (alter_coefficients(context, cur_points, cur_no_of_points)) {
+        if (context -> veryverbose)
           printf("\tCART hill climbing for coeff. %d. impurity %.3f -> %.3f\n",
-            no_of_coeffs, cur_error, new_error);
+            context -> no_of_coeffs, cur_error, new_error);
         cur_error = new_error;
-        write_hyperplane(animationfile, cur_label);
+        write_hyperplane(context, context -> animationfile);
       }
     }
-    if (cycle_count > MAX_CART_CYCLES)
+    rescale_hyperplane(context);
+    if (context -> cycle_count > MAX_CART_CYCLES)
       /* Cart multivariate algorithm can get stuck in some domains.
          Arbitrary tie breaker. */
       break;
 
-    if (cycle_count != 1 && myabs(prev_impurity - cur_error) < TOLERANCE)
+    if (context -> cycle_count != 1 && myabs(prev_impurity - cur_error) < TOLERANCE)
       break;
   }
 
@@ -769,39 +1664,75 @@ char * cur_label; {
 
 }
 
+/************************************************************************/
+/* Module name : rescale_hyperplane                                     */
+/* Functionality : Scales the hyperplane in context -> coeff_array down */
+/*                 by a power of 2, if its largest coefficient is more  */
+/*                 than MAX_CART_COEFFICIENT.                           */
+/* Parameters : context : the context.                                  */
+/* Returns : Nothing.                                                   */
+/* Calls modules : myabs (util.c)                                       */
+/* Is called by modules : cart_split                                    */
+/* Remarks : Scaling does not move the hyperplane, but the perturbations*/
+/*           of cart_split can make the coefficients grow from cycle to */
+/*           cycle until they overflow. A power of 2 scales the values  */
+/*           of the points exactly, so the splits found do not change.  */
+/************************************************************************/
+rescale_hyperplane(context)
+TRAINING_CONTEXT * context; {
+  int i, exponent;
+  double largest = 0, scale, myabs();
+
+  for (i = 1; i <= context -> no_of_coeffs; i++)
+    if (myabs(context -> coeff_array[i]) > largest)
+      largest = myabs(context -> coeff_array[i]);
+  if (largest <= MAX_CART_COEFFICIENT) return;
+
+  frexp(largest, & exponent);
+  scale = ldexp(1.0, -exponent);
+  for (i = 1; i <= context -> no_of_coeffs; i++) context -> coeff_array[i] *= scale;
+  context -> coeff_modified = TRUE;
+}
+
 /************************************************************************/
 /* Module name : Create_Tree_Node                                       */
 /* Functionality : Creates a tree node structure, and sets some fields. */
 /* Parameters : None.                                                   */
 /* Returns : Pointer to the tree node created.                          */
-/* Calls modules : error (util.c)                                       */
-/*                 vector (util.c)                                      */
-/*                 ivector (util.c)                                     */
+/* Calls modules : arena_allocate (arena.c)                             */
 /*                 largest_element (compute_impurity.c)                 */
 /* Is called by modules : build_subtree                                 */
 /* Remarks : Assumes that the left_count, right_count arrays and the    */
 /*           coeff_array are set correctly.                             */
+/*           The node, its coefficients and counts are allocated in one */
+/*           piece from the arena of the context, and freed with it.    */
 /************************************************************************/
-struct tree_node * create_tree_node() {
+struct tree_node * create_tree_node(context)
+TRAINING_CONTEXT * context; {
   struct tree_node * cur_node;
   int i, largest_element();
-
-  cur_node = (struct tree_node * ) malloc(sizeof(struct tree_node));
-  if (cur_node == NULL) error("Create_Tree_Node : Memory allocation failure.");
-
-  cur_node -> coefficients = vector(1, no_of_coeffs);
-  for (i = 1; i <= no_of_coeffs; i++) cur_node -> coefficients[i] = coeff_array[i];
-
-  cur_node -> left_count = ivector(1, no_of_categories);
-  cur_node -> right_count = ivector(1, no_of_categories);
-  for (i = 1; i <= no_of_categories; i++) {
-    cur_node -> left_count[i] = left_count[i];
-    cur_node -> right_count[i] = right_count[i];
+  size_t node_size = (sizeof(struct tree_node) + sizeof(double) - 1) /
+    sizeof(double) * sizeof(double);
+
+  cur_node = (struct tree_node * ) arena_allocate(context, node_size +
+    context -> no_of_coeffs * sizeof(double) +
+    2 * context -> no_of_categories * sizeof(int));
+
+  cur_node -> coefficients = (double * )((char * ) cur_node + node_size) - 1;
+  for (i = 1; i <= context -> no_of_coeffs; i++) cur_node -> coefficients[i] = context -> coeff_array[i];
+
+  cur_node -> left_count = (int * )(cur_node -> coefficients +
+    context -> no_of_coeffs + 1) - 1;
+  cur_node -> right_count = cur_node -> left_count + context -> no_of_categories;
+  for (i = 1; i <= context -> no_of_categories; i++) {
+    cur_node -> left_count[i] = context -> left_count[i];
+    cur_node -> right_count[i] = context -> right_count[i];
   }
 
   cur_node -> parent = cur_node -> left = cur_node -> right = NULL;
-  cur_node -> left_cat = largest_element(left_count, no_of_categories);
-  cur_node -> right_cat = largest_element(right_count, no_of_categories);
+  cur_node -> id = 0; /* Numbered once the tree is grown. */
+  cur_node -> left_cat = largest_element(context -> left_count, context -> no_of_categories);
+  cur_node -> right_cat = largest_element(context -> right_count, context -> no_of_categories);
 
   return (cur_node);
 }
@@ -812,186 +1743,388 @@ struct tree_node * create_tree_node() {
 /*			cted orientation, that best separates 		*/
 /*			"cur_points" (minimizing the current impurity	*/
 /*			measure), using hill climbing and randomization.*/
-/* Parameters :	cur_points : array of pointers to the points (samples)	*/
-/*			     under consideration.			*/
+/*			The restarts of the hill climbing are run as	*/
+/*			tasks on context -> pool, and the best of their	*/
+/*			hyperplanes is kept.				*/
+/* Parameters :	cur_points : indices (in the store) of the points	*/
+/*			     (samples) under consideration.		*/
 /*		cur_no_of_points : number of points under consideration.*/
 /* Returns :	the impurity measure of the best hyperplane found.	*/
-/*		The hyperplane itself is returned through the global	*/
-/*		array "coeff_array".					*/
-/* Calls modules :	generate_random_hyperplane			*/
+/*		The hyperplane itself is returned through		*/
+/*		context -> coeff_array.					*/
+/* Calls modules :	seed_random_state (util.c)			*/
+/*			myrandom_r (util.c)				*/
+/*			stratified_sample				*/
+/*			submit_task (thread_pool.c)			*/
+/*			wait_for_tasks (thread_pool.c)			*/
+/*			run_restart					*/
 /*			find_values (perturb.c)				*/
 /*			set_counts (compute_impurity.c)			*/
 /*			compute_impurity (compute_impurity.c)		*/
-/*			myrandom (util.c)				*/
+/*			cart_perturb_constant (perturb.c)		*/
+/*			alter_coefficients				*/
+/* Is called by modules :	build_subtree				*/
+/* Remarks :	Each restart draws its random numbers from its own	*/
+/*		state, seeded here in order, and ties between restarts	*/
+/*		go to the earlier one. The hyperplane found does not	*/
+/*		depend on the number of threads.			*/
+/*		With max_climb_points, the restarts of a larger node	*/
+/*		hill climb on a stratified sample of its points only.	*/
+/*		The best hyperplane is then moved along its normal to	*/
+/*		the best position for all the points, and its impurity	*/
+/*		is that of all the points, so split_node compares it	*/
+/*		with the axis parallel split fairly.			*/
+/************************************************************************/
+double oblique_split(context, cur_points, cur_no_of_points)
+TRAINING_CONTEXT * context;
+int * cur_points;
+int cur_no_of_points; {
+  struct restart * restart;
+  TASK_GROUP restarts;
+  int i, r, best_restart = 1;
+  int * climb_points = cur_points, no_of_climb_points = cur_no_of_points;
+  void run_restart();
+  double least_error = HUGE_VAL, new_error, cart_perturb_constant();
+
+  if (context -> climb_points != NULL &&
+    cur_no_of_points > context -> max_climb_points) {
+    climb_points = context -> climb_points;
+    no_of_climb_points = stratified_sample(context, cur_points, cur_no_of_points);
+  }
+
+  context -> first_perfect_restart = context -> no_of_restarts + 1;
+  restarts.pending = 0;
+
+  for (r = 1; r <= context -> no_of_restarts; r++) {
+    restart = & context -> restarts[r];
+    restart -> context = context;
+    restart -> cur_points = climb_points;
+    restart -> cur_no_of_points = no_of_climb_points;
+    restart -> index = r;
+    seed_random_state(restart -> random_state,
+      (long) myrandom_r(0.0, 2147483647.0, context -> random_state));
+  }
+
+  for (r = 1; r <= context -> no_of_restarts; r++)
+    submit_task(context -> pool, & restarts, run_restart, & context -> restarts[r],
+      context -> thread_index);
+  wait_for_tasks(context -> pool, & restarts, context -> thread_index);
+
+  for (r = 1; r <= context -> no_of_restarts; r++)
+    if (context -> restarts[r].error < least_error) {
+      least_error = context -> restarts[r].error;
+      best_restart = r;
+    }
+
+  for (i = 1; i <= context -> no_of_coeffs; i++)
+    context -> coeff_array[i] = context -> restarts[best_restart].coefficients[i];
+  context -> coeff_modified = TRUE;
+  find_values(context, cur_points, cur_no_of_points);
+  set_counts(context, cur_points, cur_no_of_points, 1);
+
+  if (climb_points != cur_points) {
+    least_error = compute_impurity(context, cur_no_of_points);
+    new_error = cart_perturb_constant(context, cur_points, cur_no_of_points,
+      least_error);
+    if (new_error < least_error &&
+      alter_coefficients(context, cur_points, cur_no_of_points))
+      least_error = new_error;
+    else set_counts(context, cur_points, cur_no_of_points, 1);
+  }
+  return (least_error);
+
+}
+
+/************************************************************************/
+/* Module name : stratified_sample                                      */
+/* Functionality : Draws a random sample of about max_climb_points of   */
+/*                 the points of a node, each category in the same      */
+/*                 proportion as in the node.                           */
+/* Parameters : cur_points : indices (in the store) of the points of    */
+/*                           the node.                                  */
+/*              cur_no_of_points : number of points in the node.        */
+/* Returns : the number of points drawn. Their indices are left in      */
+/*           context -> climb_points, in the order of cur_points.       */
+/* Calls modules : myrandom_r (util.c)                                  */
+/* Is called by modules : oblique_split                                 */
+/* Remarks : Every category of the node gets one point at least. The    */
+/*           points of a category are drawn in one pass, each with the  */
+/*           probability (points still wanted) / (points left to see),  */
+/*           as in Knuth's selection sampling.                          */
+/************************************************************************/
+int stratified_sample(context, cur_points, cur_no_of_points)
+TRAINING_CONTEXT * context;
+int * cur_points;
+int cur_no_of_points; {
+  int i, c, no_of_samples = 0;
+  int * category = context -> store -> category;
+  int * left = context -> climb_counts;
+  int * wanted = context -> climb_counts + context -> no_of_categories;
+
+  for (c = 1; c <= context -> no_of_categories; c++) left[c] = 0;
+  for (i = 1; i <= cur_no_of_points; i++) left[category[cur_points[i]]]++;
+  for (c = 1; c <= context -> no_of_categories; c++) {
+    wanted[c] = (int)((double) left[c] * context -> max_climb_points /
+      cur_no_of_points);
+    if (wanted[c] == 0 && left[c] > 0) wanted[c] = 1;
+  }
+
+  for (i = 1; i <= cur_no_of_points; i++) {
+    c = category[cur_points[i]];
+    if (myrandom_r(0.0, (double) left[c], context -> random_state) < wanted[c]) {
+      context -> climb_points[++no_of_samples] = cur_points[i];
+      wanted[c]--;
+    }
+    left[c]--;
+  }
+  return (no_of_samples);
+}
+
+/************************************************************************/
+/* Module name : choose_features                                        */
+/* Functionality : Chooses, at random, the max_features attributes the  */
+/*                 split of a node is searched on.                      */
+/* Parameters : context : the context, with max_features less than     */
+/*                        no_of_dimensions.                             */
+/* Returns : Nothing. The attributes are left in context -> features,   */
+/*           in increasing order, and their number in                   */
+/*           context -> no_of_features.                                 */
+/* Calls modules : myrandom_r (util.c)                                  */
+/* Is called by modules : split_node                                    */
+/* Remarks : The other coefficients of the hyperplanes searched stay 0. */
+/*           The attributes are drawn in one pass, as in                */
+/*           stratified_sample.                                         */
+/************************************************************************/
+choose_features(context)
+TRAINING_CONTEXT * context; {
+  int j, wanted = context -> max_features;
+
+  context -> no_of_features = 0;
+  for (j = 1; j <= context -> no_of_dimensions; j++)
+    if (myrandom_r(0.0, (double)(context -> no_of_dimensions - j + 1),
+        context -> random_state) < wanted) {
+      context -> features[++context -> no_of_features] = j;
+      wanted--;
+    }
+}
+
+/************************************************************************/
+/* Module name : run_restart                                            */
+/* Functionality : Runs one restart of oblique_split, on the worker     */
+/*                 context of the thread it is run on.                  */
+/* Parameters : restart : the restart, set up by oblique_split.         */
+/*              thread_index : index of the thread in context -> pool.  */
+/* Returns : Nothing. The hyperplane found and its impurity are left in */
+/*           restart -> coefficients and restart -> error.              */
+/* Calls modules : random_feature_hyperplane (perturb.c)                */
+/*                 hill_climb                                           */
+/* Is called by modules : oblique_split (through submit_task)           */
+/* Remarks : The first restart starts with the best axis parallel       */
+/*           hyperplane if axis_parallel is true, the others with a     */
+/*           random hyperplane. A restart is skipped (with error        */
+/*           HUGE_VAL) once an earlier one has reached zero impurity,   */
+/*           as it could not be chosen anyway.                          */
+/************************************************************************/
+void run_restart(restart, thread_index)
+struct restart * restart;
+int thread_index; {
+  TRAINING_CONTEXT * context = restart -> context;
+  TRAINING_CONTEXT * worker = & context -> workers[thread_index];
+  int i, first_perfect_restart;
+  double hill_climb();
+
+  first_perfect_restart =
+    __atomic_load_n( & context -> first_perfect_restart, __ATOMIC_RELAXED);
+  if (first_perfect_restart < restart -> index) {
+    restart -> error = HUGE_VAL;
+    return;
+  }
+
+  for (i = 0; i < 3; i++) worker -> random_state[i] = restart -> random_state[i];
+  worker -> cycle_count = context -> cycle_count;
+  worker -> no_of_features = context -> no_of_features;
+  for (i = 1; i <= context -> no_of_features; i++)
+    worker -> features[i] = context -> features[i];
+  worker -> split_id = context -> split_id;
+  worker -> split_parent = context -> split_parent;
+  worker -> split_side = context -> split_side;
+
+  if (restart -> index == 1 && context -> axis_parallel == TRUE)
+    for (i = 1; i <= worker -> no_of_coeffs; i++)
+      worker -> coeff_array[i] = context -> coeff_array[i];
+  else random_feature_hyperplane(worker, worker -> coeff_array);
+  worker -> coeff_modified = TRUE;
+
+  restart -> error = hill_climb(worker, restart -> cur_points,
+    restart -> cur_no_of_points, restart -> index);
+  for (i = 1; i <= worker -> no_of_coeffs; i++)
+    restart -> coefficients[i] = worker -> coeff_array[i];
+
+  if (restart -> error == 0.0)
+    while (restart -> index < first_perfect_restart &&
+      !__atomic_compare_exchange_n( & context -> first_perfect_restart,
+        & first_perfect_restart, restart -> index, FALSE,
+        __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+/************************************************************************/
+/* Module name : hill_climb						*/
+/* Functionality : 	Perturbs the coefficients of the hyperplane in	*/
+/*			context -> coeff_array one at a time, as long	*/
+/*			as the impurity of the split of "cur_points"	*/
+/*			improves, trying random jumps when stuck in a	*/
+/*			local minimum.					*/
+/* Parameters :	cur_points : indices (in the store) of the points	*/
+/*			     (samples) under consideration.		*/
+/*		cur_no_of_points : number of points under consideration.*/
+/*		restart_count : number of the restart, for messages.	*/
+/* Returns :	the impurity measure of the hyperplane reached, which	*/
+/*		is left in context -> coeff_array.			*/
+/* Calls modules :	find_values (perturb.c)				*/
+/*			set_counts (compute_impurity.c)			*/
+/*			compute_impurity (compute_impurity.c)		*/
+/*			myrandom_r (util.c)				*/
 /*			suggest_perturbation (perturb.c)		*/
 /*			perturb_randomly (perturb.c)			*/
-/* Is called by modules :	build_subtree				*/
+/* Is called by modules :	run_restart				*/
 /************************************************************************/
-double oblique_split(cur_points, cur_no_of_points, cur_label)
-POINT ** cur_points;
+double hill_climb(context, cur_points, cur_no_of_points, restart_count)
+TRAINING_CONTEXT * context;
+int * cur_points;
 int cur_no_of_points;
-char * cur_label; {
-  char c;
-  int i, j, old_nsp, restart_count = 1;
+int restart_count; {
+  int i, j, f, old_nsp;
   int alter_coefficients();
   int cur_coeff, improved_in_this_cycle, best_coeff_to_improve;
   double perturb_randomly();
-  double cur_error, old_cur_error, best_cur_error, least_error;
-  double x, changeinval;
+  double cur_error, best_cur_error;
   double new_error, suggest_perturbation();
 
-  /*Start with the best axis parallel hyperplane if axis_parallel is true.
-    Otherwise start with a random hyperplane. */
-  if (axis_parallel != TRUE) {
-    generate_random_hyperplane(coeff_array, no_of_coeffs, MAX_COEFFICIENT);
-    coeff_modified = TRUE;
-  }
+  find_values(context, cur_points, cur_no_of_points);
+  set_counts(context, cur_points, cur_no_of_points, 1);
+  cur_error = compute_impurity(context, cur_no_of_points);
+  write_hyperplane(context, context -> animationfile);
+
+  if (context -> veryverbose)
+    printf(" Restart %d: Initial Impurity = %.3f\n", restart_count, cur_error);
+
+  context -> no_of_stagnant_perturbations = 0;
+  if (context -> order_of_perturbation == RANDOM) {
+    if (context -> cycle_count <= 0) context -> cycle_count = 10 * context -> no_of_coeffs;
+    for (i = 1; i <= context -> cycle_count; i++) {
+      if (cur_error == 0.0) break;
+      f = 0;
+      while (!f)
+        f = (int) myrandom_r(1.0, (double)(context -> no_of_features + 2),
+          context -> random_state);
+      cur_coeff = (f <= context -> no_of_features) ? context -> features[f] :
+        context -> no_of_coeffs;
+
+      new_error = suggest_perturbation(context, cur_points, cur_no_of_points,
+        cur_coeff, cur_error);
+      if (new_error <= cur_error &&
+        alter_coefficients(context, cur_points, cur_no_of_points)) {
+        if (context -> veryverbose)
+          printf("\thill climbing for coeff. %d. impurity %.3f -> %.3f\n",
+            cur_coeff, cur_error, new_error);
+        cur_error = new_error;
+        improved_in_this_cycle = TRUE;
+        write_hyperplane(context, context -> animationfile);
+        if (cur_error == 0) break;
+      } else /*Try improving in a random direction*/ {
+        improved_in_this_cycle = FALSE;
+        j = 0;
+        while (cur_error != 0 &&
+          !improved_in_this_cycle &&
+          ++j <= context -> max_no_of_random_perturbations) {
+          new_error = perturb_randomly(context, cur_points, cur_no_of_points, cur_error);
+          if (alter_coefficients(context, cur_points, cur_no_of_points)) {
+            if (context -> veryverbose)
+              printf("\trandom jump. impurity %.3f -> %.3f\n",
+                cur_error, new_error);
+            cur_error = new_error;
+            improved_in_this_cycle = TRUE;
+            write_hyperplane(context, context -> animationfile);
+          }
+        }
+      }
+    }
+  } else /* best_first or sequential orders of perturbation.*/ {
+    improved_in_this_cycle = TRUE;
+    context -> cycle_count = 0;
+
+    while (improved_in_this_cycle) {
+      if (cur_error == 0.0) break;
+      context -> cycle_count++;
+      improved_in_this_cycle = FALSE;
+
+      if (context -> order_of_perturbation == BEST_FIRST) {
+        best_cur_error = HUGE_VAL;
+        best_coeff_to_improve = context -> features[1];
+        old_nsp = context -> no_of_stagnant_perturbations;
+      }
 
-  find_values(cur_points, cur_no_of_points);
-  set_counts(cur_points, cur_no_of_points, 1);
-  least_error = cur_error = compute_impurity(cur_no_of_points);
-  for (i = 1; i <= no_of_coeffs; i++) best_coeff_array[i] = coeff_array[i];
-  write_hyperplane(animationfile, cur_label);
-
-  /* Repeat this loop once for every restart*/
-  while (least_error != 0.0 && restart_count <= no_of_restarts) {
-    if (veryverbose)
-      printf(" Restart %d: Initial Impurity = %.3f\n", restart_count, cur_error);
-
-    no_of_stagnant_perturbations = 0;
-    if (order_of_perturbation == RANDOM) {
-      if (cycle_count <= 0) cycle_count = 10 * no_of_coeffs;
-      for (i = 1; i <= cycle_count; i++) {
-        if (cur_error == 0.0) break;
-        cur_coeff = 0;
-        while (!cur_coeff)
-          cur_coeff = (int) myrandom(1.0, (double)(no_of_coeffs + 1));
-
-        new_error = suggest_perturbation(cur_points, cur_no_of_points,
+      for (f = 1; f <= context -> no_of_features; f++) {
+        cur_coeff = context -> features[f];
+        new_error = suggest_perturbation(context, cur_points, cur_no_of_points,
           cur_coeff, cur_error);
-        if (new_error <= cur_error &&
-          alter_coefficients(cur_points, cur_no_of_points)) {
-          if (veryverbose)
+        if (context -> order_of_perturbation == BEST_FIRST) {
+          if (new_error < best_cur_error) {
+            best_cur_error = new_error;
+            best_coeff_to_improve = cur_coeff;
+          }
+          context -> no_of_stagnant_perturbations = old_nsp;
+          if (best_cur_error == 0) break;
+        } else if (new_error <= cur_error &&
+          alter_coefficients(context, cur_points, cur_no_of_points)) {
+          if (context -> veryverbose)
             printf("\thill climbing for coeff. %d. impurity %.3f -> %.3f\n",
               cur_coeff, cur_error, new_error);
           cur_error = new_error;
           improved_in_this_cycle = TRUE;
-          write_hyperplane(animationfile, cur_label);
+          write_hyperplane(context, context -> animationfile);
           if (cur_error == 0) break;
-        } else /*Try improving in a random direction*/ {
-          improved_in_this_cycle = FALSE;
-          j = 0;
-          while (cur_error != 0 &&
-            !improved_in_this_cycle &&
-            ++j <= max_no_of_random_perturbations) {
-            new_error = perturb_randomly(cur_points, cur_no_of_points, cur_error);
-            if (alter_coefficients(cur_points, cur_no_of_points)) {
-              if (veryverbose)
-                printf("\trandom jump. impurity %.3f -> %.3f\n",
-                  cur_error, new_error);
-              cur_error = new_error;
-              improved_in_this_cycle = TRUE;
-              write_hyperplane(animationfile, cur_label);
-            }
-          }
         }
       }
-    } else /* best_first or sequential orders of perturbation.*/ {
-      improved_in_this_cycle = TRUE;
-      cycle_count = 0;
 
-      while (improved_in_this_cycle) {
-        if (cur_error == 0.0) break;
-        cycle_count++;
-        improved_in_this_cycle = FALSE;
-
-        if (order_of_perturbation == BEST_FIRST) {
-          best_cur_error = HUGE_VAL;
-          best_coeff_to_improve = 1;
-          old_nsp = no_of_stagnant_perturbations;
-        }
-
-        for (cur_coeff = 1; cur_coeff < no_of_coeffs; cur_coeff++) {
-          new_error = suggest_perturbation(cur_points, cur_no_of_points,
-            cur_coeff, cur_error);
-          if (order_of_perturbation == BEST_FIRST) {
-            if (new_error < best_cur_error) {
-              best_cur_error = new_error;
-              best_coeff_to_improve = cur_coeff;
-            }
-            no_of_stagnant_perturbations = old_nsp;
-            if (best_cur_error == 0) break;
-          } else if (new_error <= cur_error &&
-            alter_coefficients(cur_points, cur_no_of_points)) {
-            if (veryverbose)
-              printf("\thill climbing for coeff. %d. impurity %.3f -> %.3f\n",
-                cur_coeff, cur_error, new_error);
-            cur_error = new_error;
-            improved_in_this_cycle = TRUE;
-            write_hyperplane(animationfile, cur_label);
-            if (cur_error == 0) break;
-          }
+      if (context -> order_of_perturbation == BEST_FIRST &&
+        best_cur_error <= cur_error) {
+        cur_coeff = best_coeff_to_improve;
+        new_error = suggest_perturbation(context, cur_points, cur_no_of_points,
+          cur_coeff, cur_error);
+        if (alter_coefficients(context, cur_points, cur_no_of_points)) {
+          if (context -> veryverbose)
+            printf("\thill climbing for coeff. %d. impurity %.3f -> %.3f\n",
+              cur_coeff, cur_error, new_error);
+          cur_error = new_error;
+          improved_in_this_cycle = TRUE;
+          write_hyperplane(context, context -> animationfile);
         }
+      }
 
-        if (order_of_perturbation == BEST_FIRST &&
-          best_cur_error <= cur_error) {
-          cur_coeff = best_coeff_to_improve;
-          new_error = suggest_perturbation(cur_points, cur_no_of_points,
-            cur_coeff, cur_error);
-          if (alter_coefficients(cur_points, cur_no_of_points)) {
-            if (veryverbose)
-              printf("\thill climbing for coeff. %d. impurity %.3f -> %.3f\n",
-                cur_coeff, cur_error, new_error);
+      if (cur_error != 0 && !improved_in_this_cycle)
+      /*Try improving along a random direction*/
+      {
+        i = 0;
+        while (cur_error != 0 &&
+          !improved_in_this_cycle &&
+          ++i <= context -> max_no_of_random_perturbations) {
+          new_error = perturb_randomly(context, cur_points, cur_no_of_points,
+            cur_error);
+          if (alter_coefficients(context, cur_points, cur_no_of_points)) {
+            if (context -> veryverbose)
+              printf("\trandom jump. impurity %.3f -> %.3f\n",
+                cur_error, new_error);
             cur_error = new_error;
             improved_in_this_cycle = TRUE;
-            write_hyperplane(animationfile, cur_label);
-          }
-        }
-
-        if (cur_error != 0 && !improved_in_this_cycle)
-        /*Try improving along a random direction*/
-        {
-          i = 0;
-          while (cur_error != 0 &&
-            !improved_in_this_cycle &&
-            ++i <= max_no_of_random_perturbations) {
-            new_error = perturb_randomly(cur_points, cur_no_of_points,
-              cur_error, cur_label);
-            if (alter_coefficients(cur_points, cur_no_of_points)) {
-              if (veryverbose)
-                printf("\trandom jump. impurity %.3f -> %.3f\n",
-                  cur_error, new_error);
-              cur_error = new_error;
-              improved_in_this_cycle = TRUE;
-              write_hyperplane(animationfile, cur_label);
-            }
+            write_hyperplane(context, context -> animationfile);
           }
         }
       }
     }
-
-    if (cur_error < least_error ||
-      (cur_error == least_error && myrandom(0.0, 1.0) > 0.5)) {
-      least_error = cur_error;
-      for (i = 1; i <= no_of_coeffs; i++) best_coeff_array[i] = coeff_array[i];
-    }
-
-    if (least_error != 0 && ++restart_count <= no_of_restarts) {
-      generate_random_hyperplane(coeff_array, no_of_coeffs, MAX_COEFFICIENT);
-      coeff_modified = TRUE;
-      find_values(cur_points, cur_no_of_points);
-      set_counts(cur_points, cur_no_of_points, 1);
-      cur_error = compute_impurity(cur_no_of_points);
-      write_hyperplane(animationfile, cur_label);
-    }
   }
 
-  for (i = 1; i <= no_of_coeffs; i++)
-    coeff_array[i] = best_coeff_array[i];
-  coeff_modified = TRUE;
-  find_values(cur_points, cur_no_of_points);
-  set_counts(cur_points, cur_no_of_points, 1);
-  return (least_error);
+  return (cur_error);
 
 }
 
@@ -1002,36 +2135,41 @@ char * cur_label; {
 /*                 If they are, updates the "val" fields of the points  */
 /*                 to correspond to the new hyperplane. Sets the left_  */
 /*                 count and right_count arrays.                        */
-/* Parameters : cur_points : Array of pointers to the points            */
+/* Parameters : cur_points : Indices (in the store) of the points       */
 /*              cur_no_of_points.                                       */
 /* Returns : 1  if any coefficient values are altered,                  */
 /*           0  otherwise                                               */
 /* Calls modules : myabs (util.c)                                       */
+/*                 add_scaled_column (vector_kernels.c)                 */
 /*                 set_counts (compute_impurity.c)                      */
 /* Is called by modules : oblique_split                                 */
 /* Remarks : Assumes that the arrays coeff_array, modified_coeff_array  */
 /*           are set. Assumes that the "val" fields of the points       */
 /*           correspond to the coefficient values in coeff_array.       */
 /************************************************************************/
-int alter_coefficients(cur_points, cur_no_of_points)
-struct point ** cur_points;
+int alter_coefficients(context, cur_points, cur_no_of_points)
+TRAINING_CONTEXT * context;
+int * cur_points;
 int cur_no_of_points; {
-  int i, j = 0;
-
-  for (i = 1; i <= no_of_coeffs; i++)
-    if (myabs(coeff_array[i] - modified_coeff_array[i]) > TOLERANCE) {
-      if (i != no_of_coeffs)
-        for (j = 1; j <= cur_no_of_points; j++)
-          cur_points[j] -> val += (modified_coeff_array[i] - coeff_array[i]) *
-          cur_points[j] -> dimension[i];
-      else
+  int i, j, altered = FALSE;
+  double * val = context -> store -> val, * column;
+
+  for (i = 1; i <= context -> no_of_coeffs; i++)
+    if (myabs(context -> coeff_array[i] - context -> modified_coeff_array[i]) > TOLERANCE) {
+      if (i != context -> no_of_coeffs) {
+        column = COLUMN(context -> store, i);
+        ( * add_scaled_column)(val, column,
+          context -> modified_coeff_array[i] - context -> coeff_array[i],
+          cur_points, cur_no_of_points);
+      } else
         for (j = 1; j <= cur_no_of_points; j++)
-          cur_points[j] -> val += (modified_coeff_array[i] - coeff_array[i]);
+          val[cur_points[j]] += (context -> modified_coeff_array[i] - context -> coeff_array[i]);
 
-      coeff_array[i] = modified_coeff_array[i];
+      context -> coeff_array[i] = context -> modified_coeff_array[i];
+      altered = TRUE;
     }
-  if (j != 0) {
-    set_counts(cur_points, cur_no_of_points, 1);
+  if (altered) {
+    set_counts(context, cur_points, cur_no_of_points, 1);
     return (1);
   } else return (0);
 }
@@ -1042,55 +2180,78 @@ int cur_no_of_points; {
 /*			parallel orientation, that best separates	*/
 /*			"cur_points" (minimizing the current impurity	*/
 /*			measure). 					*/
-/* Parameters :	cur_points : array of pointers to the points (samples)	*/
-/*			     under consideration.			*/
+/* Parameters :	cur_points : indices (in the store) of the points	*/
+/*			     (samples) under consideration.		*/
 /*		cur_no_of_points : number of points under consideration.*/
+/*		sorted_points : cur_points sorted along each attribute	*/
+/*		                (see SORTED in oc1.h), or NULL.		*/
 /* Returns :	the impurity of the best hyperplane found.	        */
 /*		The hyperplane itself is returned through the global	*/
 /*		array "coeff_array".					*/
 /* Calls modules :	linear_split (perturb.c)			*/
-/*			find_values (perturb.c)				*/
+/*			linear_split_sorted (perturb.c)			*/
 /*			set_counts (compute_impurity.c)			*/
 /*			compute_impurity (compute_impurity.c)		*/
 /* Is called by modules :	build_subtree				*/
+/* Remarks :	With sorted_points, the values along each attribute are	*/
+/*		taken in sorted order, and need not be sorted again.	*/
+/*		The "val" fields for a split along one attribute are	*/
+/*		just the attribute values plus the constant, so they	*/
+/*		are set directly rather than by find_values, which	*/
+/*		would multiply out every attribute.			*/
 /************************************************************************/
-double axis_parallel_split(cur_points, cur_no_of_points)
-POINT ** cur_points;
-int cur_no_of_points; {
-  int i, j, cur_coeff, best_coeff;
+double axis_parallel_split(context, cur_points, cur_no_of_points, sorted_points)
+TRAINING_CONTEXT * context;
+int * cur_points;
+int cur_no_of_points;
+int * sorted_points; {
+  int i, j, f, cur_coeff, best_coeff, * sorted;
   double cur_error, best_error, best_coeff_split_at;
-  double linear_split();
-
-  for (i = 1; i <= no_of_coeffs; i++) coeff_array[i] = 0;
-
-  for (cur_coeff = 1; cur_coeff <= no_of_dimensions; cur_coeff++) {
-    coeff_array[cur_coeff] = 1;
-    for (j = 1; j <= cur_no_of_points; j++) {
-      candidates[j].value = cur_points[j] -> dimension[cur_coeff];
-      candidates[j].cat = cur_points[j] -> category;
+  double linear_split(), linear_split_sorted(), * column, * val;
+
+  for (i = 1; i <= context -> no_of_coeffs; i++) context -> coeff_array[i] = 0;
+  val = context -> store -> val;
+
+  for (f = 1; f <= context -> no_of_features; f++) {
+    cur_coeff = context -> features[f];
+    context -> coeff_array[cur_coeff] = 1;
+    column = COLUMN(context -> store, cur_coeff);
+    if (sorted_points != NULL) {
+      sorted = SORTED(context -> store, sorted_points, cur_coeff);
+      for (j = 1; j <= cur_no_of_points; j++) {
+        context -> candidates[j].value = column[sorted[j]];
+        context -> candidates[j].cat = context -> store -> category[sorted[j]];
+      }
+      context -> coeff_array[context -> no_of_coeffs] = -1.0 * (double) linear_split_sorted(context, cur_no_of_points);
+    } else {
+      for (j = 1; j <= cur_no_of_points; j++) {
+        context -> candidates[j].value = column[cur_points[j]];
+        context -> candidates[j].cat = context -> store -> category[cur_points[j]];
+      }
+      context -> coeff_array[context -> no_of_coeffs] = -1.0 * (double) linear_split(context, cur_no_of_points);
     }
-    coeff_array[no_of_coeffs] = -1.0 * (double) linear_split(cur_no_of_points);
 
-    coeff_modified = TRUE;
-    find_values(cur_points, cur_no_of_points);
-    set_counts(cur_points, cur_no_of_points, 1);
-    cur_error = compute_impurity(cur_no_of_points);
+    for (j = 1; j <= cur_no_of_points; j++)
+      val[cur_points[j]] = context -> coeff_array[context -> no_of_coeffs] + column[cur_points[j]];
+    context -> coeff_modified = FALSE;
+    set_counts(context, cur_points, cur_no_of_points, 1);
+    cur_error = compute_impurity(context, cur_no_of_points);
 
-    if (cur_coeff == 1 || cur_error < best_error) {
+    if (f == 1 || cur_error < best_error) {
       best_coeff = cur_coeff;
-      best_coeff_split_at = coeff_array[no_of_coeffs];
+      best_coeff_split_at = context -> coeff_array[context -> no_of_coeffs];
       best_error = cur_error;
     }
 
-    coeff_array[cur_coeff] = 0;
-    coeff_array[no_of_coeffs] = 0;
+    context -> coeff_array[cur_coeff] = 0;
+    context -> coeff_array[context -> no_of_coeffs] = 0;
 
     if (best_error == 0) break;
   }
 
-  coeff_array[best_coeff] = 1;
-  coeff_array[no_of_coeffs] = best_coeff_split_at;
-  coeff_modified = TRUE;
+  context -> coeff_array[best_coeff] = 1;
+  context -> coeff_array[context -> no_of_coeffs] = best_coeff_split_at;
+  context -> coeff_modified = TRUE;
 
   return (best_error);
 }
@@ -1099,46 +2260,58 @@ int cur_no_of_points; {
 /* Module name : Write_Hyperplane                                       */
 /* Functionality : This routine is used when the animation option is    */
 /*                 chosen, to write intermediate hyperplanes into the   */
-/*                 animation file. This creates a temporary tree node   */
-/*                 and calls the write_hp module in train_util.c.       */
+/*                 animation file. This sets up a temporary tree node   */
+/*                 over the work areas of the context, and calls the    */
+/*                 write_hp module in tree_util.c.                      */
 /* Parameters :  out : File pointer to the animation file.              */
-/*               label: Label of the tree node being induced.           */
 /* Returns : Nothing.                                                   */
-/* Calls modules :  create_tree_node                                    */
-/*                  write_hp (train_util.c)                             */
-/*                  free_tree_node                                      */
-/* Is called by modules : oblique_split                                 */
-/* Remarks : As with all other memory deallocation calls in OC1, the    */
-/*           ones in this module may also have problems.                */
+/* Calls modules :  write_hp (tree_util.c)                              */
+/* Is called by modules : split_node                                    */
+/*                        cart_split                                    */
+/*                        hill_climb                                    */
+/* Remarks : The node is written with the provisional id split_node     */
+/*           gave it, and with its parent and side as the caller of     */
+/*           split_node set them. All the hyperplanes tried for a node  */
+/*           come one after the other, the one it is split by last, so  */
+/*           display can replay the perturbations of each node.         */
 /************************************************************************/
-write_hyperplane(out, label)
-FILE * out;
-char * label; {
-  struct tree_node * temp_node, * create_tree_node();
+write_hyperplane(context, out)
+TRAINING_CONTEXT * context;
+FILE * out; {
+  struct tree_node temp_node, temp_parent;
 
   if (out == NULL) return;
-  temp_node = create_tree_node();
-  strcpy(temp_node -> label, label);
-  write_hp(temp_node, out);
-  /*  deallocate_tree(temp_node);
-    free((char *)temp_node); */
+  temp_node.coefficients = context -> coeff_array;
+  temp_node.left_count = context -> left_count;
+  temp_node.right_count = context -> right_count;
+  temp_node.id = context -> split_id;
+  temp_node.parent = NULL;
+  if (context -> split_parent) {
+    temp_parent.id = context -> split_parent;
+    temp_parent.left = (context -> split_side == LEFT) ? & temp_node : NULL;
+    temp_node.parent = & temp_parent;
+  }
+  write_hp(& temp_node, out);
 }
 
 /************************************************************************/
 /* Module name : cross_validate						*/
 /* Functionality :	Performs K-fold cross_validation on a training  */
 /*                      set.					        */
-/* Parameters : points : point set under consideration			*/
+/* Parameters : context : training context, allocated for no_of_points.	*/
+/*		points : point set under consideration			*/
 /*		no_of_points.						*/
 /* Returns :	Nothing.					 	*/
 /* Calls modules :	ivector (util.c)				*/
 /*			build_tree					*/
 /*			estimate_accuracy (classify.c)	                */
+/*			free_arena (arena.c)				*/
 /*			error (util.c)					*/
-/*			write_tree (train_util.c)			*/
+/*			write_tree (tree_util.c)			*/
 /* Is called by modules :	main					*/
 /************************************************************************/
-cross_validate(points, no_of_points)
+cross_validate(context, points, no_of_points)
+TRAINING_CONTEXT * context;
 int no_of_points;
 POINT ** points; {
   int fold_size, fold_begin, fold_end, i, j;
@@ -1187,10 +2360,15 @@ POINT ** points; {
 
     if (verbose) printf("Fold %d:\n", no_of_folds);
     if (fold_begin == 1)
-      root = build_tree(train_points, no_of_train_points, dt_file);
-    else root = build_tree(train_points, no_of_train_points, "");
+      root = build_tree(context, train_points, no_of_train_points, dt_file);
+    else root = build_tree(context, train_points, no_of_train_points, "");
 
-    results[no_of_folds] = estimate_accuracy(test_points, no_of_test_points, root);
+    results[no_of_folds] = estimate_accuracy(test_points, no_of_test_points, root,
+      context -> root_count);
+    free_arena(context -> arena);
+    context -> arena = NULL;
+    context -> root = NULL;
+    context -> root_count = NULL;
 
     printf("fold %d: acc. = %.2f\t#leaves = %.0f\tmax. depth = %.0f\n",
       no_of_folds, results[no_of_folds].accuracy,
@@ -1309,7 +2487,7 @@ print_log_and_exit() {
   if (strlen(animation_file) && no_of_dimensions == 2) {
     fprintf(logfile, "All intermediate hyperplane locations tried are \n");
     fprintf(logfile, "output to %s.", animation_file);
-    fprintf(logfile, "Use the Display program with -A option to see animation.\n");
+    fprintf(logfile, "Use the Display program with -D option to see animation.\n");
   }
 
   if (strlen(misclassified_data) && no_of_folds != 0)
@@ -1409,7 +2587,8 @@ int no_of_points; {
 /* Module name : Normalize_Data                                         */
 /* Functionality : Translates all points to lie in the positive         */
 /*                 quadrant (a requirement for OC1's algorithm).        */
-/* Parameters :    points: array of points to be normalized.            */
+/* Parameters :    points: indices (in the store) of the points to be   */
+/*                         normalized.                                  */
 /*                 no_of_points: number of points.                      */
 /* Returns : Nothing.                                                   */
 /* Calls modules :  vector (util.c)                                     */
@@ -1424,21 +2603,26 @@ int no_of_points; {
 /*           hyperplane induced is subsequently modified (in the module */
 /*           unnormalize_hyperplane) to correspond to the original data.*/
 /************************************************************************/
-normalize_data(points, no_of_points)
-struct point ** points;
+normalize_data(context, points, no_of_points)
+TRAINING_CONTEXT * context;
+int * points;
 int no_of_points; {
-  int i, j;
-  double * temp, average(), sdev(), min();
+  int i, j, f;
+  double * temp, * column, average(), sdev(), min();
 
   temp = vector(1, no_of_points);
 
-  for (j = 1; j <= no_of_dimensions; j++) {
-    for (i = 1; i <= no_of_points; i++) temp[i] = points[i] -> dimension[j];
+  for (f = 1; f <= context -> no_of_features; f++) {
+    j = context -> features[f];
+    column = COLUMN(context -> store, j);
+    for (i = 1; i <= no_of_points; i++) temp[i] = column[points[i]];
 
-    attribute_min[j] = min(temp, no_of_points);
-    if (attribute_min[j] < 0)
-      for (i = 1; i <= no_of_points; i++)
-        points[i] -> dimension[j] -= attribute_min[j];
+    context -> attribute_min[j] = min(temp, no_of_points);
+    if (context -> attribute_min[j] < 0)
+      for (i = 1; i <= no_of_points; i++) {
+        column[points[i]] -= context -> attribute_min[j];
+        ROW(context -> store, points[i])[j] -= context -> attribute_min[j];
+      }
 
   }
   free_vector(temp, 1, no_of_points);
@@ -1447,7 +2631,7 @@ int no_of_points; {
 /************************************************************************/
 /* Module name : Unnormalize_Data                                       */
 /* Functionality : Removes the effects of normalization on data.        */
-/* Parameters : points: Array of pointers to the point structures.      */
+/* Parameters : points: Indices (in the store) of the points.           */
 /*              no_of_points.                                           */
 /* Returns : Nothing.                                                   */
 /* Calls modules :                                                      */
@@ -1459,15 +2643,21 @@ int no_of_points; {
 /*                            data subset last seen.                    */
 /* Remarks : Assumes that the data is normalized.                       */
 /************************************************************************/
-unnormalize_data(points, no_of_points)
-struct point ** points;
+unnormalize_data(context, points, no_of_points)
+TRAINING_CONTEXT * context;
+int * points;
 int no_of_points; {
-  int i, j;
-
-  for (j = 1; j <= no_of_dimensions; j++) {
-    if (attribute_min[j] < 0)
-      for (i = 1; i <= no_of_points; i++)
-        points[i] -> dimension[j] += attribute_min[j];
+  int i, j, f;
+  double * column;
+
+  for (f = 1; f <= context -> no_of_features; f++) {
+    j = context -> features[f];
+    column = COLUMN(context -> store, j);
+    if (context -> attribute_min[j] < 0)
+      for (i = 1; i <= no_of_points; i++) {
+        column[points[i]] += context -> attribute_min[j];
+        ROW(context -> store, points[i])[j] += context -> attribute_min[j];
+      }
   }
 }
 
@@ -1486,12 +2676,15 @@ int no_of_points; {
 /*                            data subset last seen.                    */
 /* Remarks : Assumes that the data is normalized.                       */
 /************************************************************************/
-unnormalize_hyperplane() {
-  int i;
-
-  for (i = 1; i <= no_of_dimensions; i++)
-    if (attribute_min[i] < 0)
-      coeff_array[no_of_coeffs] -= coeff_array[i] * attribute_min[i];
+unnormalize_hyperplane(context)
+TRAINING_CONTEXT * context; {
+  int i, f;
+
+  for (f = 1; f <= context -> no_of_features; f++) {
+    i = context -> features[f];
+    if (context -> attribute_min[i] < 0)
+      context -> coeff_array[context -> no_of_coeffs] -= context -> coeff_array[i] * context -> attribute_min[i];
+  }
 }
 /************************************************************************/
 /************************************************************************/
\ No newline at end of file
@@ -0,0 +1,355 @@
+/****************************************************************/
+/* File Name : model_file.c					*/
+/* Contains modules :	model_size				*/
+/*			store_model				*/
+/*			open_model				*/
+/*			write_model				*/
+/*			map_model				*/
+/*			read_model				*/
+/*			check_model				*/
+/*			little_endian				*/
+/* Uses modules in :	oc1.h					*/
+/*			flat_tree.c				*/
+/* Is used by modules in :	mktree.c			*/
+/*				_oblique.pyx			*/
+/* Remarks       :	A binary format for FLAT_TREEs (see	*/
+/*			MODEL_HEADER in oc1.h), for model files	*/
+/*			and for pickling. The arrays of the	*/
+/*			tree are stored as they are in memory,	*/
+/*			doubles first, so that each one is	*/
+/*			aligned in the image. open_model points	*/
+/*			a FLAT_TREE into an image, without	*/
+/*			copying or parsing anything. map_model	*/
+/*			does so on a model file mapped into	*/
+/*			memory, so the processes that map the	*/
+/*			same model share one copy of it in the	*/
+/*			page cache.				*/
+/*			The numbers are little endian, and the	*/
+/*			models cannot be stored or opened on	*/
+/*			big endian machines.			*/
+/****************************************************************/
+#include "oc1.h"
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+int check_model(), little_endian();
+FLAT_TREE *open_model();
+
+/* Sizes of the parts of the image of a tree. */
+#define DOUBLES_SIZE(nodes,terms,leaves,categories) \
+  (((size_t) (terms) + (nodes) + (size_t) (leaves) * (categories)) * sizeof(double))
+#define INTS_SIZE(nodes,terms,leaves) \
+  ((3 * (size_t) (nodes) + 1 + (terms) + (leaves)) * sizeof(int))
+#define IMAGE_SIZE(nodes,terms,leaves,categories) \
+  (sizeof(MODEL_HEADER) + DOUBLES_SIZE(nodes,terms,leaves,categories) + \
+   INTS_SIZE(nodes,terms,leaves) + (nodes))
+
+/************************************************************************/
+/* Module name : model_size                                             */
+/* Functionality : Finds the size of the image of a FLAT_TREE.          */
+/* Parameters : tree : the FLAT_TREE.                                   */
+/* Returns : the size in bytes.                                         */
+/* Calls modules : None.                                                */
+/* Is called by modules : write_model                                   */
+/*                        Tree.__reduce__ (_oblique.pyx)                */
+/************************************************************************/
+size_t model_size(tree)
+FLAT_TREE *tree;
+{
+  return (IMAGE_SIZE(tree -> no_of_nodes, tree -> first_term[tree -> no_of_nodes],
+                     tree -> no_of_leaves, tree -> no_of_categories));
+}
+
+/************************************************************************/
+/* Module name : store_model                                            */
+/* Functionality : Stores the image of a FLAT_TREE in memory.           */
+/* Parameters : tree : the FLAT_TREE.                                   */
+/*              image : model_size(tree) bytes of memory.               */
+/* Returns : TRUE if the image was stored, FALSE on a big endian        */
+/*           machine.                                                   */
+/* Calls modules : little_endian                                        */
+/* Is called by modules : write_model                                   */
+/*                        Tree.__reduce__ (_oblique.pyx)                */
+/************************************************************************/
+int store_model(tree, image)
+FLAT_TREE *tree;
+char *image;
+{
+  MODEL_HEADER header;
+  int n = tree -> no_of_nodes, terms = tree -> first_term[n], leaves = tree -> no_of_leaves;
+
+  if (!little_endian()) return (FALSE);
+
+  memset(&header, 0, sizeof(MODEL_HEADER));
+  memcpy(header.magic, MODEL_MAGIC, sizeof(header.magic));
+  header.version = MODEL_VERSION;
+  header.header_size = sizeof(MODEL_HEADER);
+  header.no_of_nodes = n;
+  header.no_of_dimensions = tree -> no_of_dimensions;
+  header.no_of_categories = tree -> no_of_categories;
+  header.no_of_leaves = leaves;
+  header.no_of_terms = terms;
+
+#define STORE(array,size) { memcpy(image, (array), (size)); image += (size); }
+  STORE(&header, sizeof(MODEL_HEADER));
+  STORE(tree -> coefficients, (size_t) terms * sizeof(double));
+  STORE(tree -> constant, (size_t) n * sizeof(double));
+  STORE(tree -> leaf_probabilities, (size_t) leaves * tree -> no_of_categories * sizeof(double));
+  STORE(tree -> first_term, ((size_t) n + 1) * sizeof(int));
+  STORE(tree -> attributes, (size_t) terms * sizeof(int));
+  STORE(tree -> children, 2 * (size_t) n * sizeof(int));
+  STORE(tree -> leaf_category + 1, (size_t) leaves * sizeof(int));
+  STORE(tree -> kind, (size_t) n * sizeof(char));
+#undef STORE
+  return (TRUE);
+}
+
+/************************************************************************/
+/* Module name : open_model                                             */
+/* Functionality : Makes a FLAT_TREE of the image of one.               */
+/* Parameters : image : the image, as stored by store_model.            */
+/*              size : its size in bytes.                               */
+/* Returns : the FLAT_TREE, with its arrays in the image, or NULL if    */
+/*           the image is not that of a valid tree. The caller sets the */
+/*           "image" fields.                                            */
+/* Calls modules : check_model                                          */
+/*                 little_endian                                        */
+/* Is called by modules : map_model                                     */
+/*                        read_model                                    */
+/* Remarks : The image is checked once here (the sizes of the arrays    */
+/*           and every index in them), so that a damaged model cannot   */
+/*           make classification read outside the tree or loop forever. */
+/*           The counts in the header are compared in size_t, and the   */
+/*           number of categories bounded by the size of the image, so  */
+/*           that no count can overflow the size computed from them.    */
+/*           The nodes are limited to INT_MAX / 2, so that the indices  */
+/*           of their children (2 * node + 1) fit in an int.            */
+/************************************************************************/
+FLAT_TREE *open_model(image, size)
+char *image;
+size_t size;
+{
+  MODEL_HEADER *header = (MODEL_HEADER *) image;
+  FLAT_TREE *tree;
+  int n, terms, leaves;
+
+  if (!little_endian() || size < sizeof(MODEL_HEADER)) return (NULL);
+  n = header -> no_of_nodes;
+  terms = header -> no_of_terms;
+  leaves = header -> no_of_leaves;
+  if (memcmp(header -> magic, MODEL_MAGIC, sizeof(header -> magic)) ||
+      header -> version != MODEL_VERSION ||
+      header -> header_size != sizeof(MODEL_HEADER) ||
+      n < 0 || n > INT_MAX / 2 || (size_t) leaves != (size_t) n + 1 || terms < 0 ||
+      header -> no_of_dimensions < 1 || header -> no_of_categories < 1 ||
+      (size_t) header -> no_of_categories > size / sizeof(double) / leaves ||
+      size != IMAGE_SIZE(n, terms, leaves, header -> no_of_categories))
+    return (NULL);
+  if ((tree = (FLAT_TREE *) malloc(sizeof(FLAT_TREE))) == NULL) return (NULL);
+
+  tree -> no_of_nodes = n;
+  tree -> no_of_dimensions = header -> no_of_dimensions;
+  tree -> no_of_categories = header -> no_of_categories;
+  tree -> no_of_leaves = leaves;
+  image += sizeof(MODEL_HEADER);
+#define OPEN(array,type,size) { (array) = (type *) image; image += (size); }
+  OPEN(tree -> coefficients, double, (size_t) terms * sizeof(double));
+  OPEN(tree -> constant, double, (size_t) n * sizeof(double));
+  OPEN(tree -> leaf_probabilities, double, (size_t) leaves * tree -> no_of_categories * sizeof(double));
+  OPEN(tree -> first_term, int, ((size_t) n + 1) * sizeof(int));
+  OPEN(tree -> attributes, int, (size_t) terms * sizeof(int));
+  OPEN(tree -> children, int, 2 * (size_t) n * sizeof(int));
+  OPEN(tree -> leaf_category, int, (size_t) leaves * sizeof(int));
+  OPEN(tree -> kind, char, (size_t) n * sizeof(char));
+#undef OPEN
+  tree -> leaf_category--;
+  tree -> image = NULL;
+
+  if (!check_model(tree, terms)) {
+    free((char *) tree);
+    return (NULL);
+  }
+  return (tree);
+}
+
+/************************************************************************/
+/* Module name : write_model                                            */
+/* Functionality : Writes a FLAT_TREE to a model file.                  */
+/* Parameters : tree : the FLAT_TREE.                                   */
+/*              model_file : name of the file.                          */
+/* Returns : TRUE if the model was written, FALSE otherwise (with errno */
+/*           set if the file could not be written).                    */
+/* Calls modules : model_size                                           */
+/*                 store_model                                          */
+/* Is called by modules : main (mktree.c)                               */
+/*                        Tree.save_model (_oblique.pyx)                */
+/************************************************************************/
+int write_model(tree, model_file)
+FLAT_TREE *tree;
+char *model_file;
+{
+  FILE *outfile;
+  char *image;
+  size_t size;
+  int written;
+
+  if (tree == NULL) return (FALSE);
+  size = model_size(tree);
+  if ((image = (char *) malloc(size)) == NULL) return (FALSE);
+  if (!store_model(tree, image) || (outfile = fopen(model_file, "wb")) == NULL) {
+    free(image);
+    return (FALSE);
+  }
+
+  written = (fwrite(image, 1, size, outfile) == size);
+  if (fclose(outfile) != 0) written = FALSE;
+  free(image);
+  return (written);
+}
+
+/************************************************************************/
+/* Module name : map_model                                              */
+/* Functionality : Maps a model file written by write_model into        */
+/*                 memory, as a FLAT_TREE.                              */
+/* Parameters : model_file : name of the file.                          */
+/* Returns : the FLAT_TREE, or NULL if the file could not be read or is */
+/*           not a valid model. free_flat_tree unmaps it.               */
+/* Calls modules : open_model                                           */
+/* Is called by modules : Tree.load_model (_oblique.pyx)                */
+/************************************************************************/
+FLAT_TREE *map_model(model_file)
+char *model_file;
+{
+  FLAT_TREE *tree;
+  struct stat file_status;
+  char *image;
+  size_t size;
+  int descriptor;
+
+  if ((descriptor = open(model_file, O_RDONLY)) < 0) return (NULL);
+  if (fstat(descriptor, &file_status) != 0 ||
+      (size = file_status.st_size) < sizeof(MODEL_HEADER)) {
+    close(descriptor);
+    return (NULL);
+  }
+  image = (char *) mmap(NULL, size, PROT_READ, MAP_SHARED, descriptor, 0);
+  close(descriptor);
+  if (image == (char *) MAP_FAILED) return (NULL);
+
+  if ((tree = open_model(image, size)) == NULL) {
+    munmap(image, size);
+    return (NULL);
+  }
+  tree -> image = image;
+  tree -> image_size = size;
+  tree -> image_mapped = TRUE;
+  return (tree);
+}
+
+/************************************************************************/
+/* Module name : read_model                                             */
+/* Functionality : Makes a FLAT_TREE of a copy of an image stored by    */
+/*                 store_model.                                         */
+/* Parameters : image : the image.                                      */
+/*              size : its size in bytes.                               */
+/* Returns : the FLAT_TREE, or NULL if the image is not that of a valid */
+/*           tree. free_flat_tree frees the copy.                       */
+/* Calls modules : open_model                                           */
+/* Is called by modules : Tree.__setstate__ (_oblique.pyx)              */
+/************************************************************************/
+FLAT_TREE *read_model(image, size)
+char *image;
+size_t size;
+{
+  FLAT_TREE *tree;
+  char *copy;
+
+  /* malloc aligns the copy for the doubles at its start. */
+  if ((copy = (char *) malloc(size > 0 ? size : 1)) == NULL) return (NULL);
+  memcpy(copy, image, size);
+  if ((tree = open_model(copy, size)) == NULL) {
+    free(copy);
+    return (NULL);
+  }
+  tree -> image = copy;
+  tree -> image_size = size;
+  tree -> image_mapped = FALSE;
+  return (tree);
+}
+
+/************************************************************************/
+/* Module name : check_model                                            */
+/* Functionality : Checks that the arrays of a mapped FLAT_TREE are     */
+/*                 consistent.                                          */
+/* Parameters : tree : the FLAT_TREE.                                   */
+/*              no_of_terms : size of the attributes and coefficients   */
+/*              arrays.                                                 */
+/* Returns : TRUE if they are, FALSE otherwise.                         */
+/* Calls modules : None.                                                */
+/* Is called by modules : open_model                                    */
+/* Remarks : Children must come after their parents, as they do in the  */
+/*           depth first order of flatten_tree, so there are no cycles. */
+/************************************************************************/
+int check_model(tree, no_of_terms)
+FLAT_TREE *tree;
+int no_of_terms;
+{
+  int i, k, child, terms, n = tree -> no_of_nodes, d = tree -> no_of_dimensions;
+
+  if (tree -> first_term[0] != 0 || tree -> first_term[n] != no_of_terms) return (FALSE);
+  for (k = 0; k < n; k++)
+    if (tree -> first_term[k + 1] < tree -> first_term[k]) return (FALSE);
+
+  for (k = 0; k < n; k++) {
+    terms = tree -> first_term[k + 1] - tree -> first_term[k];
+    switch (tree -> kind[k]) {
+    case DENSE_NODE:
+      if (terms - 1 != d) return (FALSE); /* d comes from the header, d + 1 may overflow */
+      break;
+    case SPARSE_NODE:
+      if (terms > d) return (FALSE);
+      break;
+    case THRESHOLD_NODE:
+      if (terms != 1) return (FALSE);
+      break;
+    default:
+      return (FALSE);
+    }
+    if (tree -> kind[k] != DENSE_NODE)
+      for (i = tree -> first_term[k]; i < tree -> first_term[k + 1]; i++)
+        if (tree -> attributes[i] < 1 || tree -> attributes[i] > d) return (FALSE);
+
+    for (i = 0; i <= 1; i++) {
+      child = tree -> children[2 * k + i];
+      if (child > 0 ? child <= k || child >= n : child > -1 || child < -tree -> no_of_leaves)
+        return (FALSE);
+    }
+  }
+
+  for (i = 1; i <= tree -> no_of_leaves; i++)
+    if (tree -> leaf_category[i] < 1 || tree -> leaf_category[i] > tree -> no_of_categories)
+      return (FALSE);
+  return (TRUE);
+}
+
+/************************************************************************/
+/* Module name : little_endian                                          */
+/* Functionality : Tells whether the machine is little endian.          */
+/* Parameters : None.                                                   */
+/* Returns : TRUE if it is, FALSE otherwise.                            */
+/* Calls modules : None.                                                */
+/* Is called by modules : store_model                                   */
+/*                        open_model                                    */
+/************************************************************************/
+int little_endian()
+{
+  int one = 1;
+
+  return (*(char *) &one == 1);
+}
+
+/************************************************************************/
+/************************************************************************/
@@ -17,20 +17,21 @@
 #include <string.h>
 #include <stdlib.h>
 #include <ctype.h>
+#include <pthread.h>
 
-/* Change the following statement to use a different impurity measure. */
-
-#define IMPURITY gini_index()
-#define GINI_INDEX = gini_index()
-#define HELLINGER = hellinger_distance()
-
-/* possible values are: maxminority                             */
-/*			summinority				*/
-/*			variance				*/
-/*			info_gain				*/
-/*			gini_index				*/
-/*			twoing					*/
-/*                      hellinger_distance                                  */
+/* The impurity measures (see impurity_measures.c). Each tree has its */
+/* own criterion, in its TRAINING_CONTEXT, and select_criterion        */
+/* (compute_impurity.c) picks the routines for it once per tree.       */
+/* Every measure takes the TRAINING_CONTEXT holding the counts.        */
+#define GINI_INDEX		0 /* gini_index */
+#define INFO_GAIN		1 /* info_gain */
+#define TWOING			2 /* twoing */
+#define HELLINGER		3 /* hellinger_distance */
+#define MAXMINORITY		4 /* maxminority */
+#define SUMMINORITY		5 /* summinority */
+#define VARIANCE		6 /* variance */
+#define NO_OF_CRITERIA		7
+#define NO_GAIN		1e-12 /* Smaller relative gains are rounding errors. */
 
 
 #define NO_OF_STD_ERRORS	0 /* used for cost complexity pruning, 
@@ -53,14 +54,23 @@
 
 #define MAX_COEFFICIENT 	1.0
 #define MAX_NO_OF_ATTRIBUTES	4020
-#define MAX_DT_DEPTH 		50 
 #define MAX_NO_OF_STAGNANT_PERTURBATIONS 	10
 #define MAX_CART_CYCLES         100
+#define MAX_CART_COEFFICIENT    1.0e10
 
 #define TOLERANCE		0.0001
 #define TOO_SMALL_THRESHOLD	2.0
 #define TOO_SMALL_FOR_ANY_SPLIT		3
-#define TOO_SMALL_FOR_OBLIQUE_SPLIT	2 * no_of_dimensions
+#define TOO_SMALL_FOR_OBLIQUE_SPLIT(context) (2 * (context)->no_of_dimensions)
+#define TOO_SMALL_FOR_SUBTREE_TASK	200 /* grown inline, in mktree.c */
+#define RADIX_SORT_THRESHOLD	256 /* see sort_candidates, in sort.c */
+#define HISTOGRAM_SAMPLES_PER_BIN	16 /* see histogram_split, in perturb.c */
+#define TOO_SMALL_FOR_HISTOGRAM(context) (4 * (context)->max_bins)
+/* A split with left and right points on its sides leaves a side with  */
+/* fewer than min_samples_leaf (an empty side is no side at all).      */
+#define TOO_SMALL_A_LEAF(context,left,right) \
+  (((left) && (left) < (context)->min_samples_leaf) || \
+   ((right) && (right) < (context)->min_samples_leaf))
 
 #define TRAIN			1
 #define	TEST			2
@@ -83,6 +93,35 @@ typedef struct point
                 computation. */
  }POINT;
 
+/* Contiguous copy of a training set, used by the tree growing modules  */
+/* in place of an array of POINT pointers. The points of a tree node are*/
+/* given by an array of indices (1..no_of_points) into the store.       */
+/* Attribute values are kept twice : point after point (row_major) for  */
+/* substituting whole points into a hyperplane, and attribute after     */
+/* attribute (column_major) for perturbing one coefficient at a time.   */
+typedef struct point_store
+ {
+  int no_of_points;
+  int no_of_dimensions;
+  double *row_major;
+  double *column_major;
+  int *category;
+  double *val; /* Same as the val field of POINT. */
+ }POINT_STORE;
+
+/* ROW(store,i)[j] and COLUMN(store,j)[i] are both attribute j of point i.*/
+#define ROW(store,i) \
+  ((store)->row_major + (size_t)((i) - 1) * (store)->no_of_dimensions)
+#define COLUMN(store,j) \
+  ((store)->column_major + (size_t)((j) - 1) * (store)->no_of_points)
+
+/* With presort, SORTED(store,sorted_points,j)[1..n] are the n points   */
+/* of a tree node in increasing order of attribute j. Each attribute has*/
+/* a block of store->no_of_points entries, in which the lists of the    */
+/* nodes of one level of the tree lie side by side (see build_subtree). */
+#define SORTED(store,sorted_points,j) \
+  ((sorted_points) + (size_t)((j) - 1) * (store)->no_of_points)
+
 struct endpoint
  {
   double x,y;
@@ -99,7 +138,8 @@ struct tree_node
   int *left_count, *right_count;
   struct tree_node *parent,*left,*right;
   int left_cat,right_cat;
-  char label[MAX_DT_DEPTH];
+  int id; /* Numbered in preorder from 1, see number_nodes (tree_util.c).*/
+  int depth; /* 0 at the root. */
   double alpha; /* used only in error_complexity pruning. */
   int no_of_points;
   EDGE edge; /* used only in the display module. */
@@ -111,6 +151,188 @@ struct unidim
   int cat;
  };
 
+/* A pool of threads running queued tasks, see thread_pool.c.          */
+typedef struct task_group
+ {
+  int pending; /* Tasks of the group submitted, but not done yet. */
+ }TASK_GROUP;
+
+typedef struct task
+ {
+  void (*function)(); /* Called as function(argument, thread_index). */
+  void *argument;
+  TASK_GROUP *group;
+ }TASK;
+
+/* Tasks submitted by one thread. The thread itself takes tasks from   */
+/* the bottom (last in, first out), other threads steal from the top.  */
+typedef struct task_deque
+ {
+  TASK *tasks; /* Circular, no_of_tasks tasks starting at top. */
+  int size, top, no_of_tasks;
+ }TASK_DEQUE;
+
+struct pool_thread
+ {
+  pthread_t id;
+  int index;
+  struct thread_pool *pool;
+ };
+
+typedef struct thread_pool
+ {
+  int no_of_threads; /* Including the thread that created the pool. */
+  struct pool_thread *threads;
+  TASK_DEQUE *deques; /* One for each thread. */
+  int no_of_tasks; /* In all the deques. */
+  int shutdown;
+  pthread_mutex_t lock;
+  pthread_cond_t changed; /* Broadcast when a task is added or done. */
+ }THREAD_POOL;
+
+/* Memory for the nodes of a tree, freed all at once, see arena.c.    */
+typedef struct arena_block
+ {
+  struct arena_block *next;
+  size_t size, used; /* In bytes, not counting this header. */
+ }ARENA_BLOCK;
+
+typedef struct arena
+ {
+  ARENA_BLOCK *blocks; /* All the blocks, the newest first. */
+  pthread_mutex_t lock;
+ }ARENA;
+
+/* One random restart of the hill climbing in oblique_split.           */
+struct restart
+ {
+  struct training_context *context; /* The context of the split. */
+  int *cur_points, cur_no_of_points;
+  int index;
+  unsigned short random_state[3];
+  double *coefficients; /* The hyperplane found by the restart, */
+  double error;         /* and its impurity. */
+ };
+
+/* A subtree grown by build_subtree, possibly as a task of its own.     */
+struct subtree
+ {
+  struct training_context *context; /* The context it is grown in. */
+  int depth;
+  int *cur_points, cur_no_of_points;
+  int *sorted_points; /* See SORTED. */
+  unsigned short random_state[3];
+  struct tree_node *root;
+ };
+
+/* A leaf of a tree grown best first, with the split found for it     */
+/* (see grow_best_first in mktree.c).                                   */
+struct frontier_node
+ {
+  struct tree_node *node;   /* The split, not in the tree yet. */
+  struct tree_node *parent; /* The node it becomes a child of, NULL */
+  int side;                 /* for the root, and on which side.     */
+  int *cur_points, cur_no_of_points;
+  int *sorted_points;       /* See SORTED. */
+  double split_impurity;
+  double decrease;          /* See impurity_decrease (compute_impurity.c).*/
+  int order;                /* Ties go to the leaf found first. */
+  unsigned short random_state[3]; /* As it was after the split was found.*/
+ };
+
+/* All the state needed to grow one decision tree. Each tree being     */
+/* built has its own context, so several trees can be grown in one      */
+/* process (see mktree.c for the meaning of the parameters).            */
+typedef struct training_context
+ {
+  /* Parameters, set before calling build_tree. */
+  int no_of_dimensions, no_of_categories;
+  int no_of_restarts;
+  int max_no_of_random_perturbations;
+  int order_of_perturbation, cycle_count;
+  int oblique, axis_parallel, cart_mode;
+  int normalize;
+  int presort; /* Sort the attributes once, for axis parallel splits. */
+  int max_bins; /* If not 0, large splits are searched over bins. */
+  int criterion; /* The impurity measure, GINI_INDEX etc. */
+  int max_leaf_nodes; /* If not 0, the tree is grown best first, up to */
+                      /* this many leaves. */
+  int max_depth;      /* If not 0, nodes this deep are not split. */
+  int min_samples_split, min_samples_leaf; /* Points in a node to split, */
+                                           /* and in each of its sides.  */
+  double min_impurity_decrease; /* See split_node (mktree.c). */
+  int max_climb_points; /* If not 0, oblique splits of larger nodes are */
+                        /* hill climbed on a sample of this many points.*/
+  int max_features; /* If not 0, the split of each node is searched on */
+                    /* a random subset of this many attributes.        */
+  int verbose, veryverbose;
+  double ap_bias;
+  FILE *animationfile;
+  int last_split_id; /* With an animation file, each node searched for a */
+  int split_id;      /* split gets an id of its own, and is written with */
+  int split_parent;  /* the id of its parent (0 for the root) and its    */
+  int split_side;    /* side of it. See write_hyperplane (mktree.c).     */
+  unsigned short random_state[3]; /* erand48() state, see myrandom_r. */
+  int no_of_threads;
+
+  /* Work areas, set up by allocate_structures. */
+  int no_of_coeffs;
+  double *coeff_array, *modified_coeff_array, *best_coeff_array;
+  double (*impurity)();     /* The measure, and the sweep of           */
+  double (*split_sorted)(); /* linear_split_sorted for it (perturb.c), */
+                            /* set by select_criterion.                */
+  double *n_log_n;          /* c log2 c and sqrt(c), for the counts c  */
+  double *square_root;      /* = 0..no_of_points, for the measures that*/
+                            /* use them (see select_criterion).        */
+  int *left_count, *right_count;
+  int left_total, right_total;      /* Running totals of left_count  */
+  int left_classes, right_classes;  /* and right_count during a      */
+  double left_squares, right_squares; /* sweep (see start_sweep,     */
+  double left_entropy, right_entropy; /* in perturb.c).              */
+  double total_entropy;
+  struct unidim *candidates;
+  struct unidim *sort_buffer;       /* Used by sort_candidates (sort.c) */
+  unsigned long long *sort_keys;    /* on large arrays of candidates.  */
+  int *partition_buffer;            /* Used by partition_points. */
+  struct unidim *bin_sample;        /* Used by histogram_split        */
+  double *bin_edges, *bin_min, *bin_max; /* (perturb.c), with        */
+  int *bin_counts;                  /* max_bins only.                 */
+  double *temp_val;
+  double *random_vector;            /* Used by perturb_randomly. */
+  int *features, no_of_features;    /* The attributes the split of a */
+                                    /* node is searched on, in order */
+                                    /* (see choose_features).        */
+  int *climb_points, *climb_counts; /* Used by stratified_sample     */
+                                    /* (mktree.c), with              */
+                                    /* max_climb_points only.        */
+  double *attribute_min;
+  int coeff_modified;
+  int no_of_stagnant_perturbations;
+  POINT_STORE *store;
+
+  /* Set up by build_tree, for growing the tree on no_of_threads threads.*/
+  /* Subtrees grown as tasks get contexts of their own (see             */
+  /* fork_context), sharing the pool, workers and store. workers[t] is  */
+  /* a copy of this context, with its own work areas and point values,  */
+  /* used by thread t for the restarts of oblique_split.                */
+  THREAD_POOL *pool;
+  int thread_index; /* Of the thread using this context. */
+  int *presorted; /* Sorted lists of all the points, with presort. */
+  struct training_context *workers;
+  struct restart *restarts;
+  int first_perfect_restart;
+
+  /* The tree is allocated from the arena (see arena.c), each context */
+  /* using a block of its own.                                        */
+  ARENA *arena;
+  ARENA_BLOCK *arena_block;
+
+  /* Result. */
+  struct tree_node *root;
+  int *root_count; /* Samples of each category (1..), from the arena. */
+                   /* The leaf of a tree whose root is not split.    */
+ }TRAINING_CONTEXT;
+
 struct test_outcome
  {
   double leaf_count,tree_depth;
@@ -119,8 +341,92 @@ struct test_outcome
                 classified examples and total number of examples */
  };
 
+/* classify_rows routes the samples to the leaves this many at a time. */
+#define CLASSIFY_BLOCK_SIZE 2048
+
+/* A decision tree laid out for classification, see flat_tree.c.      */
+/* Node k (0..no_of_nodes-1, in depth first order, 0 the root) has    */
+/* its children in children[2*k] (left) and children[2*k+1] (right):  */
+/* the index of the child node if positive, and minus the number of   */
+/* the leaf otherwise. Leaf l (1..no_of_leaves) assigns category      */
+/* leaf_category[l], and LEAF_PROBABILITIES(tree,l)[c] is the         */
+/* fraction of the training samples reaching it in category c.        */
+/* The hyperplane of node k is stored as terms                        */
+/* first_term[k]..first_term[k+1]-1 of the attributes and             */
+/* coefficients arrays, in one of three ways (kind[k]):               */
+/*  DENSE_NODE : all the coefficients, then the constant, as in a     */
+/*               tree_node. constant[k] is the constant again.        */
+/*  SPARSE_NODE : the attributes with nonzero coefficients, and the   */
+/*                coefficients. constant[k] is the constant.          */
+/*  THRESHOLD_NODE : an axis parallel split, with a single term of    */
+/*                   coefficient 1. A sample goes left if the         */
+/*                   attribute is less than constant[k].              */
+#define DENSE_NODE 0
+#define SPARSE_NODE 1
+#define THRESHOLD_NODE 2
+
+/* Hyperplanes with at most this fraction of nonzero coefficients are */
+/* stored as SPARSE_NODEs.                                            */
+#define SPARSE_NODE_FRACTION 0.5
+
+typedef struct flat_tree
+ {
+  int no_of_nodes,no_of_dimensions;
+  char *kind;
+  int *first_term;
+  int *attributes;
+  double *coefficients;
+  double *constant;
+  int *children;
+  int no_of_categories,no_of_leaves;
+  int *leaf_category;
+  double *leaf_probabilities;
+  /* The image the arrays are in, if made by map_model or read_model  */
+  /* (model_file.c), or NULL. It is mapped from a file, or allocated. */
+  char *image;
+  size_t image_size;
+  int image_mapped;
+ }FLAT_TREE;
+
+#define LEAF_PROBABILITIES(tree,l) \
+  ((tree)->leaf_probabilities + (size_t)((l) - 1) * (tree)->no_of_categories - 1)
+
+/* A FLAT_TREE stored as an image by store_model (in memory) or        */
+/* write_model (in a file), see model_file.c.                          */
+/* The header is followed by the arrays of the tree, in the order of   */
+/* the fields below, without the unused first entries of the 1-indexed */
+/* ones. All numbers are little endian.                                */
+#define MODEL_MAGIC "OC1MODEL"
+#define MODEL_VERSION 1
+
+typedef struct model_header
+ {
+  char magic[8];
+  int version;
+  int header_size; /* sizeof(MODEL_HEADER) */
+  int no_of_nodes,no_of_dimensions,no_of_categories,no_of_leaves;
+  int no_of_terms;
+  int reserved; /* 0, keeps the header a multiple of 8 bytes. */
+  /* Then, in this order:                                             */
+  /*   double coefficients[no_of_terms], constant[no_of_nodes],        */
+  /*     leaf_probabilities[no_of_leaves * no_of_categories];          */
+  /*   int first_term[no_of_nodes+1], attributes[no_of_terms],         */
+  /*     children[2*no_of_nodes], leaf_category[no_of_leaves];         */
+  /*   char kind[no_of_nodes].                                         */
+ }MODEL_HEADER;
+
 void error(),free_ivector(),free_vector(),free_dvector();
-double myrandom(),*vector();
+extern void (*hyperplane_values)(), (*add_scaled_column)();
+double myrandom(),myrandom_r(),*vector();
 double *dvector();
 int *ivector();
 double average(),sdev();
+FLAT_TREE *flatten_tree();
+int flat_tree_category();
+void free_flat_tree(),classify_flat(),classify_rows(),rows_probabilities();
+int write_model(),store_model();
+ARENA *create_arena();
+char *arena_allocate();
+void free_arena();
+size_t model_size();
+FLAT_TREE *map_model(),*read_model();
@@ -9,30 +9,35 @@
 /* Last modified : October 1993					*/
 /* Contains modules :	suggest_perturbation			*/
 /*			perturb_randomly			*/
+/*			random_feature_hyperplane		*/
 /*			linear_split				*/ 
-/*			compare					*/
+/*			linear_split_sorted			*/
+/*			split_sorted_gini_index			*/
+/*			split_sorted_info_gain			*/
+/*			split_sorted_any			*/
+/*			sweep_sorted				*/
+/*			histogram_split				*/
+/*			start_sweep				*/
+/*			move_left				*/
+/*			sweep_impurity				*/
 /*			find_values				*/
 /* Uses modules in :	oc1.h					*/ 
 /*			util.c					*/
 /*			compute_impurity.c			*/
+/*			sort.c					*/
 /* Is used by modules in :	mktree.c			*/
 /****************************************************************/		
 
 #include "oc1.h"
 
-extern int no_of_coeffs;
-extern int no_of_dimensions,no_of_categories;
-extern int *left_count,*right_count;
-extern int coeff_modified;
-extern double *coeff_array;
-extern double *modified_coeff_array;
-extern struct unidim *candidates;
-extern double *temp_val; /*Work area */
-
-double mygamma;
 double compute_impurity();
-double myabs(),myrandom();
+double myabs(),myrandom_r();
 double exp();
+static inline void start_sweep(), move_left();
+static inline double sweep_impurity(), sweep_sorted();
+
+/* Sweeps of criteria other than GINI_INDEX and INFO_GAIN. */
+#define ANY_CRITERION	-1
 
 
 /************************************************************************/
@@ -43,7 +48,7 @@ double exp();
 /*                 separately in the module cart_perturb_constant.      */
 /*                 OC1 can be made to mimic Linear Combinations CART    */
 /*                 using the -K flag for Mktree.                        */
-/* Parameters :  cur_points: Pointers to the points under consideration.*/
+/* Parameters :  cur_points: Indices of the points under consideration.*/
 /*               cur_no_of_points                                       */
 /*               cur_coeff: Coefficient to be perturbed by hill climbing*/
 /*               cur_error: Impurity before perturbation.               */
@@ -55,47 +60,51 @@ double exp();
 /* Important Variables used : gamma and lambda : see CART book, chapter */
 /*                            5 for a description.                      */
 /************************************************************************/
-double cart_perturb(cur_points,cur_no_of_points, cur_coeff,cur_error)
-     POINT **cur_points;
+double cart_perturb(context, cur_points,cur_no_of_points, cur_coeff,cur_error)
+     TRAINING_CONTEXT *context;
+     int *cur_points;
      double cur_error;
      int cur_no_of_points,cur_coeff;
 {
   int i,j,bestsplit,no_of_eff_points;
   double d_dim_error;
   double x,linear_split();
-  double lambda, best_lambda,best_mygamma,best_impurity;
+  double lambda, mygamma, best_lambda,best_mygamma,best_impurity;
+  double *val = context->store->val;
+  double *column = COLUMN(context->store,cur_coeff);
+  int *category = context->store->category;
   
-  for (i=1;i<=no_of_coeffs;i++)
-    modified_coeff_array[i] = coeff_array[i];
+  for (i=1;i<=context->no_of_coeffs;i++)
+    context->modified_coeff_array[i] = context->coeff_array[i];
   
-  if (coeff_modified == TRUE) find_values(cur_points,cur_no_of_points);
+  if (context->coeff_modified == TRUE) find_values(context, cur_points,cur_no_of_points);
   
   for (mygamma = -0.25; mygamma <=0.25; mygamma+=0.25)
     {
       no_of_eff_points = 0;
       
       /* cur_coeff should be less than no_of_coeffs */
-      if (cur_coeff != no_of_coeffs)
+      if (cur_coeff != context->no_of_coeffs)
 	for (i=1;i<=cur_no_of_points;i++)
-	  if (cur_points[i]->dimension[cur_coeff] + mygamma != 0)
+	  if (column[cur_points[i]] + mygamma != 0)
 	    {
 	      no_of_eff_points++;
-	      candidates[no_of_eff_points].cat = cur_points[i]->category;
-	      x = (double)(cur_points[i]->val/(cur_points[i]->dimension[cur_coeff]
+	      context->candidates[no_of_eff_points].cat = category[cur_points[i]];
+	      x = (double)(val[cur_points[i]]/(column[cur_points[i]]
 					      + mygamma));
-	      candidates[no_of_eff_points].value = x;
+	      context->candidates[no_of_eff_points].value = x;
 	    }
       
-      lambda = linear_split(no_of_eff_points);
+      lambda = linear_split(context, no_of_eff_points);
       
-      reset_counts();
+      reset_counts(context);
       for (i=1;i<=cur_no_of_points;i++)
-	if (cur_points[i]->val - lambda * (cur_points[i]->dimension[cur_coeff]
+	if (val[cur_points[i]] - lambda * (column[cur_points[i]]
 					   + mygamma) < 0)
-	  left_count[cur_points[i]->category]++;
-	else right_count[cur_points[i]->category]++;
+	  context->left_count[category[cur_points[i]]]++;
+	else context->right_count[category[cur_points[i]]]++;
       
-      d_dim_error = compute_impurity(cur_no_of_points);
+      d_dim_error = compute_impurity(context, cur_no_of_points);
  
       if (mygamma == -0.25)
 	{
@@ -112,8 +121,8 @@ double cart_perturb(cur_points,cur_no_of_points, cur_coeff,cur_error)
     }
  
   cur_error = best_impurity;
-  modified_coeff_array[cur_coeff] -= best_lambda;
-  modified_coeff_array[no_of_coeffs] -= best_lambda * best_mygamma;
+  context->modified_coeff_array[cur_coeff] -= best_lambda;
+  context->modified_coeff_array[context->no_of_coeffs] -= best_lambda * best_mygamma;
   
   return(cur_error);  
 }
@@ -122,7 +131,7 @@ double cart_perturb(cur_points,cur_no_of_points, cur_coeff,cur_error)
 /* Module name : Cart_Perturb_Constant                                  */
 /* Functionality : Implements the CART-Linear Combinations perturbation */
 /*                 algorithm for the constant (displacement) term.      */
-/* Parameters :  cur_points: Pointers to the points under consideration.*/
+/* Parameters :  cur_points: Indices of the points under consideration.*/
 /*               cur_no_of_points                                       */
 /*               cur_error: Impurity before perturbation.               */
 /* Returns :     Impurity of the hyperplane after perturbation.         */
@@ -130,11 +139,13 @@ double cart_perturb(cur_points,cur_no_of_points, cur_coeff,cur_error)
 /*                 linear_split                                         */
 /*                 compute_impurity (compute_impurity.c)                */
 /* Is called by modules :  cart_split (mktree.c)                        */
+/*                         oblique_split (mktree.c)                     */
 /* Important Variables used :
 /* Remarks :
 /************************************************************************/
-double cart_perturb_constant(cur_points,cur_no_of_points,cur_error)
-     POINT **cur_points;
+double cart_perturb_constant(context, cur_points,cur_no_of_points,cur_error)
+     TRAINING_CONTEXT *context;
+     int *cur_points;
      double cur_error;
      int cur_no_of_points;
 {
@@ -142,30 +153,32 @@ double cart_perturb_constant(cur_points,cur_no_of_points,cur_error)
   double d_dim_error;
   double x,linear_split();
   double lambda;
+  double *val = context->store->val;
+  int *category = context->store->category;
   
-  for (i=1;i<=no_of_coeffs;i++)
-    modified_coeff_array[i] = coeff_array[i];
-  if (coeff_modified == TRUE) find_values(cur_points,cur_no_of_points);
+  for (i=1;i<=context->no_of_coeffs;i++)
+    context->modified_coeff_array[i] = context->coeff_array[i];
+  if (context->coeff_modified == TRUE) find_values(context, cur_points,cur_no_of_points);
   no_of_eff_points = 0;
   
   for (i=1;i<=cur_no_of_points;i++)
     {
       no_of_eff_points++;
-      candidates[no_of_eff_points].cat = cur_points[i]->category;
-      candidates[no_of_eff_points].value = (double)cur_points[i]->val;
+      context->candidates[no_of_eff_points].cat = category[cur_points[i]];
+      context->candidates[no_of_eff_points].value = (double)val[cur_points[i]];
     }
   
-  lambda = linear_split(no_of_eff_points);
+  lambda = linear_split(context, no_of_eff_points);
   
-  reset_counts();
+  reset_counts(context);
   for (i=1;i<=cur_no_of_points;i++)
     {
-      if (cur_points[i]->val-lambda < 0) left_count[cur_points[i]->category]++;
-      else right_count[cur_points[i]->category]++;
+      if (val[cur_points[i]]-lambda < 0) context->left_count[category[cur_points[i]]]++;
+      else context->right_count[category[cur_points[i]]]++;
     }
 
-  cur_error = compute_impurity(cur_no_of_points);
-  modified_coeff_array[no_of_coeffs] -= lambda;
+  cur_error = compute_impurity(context, cur_no_of_points);
+  context->modified_coeff_array[context->no_of_coeffs] -= lambda;
 
   return(cur_error);
 }
@@ -177,8 +190,8 @@ double cart_perturb_constant(cur_points,cur_no_of_points,cur_error)
 /*			as the existing value, in terms of the global	*/
 /*			impurity measure. If no such value can be found,*/
 /*			HUGE is returned. 				*/
-/* Parameters :	cur_points : array of pointers to the points under	*/
-/*			     consideration.				*/
+/* Parameters :	cur_points : indices (in the store) of the points	*/
+/*			     under consideration.			*/
 /*		cur_no_of_points : count of the points in consideration.*/
 /*		cur_coeff : coefficient to be improved.			*/
 /*		cur_error_ptr : Pointer to the impurity of the current	*/
@@ -190,9 +203,8 @@ double cart_perturb_constant(cur_points,cur_no_of_points,cur_error)
 /*			linear_split					*/
 /*			reset_counts (compute_impurity.c)		*/
 /*			compute_impurity (compute_impurity.c)		*/
-/*			myrandom (util.c)				*/
 /* Is called by modules :	oblique_split (mktree.c)		*/
-/* Important Variables used : 	no_of_stagnant_perturbations : global	*/
+/* Important Variables used : 	no_of_stagnant_perturbations : context	*/
 /*				variable that tells us how many pertur-	*/
 /*				bations, immediately preceding the	*/
 /*				current one, were consecutively 	*/
@@ -204,69 +216,75 @@ double cart_perturb_constant(cur_points,cur_no_of_points,cur_error)
 /* Remarks :	For a detailed description of the perturbation 		*/
 /*		algorithm, see Murthy et al's paper in AAAI-93.		*/
 /************************************************************************/
-double suggest_perturbation(cur_points,cur_no_of_points,cur_coeff,cur_error)
-     POINT **cur_points;
+double suggest_perturbation(context, cur_points,cur_no_of_points,cur_coeff,cur_error)
+     TRAINING_CONTEXT *context;
+     int *cur_points;
      double cur_error;
      int cur_no_of_points,cur_coeff;
 {
-  extern int no_of_stagnant_perturbations;
   int i,j,lpt,rpt,bestsplit,no_of_eff_points=0;
   double d_dim_error;
   double suggest_perturbation();
   double x,linear_split();
   double newval,changeinval;
+  double *val = context->store->val;
+  double *column = NULL;
+  int *category = context->store->category;
 
-  for (i=1;i<=no_of_coeffs;i++)
-     modified_coeff_array[i] = coeff_array[i];
+  for (i=1;i<=context->no_of_coeffs;i++)
+     context->modified_coeff_array[i] = context->coeff_array[i];
 
-  if (coeff_modified == TRUE) find_values(cur_points,cur_no_of_points);
+  if (context->coeff_modified == TRUE) find_values(context, cur_points,cur_no_of_points);
 
-  if (cur_coeff == no_of_coeffs)
+  if (cur_coeff == context->no_of_coeffs)
     for (i=1;i<=cur_no_of_points;i++)
       { 
 	no_of_eff_points++;
-	candidates[no_of_eff_points].cat = cur_points[i]->category;
-	candidates[no_of_eff_points].value =
-	  coeff_array[no_of_coeffs] - (double)cur_points[i]->val;
+	context->candidates[no_of_eff_points].cat = category[cur_points[i]];
+	context->candidates[no_of_eff_points].value =
+	  context->coeff_array[context->no_of_coeffs] - (double)val[cur_points[i]];
       }
   else 
-    for (i=1;i<=cur_no_of_points;i++)
-      if (cur_points[i]->dimension[cur_coeff] != 0)
-	{
-	  no_of_eff_points++;
-	  candidates[no_of_eff_points].cat = cur_points[i]->category;
-	  x = (double)(cur_points[i]->val/cur_points[i]->dimension[cur_coeff]);
-	  candidates[no_of_eff_points].value = coeff_array[cur_coeff] - x;
-	}
+    {
+      column = COLUMN(context->store,cur_coeff);
+      for (i=1;i<=cur_no_of_points;i++)
+	if (column[cur_points[i]] != 0)
+	  {
+	    no_of_eff_points++;
+	    context->candidates[no_of_eff_points].cat = category[cur_points[i]];
+	    x = (double)(val[cur_points[i]]/column[cur_points[i]]);
+	    context->candidates[no_of_eff_points].value = context->coeff_array[cur_coeff] - x;
+	  }
+    }
 
-  newval = linear_split(no_of_eff_points);
-  changeinval = newval - coeff_array[cur_coeff];
+  newval = linear_split(context, no_of_eff_points);
+  changeinval = newval - context->coeff_array[cur_coeff];
   
-  reset_counts();
+  reset_counts(context);
   for (i=1;i<=cur_no_of_points;i++)
     {
-      temp_val[i] = cur_points[i]->val;
+      context->temp_val[i] = val[cur_points[i]];
       
-      if (cur_coeff == no_of_coeffs) temp_val[i] += changeinval;
-      else temp_val[i] += changeinval * cur_points[i]->dimension[cur_coeff];
-      if (temp_val[i] < 0) left_count[cur_points[i]->category]++;
-      else right_count[cur_points[i]->category]++;
+      if (cur_coeff == context->no_of_coeffs) context->temp_val[i] += changeinval;
+      else context->temp_val[i] += changeinval * column[cur_points[i]];
+      if (context->temp_val[i] < 0) context->left_count[category[cur_points[i]]]++;
+      else context->right_count[category[cur_points[i]]]++;
     }
 
-  d_dim_error = compute_impurity(cur_no_of_points);
+  d_dim_error = compute_impurity(context, cur_no_of_points);
   
   if (cur_error < d_dim_error ||
       (myabs(cur_error-d_dim_error) <= TOLERANCE &&
-       no_of_stagnant_perturbations >  MAX_NO_OF_STAGNANT_PERTURBATIONS))
+       context->no_of_stagnant_perturbations >  MAX_NO_OF_STAGNANT_PERTURBATIONS))
     return(cur_error);
   
-  modified_coeff_array[cur_coeff] = newval;
+  context->modified_coeff_array[cur_coeff] = newval;
   
   if (myabs(cur_error-d_dim_error) <= TOLERANCE)
-    no_of_stagnant_perturbations++;
+    context->no_of_stagnant_perturbations++;
   else 
     {
-      no_of_stagnant_perturbations = 0;
+      context->no_of_stagnant_perturbations = 0;
       cur_error = d_dim_error;
     }
   
@@ -281,8 +299,8 @@ double suggest_perturbation(cur_points,cur_no_of_points,cur_coeff,cur_error)
 /*			The amount of perturbation along the random 	*/
 /*			direction is chosen so that the global impurity	*/
 /*			is minimized.					*/
-/* Parameters :	cur_points : Array of pointers to the points under	*/
-/*		consideration.						*/
+/* Parameters :	cur_points : Indices (in the store) of the points	*/
+/*		under consideration.					*/
 /*		cur_no_of_points : Number of points in consideration.	*/
 /*		cur_error_ptr :	Pointer to the current value of global	*/
 /*		impurity.						*/
@@ -292,179 +310,261 @@ double suggest_perturbation(cur_points,cur_no_of_points,cur_coeff,cur_error)
 /*		FALSE : otherwise					*/
 /*		The new location of the hyperplane, after perturbation,	*/
 /*		can be obtained from the global array "coeff_array".	*/
-/* Calls modules :	vector (util.c)					*/
-/*			generate_random_hyperplane (train_util.c)	*/
+/* Calls modules :	random_feature_hyperplane			*/
 /*			find_values					*/
 /*			reset_counts (compute_impurity.c)		*/
 /*			linear_split 					*/
 /*			compute_impurity (compute_impurity.c)		*/	
-/*			free_vector (util.c)				*/
 /* Is called by modules : oblique_split (mktree.c)			*/
 /************************************************************************/
-double perturb_randomly(cur_points,cur_no_of_points,cur_error,cur_label)
-     POINT **cur_points;
+double perturb_randomly(context, cur_points,cur_no_of_points,cur_error)
+     TRAINING_CONTEXT *context;
+     int *cur_points;
      double cur_error;
      int cur_no_of_points;
-     char *cur_label;
 {
-  extern int no_of_stagnant_perturbations;
-  int i,j,no_of_eff_points=0;
+  int i,j,f,no_of_eff_points=0;
   double d_dim_error;
-  double *rvector;
+  double *rvector = context->random_vector,*row;
   double alpha,linear_split();
+  double *val = context->store->val;
+  int *category = context->store->category;
   
-  for (i=1;i<=no_of_coeffs;i++)
-    modified_coeff_array[i] = coeff_array[i];
+  for (i=1;i<=context->no_of_coeffs;i++)
+    context->modified_coeff_array[i] = context->coeff_array[i];
   
-  rvector = vector(1,no_of_coeffs);
-  generate_random_hyperplane(rvector,no_of_coeffs,MAX_COEFFICIENT);
+  random_feature_hyperplane(context,rvector);
   
-  if (coeff_modified == TRUE) find_values(cur_points,cur_no_of_points);
+  if (context->coeff_modified == TRUE) find_values(context, cur_points,cur_no_of_points);
 
   for (i=1;i<=cur_no_of_points;i++)
     {
-      temp_val[i] = rvector[no_of_coeffs];
-      for (j=1;j<no_of_coeffs;j++)
-	temp_val[i] += rvector[j] * cur_points[i]->dimension[j];
+      row = ROW(context->store,cur_points[i]);
+      context->temp_val[i] = rvector[context->no_of_coeffs];
+      for (f=1;f<=context->no_of_features;f++)
+	{
+	  j = context->features[f];
+	  context->temp_val[i] += rvector[j] * row[j];
+	}
       
-      if (temp_val[i])
+      if (context->temp_val[i])
 	{
 	  no_of_eff_points++;
-	  candidates[no_of_eff_points].cat = cur_points[i]->category;
-	  candidates[no_of_eff_points].value = 
-	    (double)(-1.0 * (cur_points[i]->val / temp_val[i]));
+	  context->candidates[no_of_eff_points].cat = category[cur_points[i]];
+	  context->candidates[no_of_eff_points].value = 
+	    (double)(-1.0 * (val[cur_points[i]] / context->temp_val[i]));
 	}
     }
   
-  if (!no_of_eff_points) 
-    {
-      free_vector(rvector,1,no_of_coeffs);
-      return(FALSE);
-    }
+  if (!no_of_eff_points) return(FALSE);
   
-  alpha = linear_split(no_of_eff_points);
+  alpha = linear_split(context, no_of_eff_points);
   
-  reset_counts();
+  reset_counts(context);
   for (i=1;i<=cur_no_of_points;i++)
     {
-      temp_val[i] *= alpha;
-      temp_val[i] += cur_points[i]->val;
-      if (temp_val[i] < 0) left_count[cur_points[i]->category]++;
-      else right_count[cur_points[i]->category]++;
+      context->temp_val[i] *= alpha;
+      context->temp_val[i] += val[cur_points[i]];
+      if (context->temp_val[i] < 0) context->left_count[category[cur_points[i]]]++;
+      else context->right_count[category[cur_points[i]]]++;
     }
   
-  d_dim_error = compute_impurity(cur_no_of_points);
+  d_dim_error = compute_impurity(context, cur_no_of_points);
 
   if (cur_error > d_dim_error)
     {
-      no_of_stagnant_perturbations = 0;
-      for (i=1;i<=no_of_coeffs;i++)
-	modified_coeff_array[i] +=  rvector[i]*alpha;
+      context->no_of_stagnant_perturbations = 0;
+      for (i=1;i<=context->no_of_coeffs;i++)
+	context->modified_coeff_array[i] +=  rvector[i]*alpha;
       cur_error = d_dim_error;
     }
   
-  free_vector(rvector,1,no_of_coeffs);
   return(cur_error);
 }
 
 /************************************************************************/
-/* Module name : compare						*/
-/* Functionality : 	used by the C library function "qsort".		*/
-/*			see "man qsort" for more details.		*/
-/* Parameters :	ptr1,ptr2 : Pointers to the values that are to be	*/
-/*		compared. In this case, we are comparing the values 	*/
-/*		suggested by two data points for a hyperplane 		*/
-/*		coefficient. See the "Important variables used" section	*/
-/*		below.							*/ 
-/* Returns :	1, 0 or -1, depending on whether the first value is	*/
-/*		more, equal or less than the second.			*/
-/* Calls modules : None.						*/
-/* Is called by modules : qsort in linear_split				*/
-/* Important Variables used : struct unidim : Consider the 2D case. Let	*/
-/*		the equation of the hyperplane be ax1+bx2+c=0. a,b and	*/
-/*		c have some values for the current hyperplane location.	*/
-/*		We are trying to perturb the hyperplane to a better	*/
-/*		location. We do this coefficient after coefficient. 	*/
-/*		Consider "a" as a variable, whose value we need to 	*/
-/*		determine, and b and c as constants. By substituting	*/
-/*		each data point in the above equation, we get a value	*/
-/*		for "a". It is this value that is stored in the "value"	*/
-/*		field of the structure unidim. The "cat" field stores	*/
-/*		the category of the data point under consideration.	*/
+/* Module name : random_feature_hyperplane				*/
+/* Functionality :	Generates a random hyperplane on the attributes	*/
+/*			the split of the current node is searched on.	*/
+/* Parameters :	array : set to the coefficients, those of the other	*/
+/*			attributes to 0.				*/
+/* Returns :	Nothing.						*/
+/* Calls modules :	myrandom_r (util.c)				*/
+/* Is called by modules :	perturb_randomly			*/
+/*				run_restart (mktree.c)			*/
+/* Remarks :	With all the attributes, the hyperplane is the one	*/
+/*		generate_random_hyperplane (util.c) would give.		*/
 /************************************************************************/
-int compare(ptr1,ptr2) 
-     struct unidim  *ptr1,*ptr2;
+random_feature_hyperplane(context,array)
+     TRAINING_CONTEXT *context;
+     double *array;
 {
-  double x;
-  
-  x = (*ptr1).value - (*ptr2).value;
-  
-  if (x > 0) return(1); 
-  else if (x) return(-1);
-  else return(0);
-}
+  int i;
 
+  for (i=1;i<=context->no_of_coeffs;i++) array[i] = 0;
+  for (i=1;i<=context->no_of_features;i++)
+    array[context->features[i]] =
+      myrandom_r(-1.0 * MAX_COEFFICIENT,MAX_COEFFICIENT,context->random_state);
+  array[context->no_of_coeffs] =
+    myrandom_r(-1.0 * MAX_COEFFICIENT,MAX_COEFFICIENT,context->random_state);
+}
 
 /************************************************************************/
 /* Module name : linear_split						*/ 
 /* Functionality :	Sorts the values in the unidim structure	*/
-/*			array "candidates" (see the module header for	*/
-/*			"compare" above), and splits the array at a 	*/
-/*			position that minimizes the impurity measure.	*/
+/*			array "candidates" (see the Remarks below), and	*/
+/*			splits the array at a position that minimizes	*/
+/*			the impurity measure.				*/
 /* Parameters :	no_of_eff_points : Number of valid entries in the	*/
 /*				   "candidates" array.		*/
 /* Returns :	value of the coefficient that results in an optimal	*/
 /*		one dimensional spilit.					*/ 
-/* Calls modules :	qsort (C library routine)			*/
-/*			myrandom (util.c)				*/
-/*			reset_counts (compute_impurity.c)		*/
-/*			compute_impurity (compute_impurity.c)		*/
+/* Calls modules :	sort_candidates (sort.c)			*/
+/*			linear_split_sorted				*/
+/*			histogram_split					*/
 /* Is called by modules :	suggest_perturbation			*/
 /*				perturb_randomly			*/
 /*				axis_parallel_split (mktree.c)		*/	
 /* Remarks :								*/ 
+/*	     1.	struct unidim : Consider the 2D case. Let the equation	*/
+/*		of the hyperplane be ax1+bx2+c=0. a,b and c have some	*/
+/*		values for the current hyperplane location. We are	*/
+/*		trying to perturb the hyperplane to a better location.	*/
+/*		We do this coefficient after coefficient. Consider "a"	*/
+/*		as a variable, whose value we need to determine, and b	*/
+/*		and c as constants. By substituting each data point in	*/
+/*		the above equation, we get a value for "a". It is this	*/
+/*		value that is stored in the "value" field of the	*/
+/*		structure unidim. The "cat" field stores the category	*/
+/*		of the data point under consideration.			*/
 /*	     2.	A Lot of the computation done in OC1 takes place in	*/
-/*		the "qsort" system call in this routine, and in the	*/
-/*		module "find_values".					*/
+/*		the sorting in this routine, and in the module		*/
+/*		"find_values". So if max_bins is set, arrays of more	*/
+/*		than TOO_SMALL_FOR_HISTOGRAM entries are split by	*/
+/*		histogram_split instead, without sorting.		*/
+/************************************************************************/
+double linear_split(context, no_of_eff_points)
+     TRAINING_CONTEXT *context;
+     int no_of_eff_points;
+{
+  double linear_split_sorted(), histogram_split();
+  
+  if (context->max_bins && no_of_eff_points > TOO_SMALL_FOR_HISTOGRAM(context))
+    return(histogram_split(context, no_of_eff_points));
+
+  sort_candidates(context->candidates,no_of_eff_points,context->sort_buffer,
+		  context->sort_keys);
+  
+  return(linear_split_sorted(context, no_of_eff_points));
+}
+
+/************************************************************************/
+/* Module name : linear_split_sorted					*/ 
+/* Functionality :	Splits the array "candidates", already sorted	*/
+/*			in increasing order of the "value" fields, at a	*/
+/*			position that minimizes the impurity measure.	*/
+/* Parameters :	no_of_eff_points : Number of valid entries in the	*/
+/*				   "candidates" array.		*/
+/* Returns :	value of the coefficient that results in an optimal	*/
+/*		one dimensional spilit.					*/ 
+/* Calls modules :	context->split_sorted : the split_sorted_...	*/
+/*			module for the criterion (see select_criterion	*/
+/*			in compute_impurity.c).				*/
+/* Is called by modules :	linear_split				*/
+/*				histogram_split				*/
+/*				axis_parallel_split (mktree.c)		*/	
 /************************************************************************/
-double linear_split(no_of_eff_points)
+double linear_split_sorted(context, no_of_eff_points)
+     TRAINING_CONTEXT *context;
      int no_of_eff_points;
+{
+  return((*context->split_sorted)(context, no_of_eff_points));
+}
+
+/************************************************************************/
+/* Module name : split_sorted_gini_index, split_sorted_info_gain,	*/
+/*		 split_sorted_any					*/
+/* Functionality :	linear_split_sorted for the Gini index, the	*/
+/*			information gain, and the other measures.	*/
+/* Calls modules :	sweep_sorted					*/
+/* Is called by modules :	linear_split_sorted			*/
+/* Remarks :	Each is sweep_sorted compiled for its criterion, with	*/
+/*		the tests on the criterion in the sweep taken out.	*/
+/************************************************************************/
+double split_sorted_gini_index(context, no_of_eff_points)
+     TRAINING_CONTEXT *context;
+     int no_of_eff_points;
+{
+  return(sweep_sorted(context, no_of_eff_points, GINI_INDEX));
+}
+
+double split_sorted_info_gain(context, no_of_eff_points)
+     TRAINING_CONTEXT *context;
+     int no_of_eff_points;
+{
+  return(sweep_sorted(context, no_of_eff_points, INFO_GAIN));
+}
+
+double split_sorted_any(context, no_of_eff_points)
+     TRAINING_CONTEXT *context;
+     int no_of_eff_points;
+{
+  return(sweep_sorted(context, no_of_eff_points, ANY_CRITERION));
+}
+
+/************************************************************************/
+/* Module name : sweep_sorted						*/ 
+/* Functionality :	Does the work of linear_split_sorted.		*/
+/* Parameters :	no_of_eff_points : Number of valid entries in the	*/
+/*				   "candidates" array.		*/
+/*		criterion : GINI_INDEX, INFO_GAIN or ANY_CRITERION.	*/
+/* Returns :	value of the coefficient that results in an optimal	*/
+/*		one dimensional spilit.					*/ 
+/* Calls modules :	myrandom_r (util.c)				*/
+/*			reset_counts (compute_impurity.c)		*/
+/*			start_sweep					*/
+/*			move_left					*/
+/*			sweep_impurity					*/
+/* Is called by modules :	split_sorted_gini_index			*/
+/*				split_sorted_info_gain			*/
+/*				split_sorted_any			*/
+/* Remarks :	Only the order of the values matters, not the order of	*/
+/*		points with equal values.				*/
+/************************************************************************/
+static inline double sweep_sorted(context, no_of_eff_points, criterion)
+     TRAINING_CONTEXT *context;
+     int no_of_eff_points;
+     int criterion;
 {
   int i,j,from,to,bestsplit;
   double temp,impurity_1d;
   double newval;
   int l1,l2,r1,r2;
-  int compare();
   
-  candidates += 1;
-  qsort((char *)candidates,no_of_eff_points,sizeof(struct unidim),compare);
-  candidates -= 1;
-  
-  reset_counts();
+  reset_counts(context);
   for (i=1;i<=no_of_eff_points;i++)
-    right_count[candidates[i].cat]++;
+    context->right_count[context->candidates[i].cat]++;
   
-  impurity_1d = compute_impurity(no_of_eff_points);
+  start_sweep(context,criterion);
+  impurity_1d = sweep_impurity(context,criterion);
   bestsplit = 0;
 
   for (i=1;i<=no_of_eff_points;i++)
     {
       from = i;
-      for (to=from+1;to<=no_of_eff_points && candidates[to].value ==
-	   candidates[from].value;to++);
+      for (to=from+1;to<=no_of_eff_points && context->candidates[to].value ==
+	   context->candidates[from].value;to++);
       to -= 1;
       
       for (j=from;j<=to;j++)
-	{
-	  left_count[candidates[j].cat]++;
-	  right_count[candidates[j].cat]--;
-	}
+	move_left(context,context->candidates[j].cat,1,criterion);
 
       i = to;
-      temp = compute_impurity(no_of_eff_points);
+      temp = sweep_impurity(context,criterion);
       
       if (temp < impurity_1d ||
-	  (temp == impurity_1d && myrandom(0.0,1.0) < 0.5))
+	  (temp == impurity_1d &&
+	   myrandom_r(0.0,1.0,context->random_state) < 0.5))
 	{
 	  impurity_1d = temp; 
 	  bestsplit = i; 
@@ -472,16 +572,287 @@ double linear_split(no_of_eff_points)
 	}
     } 
   
-  if (bestsplit == 0) newval = candidates[1].value - TOLERANCE;
+  if (bestsplit == 0) newval = context->candidates[1].value - TOLERANCE;
   else if (bestsplit == no_of_eff_points)
-    newval = candidates[bestsplit].value;
+    newval = context->candidates[bestsplit].value;
   else
-    newval = (candidates[bestsplit].value + 
-              candidates[bestsplit+1].value)/2;
+    newval = (context->candidates[bestsplit].value + 
+              context->candidates[bestsplit+1].value)/2;
+  
+  return(newval);
+}
+
+/************************************************************************/
+/* Module name : histogram_split					*/ 
+/* Functionality :	Approximates linear_split : puts the values of	*/
+/*			the array "candidates" into at most max_bins	*/
+/*			bins, and splits the array at the boundary	*/
+/*			between two bins that minimizes the impurity	*/
+/*			measure.					*/
+/* Parameters :	no_of_eff_points : Number of valid entries in the	*/
+/*				   "candidates" array.		*/
+/* Returns :	value of the coefficient that results in the best	*/
+/*		split found, halfway between the largest value on its	*/
+/*		left and the smallest on its right, as in linear_split.	*/
+/* Calls modules :	sort_candidates (sort.c)			*/
+/*			linear_split_sorted				*/
+/*			myrandom_r (util.c)				*/
+/*			reset_counts (compute_impurity.c)		*/
+/*			start_sweep					*/
+/*			move_left					*/
+/*			sweep_impurity					*/
+/* Is called by modules :	linear_split				*/
+/* Remarks :	The bin boundaries are quantiles of a sample of		*/
+/*		HISTOGRAM_SAMPLES_PER_BIN * max_bins values, taken at	*/
+/*		equal intervals through the array. So the bins hold	*/
+/*		about as many points each, however skewed the values	*/
+/*		are (they are often ratios, with a few huge ones).	*/
+/*		Each value is then binned by a binary search over the	*/
+/*		boundaries, and the split is searched over the per-bin	*/
+/*		counts, which takes O(n log(max_bins)) time in all,	*/
+/*		rather than the O(n log n) of sorting.			*/
+/************************************************************************/
+double histogram_split(context, no_of_eff_points)
+     TRAINING_CONTEXT *context;
+     int no_of_eff_points;
+{
+  int i,b,c,half,remaining,no_of_samples,no_of_edges,no_of_bins;
+  int first,last,next,bestsplit,criterion,*counts;
+  double value,temp,impurity_1d,newval,linear_split_sorted(),*edge;
+  struct unidim *sample = context->bin_sample;
+  double *edges = context->bin_edges;
+  double *bin_min = context->bin_min, *bin_max = context->bin_max;
+  int no_of_categories = context->no_of_categories;
+
+  no_of_samples = HISTOGRAM_SAMPLES_PER_BIN * context->max_bins;
+  if (no_of_samples > no_of_eff_points) no_of_samples = no_of_eff_points;
+  for (i=1;i<=no_of_samples;i++)
+    {
+      sample[i].value = context->candidates[1 + (int)((double)(i-1) *
+				no_of_eff_points / no_of_samples)].value;
+      sample[i].cat = 0;
+    }
+  sort_candidates(sample,no_of_samples,context->sort_buffer,context->sort_keys);
+
+  /* Bin b holds the values from edges[b-1] up to, but not including,
+     edges[b]. */
+  no_of_edges = 0;
+  for (b=1;b<context->max_bins;b++)
+    {
+      value = sample[1 + (int)((double)b * no_of_samples /
+			       context->max_bins)].value;
+      if (value > sample[1].value &&
+	  (no_of_edges == 0 || value > edges[no_of_edges]))
+	edges[++no_of_edges] = value;
+    }
+
+  if (no_of_edges == 0)
+    {
+      /* Most of the values are equal. */
+      sort_candidates(context->candidates,no_of_eff_points,
+		      context->sort_buffer,context->sort_keys);
+      return(linear_split_sorted(context, no_of_eff_points));
+    }
+
+  no_of_bins = no_of_edges + 1;
+  for (i=1;i<=no_of_bins*no_of_categories;i++) context->bin_counts[i] = 0;
+  for (b=1;b<=no_of_bins;b++)
+    {
+      bin_min[b] = HUGE_VAL;
+      bin_max[b] = -HUGE_VAL;
+    }
+
+  /* The binary search below has no branches that depend on the value
+     (the compiler uses conditional moves), as these would be taken
+     at random. */
+  for (i=1;i<=no_of_eff_points;i++)
+    {
+      value = context->candidates[i].value;
+      for (edge=edges+1,remaining=no_of_edges;remaining>1;remaining-=half)
+	{
+	  half = remaining / 2;
+	  edge = (edge[half] <= value) ? edge + half : edge;
+	}
+      b = (edge - edges) + (*edge <= value);
+      context->bin_counts[(b-1)*no_of_categories + context->candidates[i].cat]++;
+      bin_min[b] = (value < bin_min[b]) ? value : bin_min[b];
+      bin_max[b] = (value > bin_max[b]) ? value : bin_max[b];
+    }
+
+  reset_counts(context);
+  for (b=1,first=0,last=0;b<=no_of_bins;b++)
+    {
+      if (bin_min[b] > bin_max[b]) continue; /* Empty bin. */
+      if (first == 0) first = b;
+      last = b;
+      counts = context->bin_counts + (b-1)*no_of_categories;
+      for (c=1;c<=no_of_categories;c++) context->right_count[c] += counts[c];
+    }
+
+  criterion = context->criterion;
+  if (criterion != GINI_INDEX && criterion != INFO_GAIN) criterion = ANY_CRITERION;
+  start_sweep(context,criterion);
+  impurity_1d = sweep_impurity(context,criterion);
+  bestsplit = 0;
+
+  for (b=first;b<=last;b++)
+    {
+      if (bin_min[b] > bin_max[b]) continue;
+      counts = context->bin_counts + (b-1)*no_of_categories;
+      for (c=1;c<=no_of_categories;c++)
+	if (counts[c]) move_left(context,c,counts[c],criterion);
+
+      temp = sweep_impurity(context,criterion);
+      
+      if (temp < impurity_1d ||
+	  (temp == impurity_1d &&
+	   myrandom_r(0.0,1.0,context->random_state) < 0.5))
+	{
+	  impurity_1d = temp; 
+	  bestsplit = b; 
+	  if (impurity_1d == 0) break;
+	}
+    }
+
+  if (bestsplit == 0) newval = bin_min[first] - TOLERANCE;
+  else if (bestsplit == last) newval = bin_max[last];
+  else
+    {
+      for (next=bestsplit+1;bin_min[next] > bin_max[next];next++);
+      newval = (bin_max[bestsplit] + bin_min[next])/2;
+    }
   
   return(newval);
 }
  
 /************************************************************************/
+/* Module name : start_sweep						*/ 
+/* Functionality :	Starts a sweep of a split through sorted	*/
+/*			values : sets the running totals of the counts	*/
+/*			(see TRAINING_CONTEXT), which move_left then	*/
+/*			keeps up to date, for sweep_impurity.		*/
+/* Parameters : criterion : GINI_INDEX, INFO_GAIN or ANY_CRITERION.	*/
+/* Returns : Nothing.							*/
+/* Calls modules : None.						*/
+/* Is called by modules :	sweep_sorted				*/
+/*				histogram_split				*/
+/* Remarks :	All the points must be on the right, left_count being	*/
+/*		zero.							*/
+/************************************************************************/
+static inline void start_sweep(context,criterion)
+     TRAINING_CONTEXT *context;
+     int criterion;
+{
+  int i,count;
+
+  context->left_total = context->left_classes = 0;
+  context->left_squares = context->left_entropy = 0;
+  context->right_total = context->right_classes = 0;
+  context->right_squares = context->right_entropy = 0;
+  for (i=1;i<=context->no_of_categories;i++)
+    if ((count = context->right_count[i]) != 0)
+      {
+	context->right_total += count;
+	context->right_classes++;
+	context->right_squares += (double)count * count;
+	if (criterion == INFO_GAIN)
+	  context->right_entropy += context->n_log_n[count];
+      }
+  context->total_entropy = context->right_entropy;
+}
+
+/************************************************************************/
+/* Module name : move_left						*/ 
+/* Functionality :	Moves points of one category from the right to	*/
+/*			the left of the split during a sweep, updating	*/
+/*			the counts and their running totals.		*/
+/* Parameters :	cat : the category.					*/
+/*		count : the number of points.				*/
+/*		criterion : as for start_sweep.				*/
+/* Returns : Nothing.							*/
+/* Calls modules : None.						*/
+/* Is called by modules :	sweep_sorted				*/
+/*				histogram_split				*/
+/* Remarks :	Takes constant time, however many categories there are.	*/
 /************************************************************************/
+static inline void move_left(context,cat,count,criterion)
+     TRAINING_CONTEXT *context;
+     int cat,count,criterion;
+{
+  int left = context->left_count[cat], right = context->right_count[cat];
+  double *n_log_n = context->n_log_n;
 
+  context->left_count[cat] = left + count;
+  context->right_count[cat] = right - count;
+  context->left_total += count;
+  context->right_total -= count;
+  context->left_classes += (left == 0);
+  context->right_classes -= (right == count);
+  /* (l+n)^2 - l^2, exactly, as the sums of squares are whole numbers. */
+  context->left_squares += (double)count * (2 * (double)left + count);
+  context->right_squares -= (double)count * (2 * (double)right - count);
+  if (criterion == INFO_GAIN)
+    {
+      context->left_entropy += n_log_n[left + count] - n_log_n[left];
+      context->right_entropy += n_log_n[right - count] - n_log_n[right];
+    }
+}
+
+/************************************************************************/
+/* Module name : sweep_impurity						*/ 
+/* Functionality :	Computes the impurity of the split during a	*/
+/*			sweep, as compute_impurity would.		*/
+/* Parameters : criterion : as for start_sweep.			*/
+/* Returns :	impurity.						*/
+/* Calls modules : context->impurity					*/
+/* Is called by modules :	sweep_sorted				*/
+/*				histogram_split				*/
+/* Remarks :	The sweeps evaluate a split at every distinct value, so	*/
+/*		this is the innermost loop of OC1. The running totals	*/
+/*		save compute_impurity's passes over the counts (to check*/
+/*		them, and in stop_splitting), and the Gini index and the*/
+/*		information gain are computed from them in constant	*/
+/*		time, with table lookups only. The other measures are	*/
+/*		computed by the routine of the criterion.		*/
+/*		Splitting stops (impurity 0) if each side holds at most	*/
+/*		one category. Splits leaving fewer than			*/
+/*		min_samples_leaf points on a side are not to be chosen	*/
+/*		(impurity HUGE_VAL), as in compute_impurity.		*/
+/************************************************************************/
+static inline double sweep_impurity(context,criterion)
+     TRAINING_CONTEXT *context;
+     int criterion;
+{
+  double *n_log_n = context->n_log_n;
+  int left = context->left_total, right = context->right_total;
+  double total = left + right, presplit_info, postsplit_info, infogain;
+
+  if (TOO_SMALL_A_LEAF(context,left,right)) return(HUGE_VAL);
+  if (total <= 1 || (context->left_classes <= 1 && context->right_classes <= 1))
+    return(0);
+
+  if (criterion == GINI_INDEX)
+    {
+      /* n * gini = n - (sum of the squared counts) / n, on each side. */
+      total -= right ? context->right_squares / right : 0;
+      total -= left ? context->left_squares / left : 0;
+      return(total / (left + right));
+    }
+
+  if (criterion == INFO_GAIN)
+    {
+      /* n * entropy = n log n - (sum of count log count), on each side. */
+      postsplit_info = n_log_n[left] - context->left_entropy +
+	n_log_n[right] - context->right_entropy;
+      presplit_info = n_log_n[left + right] - context->total_entropy;
+      infogain = (presplit_info - postsplit_info) / total;
+      if (infogain <= NO_GAIN * presplit_info / total)
+	return(HUGE_VAL); /* No information gained. */
+      return(1.0/infogain);
+    }
+
+  return((*context->impurity)(context));
+}
+
+/************************************************************************/
+/************************************************************************/
@@ -92,7 +92,7 @@ struct tree_node *prune(dtree,prune_points,no_of_prune_points)
 /* Parameters :	root : Pointer to the root of the decision tree to be	*/
 /*		pruned.							*/
 /* Returns :	Pointer to the root of the pruned decision tree.	*/
-/* Calls modules :	leaf_count (classify_util.c)			*/
+/* Calls modules :	leaf_count (tree_util.c)			*/
 /*			estimate_accuracy (classify.c)	*/
 /*			cut_weakest_links				*/
 /* Is called by modules : 	prune					*/
@@ -136,7 +136,7 @@ struct tree_node *error_complexity_prune(root)
       if (tree_array[tree_index].root == NULL) break;
       tree_array[tree_index].cresult = 
 	estimate_accuracy(ptest_points,no_of_ptest_points,
-			  tree_array[tree_index].root);
+			  tree_array[tree_index].root,NULL);
     }
 
   no_of_trees = tree_index - 1;
@@ -175,7 +175,7 @@ struct tree_node *error_complexity_prune(root)
 /* Returns :	Pointer to the root of a decision tree, which is the	*/
 /*		same as the input tree, except that the weakest links	*/
 /*		have been cut.						*/
-/* Calls modules :	leaf_count (classify_util.c)			*/
+/* Calls modules :	leaf_count (tree_util.c)			*/
 /*			compute_alpha					*/
 /*			replicate_tree					*/
 /*			cut_subtrees					*/
@@ -236,7 +236,7 @@ struct tree_node *cut_weakest_links(dtree)
 /* Calls modules :	node_cost					*/
 /*			subtree_cost					*/
 /*			compute_alpha					*/
-/*			leaf_count (classify_util.c)			*/
+/*			leaf_count (tree_util.c)			*/
 /* Is called by modules : 	cut_weakest_links			*/
 /*				compute_alpha				*/
 /************************************************************************/
@@ -369,7 +369,8 @@ struct tree_node *replicate_tree(root)
   if (duplicate->right != NULL) (duplicate->right)->parent = duplicate;
   duplicate->left_cat = root->left_cat;
   duplicate->right_cat = root->right_cat;
-  strcpy(duplicate->label,root->label);
+  duplicate->id = root->id;
+  duplicate->depth = root->depth;
   duplicate->alpha = root->alpha;
   duplicate->no_of_points = root->no_of_points;
   
@@ -438,7 +439,7 @@ deallocate_tree(root)
   free_vector(root->coefficients,1,no_of_coeffs);
   free_ivector(root->left_count,1,no_of_categories);
   free_ivector(root->right_count,1,no_of_categories);
-  
+  free((char *)root);
 }
 
 /************************************************************************/
@@ -0,0 +1,276 @@
+/****************************************************************/
+/* File Name : sort.c						*/
+/* Contains modules :	sort_candidates				*/
+/*			introsort				*/
+/*			insertion_sort				*/
+/*			heap_sort				*/
+/*			sift_down				*/
+/*			radix_sort				*/
+/* Uses modules in :	oc1.h					*/
+/* Is used by modules in :	perturb.c			*/
+/*				sort_benchmark.c		*/
+/* Remarks       :	Sorting of the "candidates" array of	*/
+/*			linear_split, in increasing order of	*/
+/*			the "value" fields, without the calls	*/
+/*			through a function pointer and the byte	*/
+/*			by byte swaps of the qsort library	*/
+/*			routine. Small arrays are sorted by an	*/
+/*			introsort (quicksort, falling back to	*/
+/*			heapsort on bad pivots), large ones by	*/
+/*			a least significant digit first radix	*/
+/*			sort on the bits of the values.		*/
+/*			The order of equal values is not	*/
+/*			defined, as with qsort; linear_split	*/
+/*			does not depend on it.			*/
+/****************************************************************/
+#include "oc1.h"
+
+#define INSERTION_SORT_THRESHOLD 16
+#define SWAP(a,b) { struct unidim temp_unidim = (a); (a) = (b); (b) = temp_unidim; }
+
+static introsort(), insertion_sort(), heap_sort(), sift_down(), radix_sort();
+
+/************************************************************************/
+/* Module name : sort_candidates                                        */
+/* Functionality : Sorts an array of unidim structures in increasing    */
+/*                 order of the "value" fields.                         */
+/* Parameters : candidates : the array (1..no_of_candidates).           */
+/*              no_of_candidates : number of entries.                   */
+/*              buffer : work area of no_of_candidates entries, and     */
+/*              keys : work area of 2 * no_of_candidates entries, both  */
+/*                     used only if no_of_candidates is at least        */
+/*                     RADIX_SORT_THRESHOLD (oc1.h).                    */
+/* Returns : Nothing.                                                   */
+/* Calls modules : introsort                                            */
+/*                 radix_sort                                           */
+/* Is called by modules : linear_split (perturb.c)                      */
+/************************************************************************/
+sort_candidates(candidates, no_of_candidates, buffer, keys)
+     struct unidim *candidates, *buffer;
+     int no_of_candidates;
+     unsigned long long *keys;
+{
+  int depth_limit = 0, i;
+
+  if (no_of_candidates < 2) return;
+
+  if (no_of_candidates >= RADIX_SORT_THRESHOLD)
+    {
+      radix_sort(candidates + 1, no_of_candidates, buffer, keys);
+      return;
+    }
+
+  for (i = no_of_candidates; i > 1; i /= 2) depth_limit += 2;
+  introsort(candidates, 1, no_of_candidates, depth_limit);
+}
+
+/************************************************************************/
+/* Module name : introsort                                              */
+/* Functionality : Quicksorts array[lo..hi], with the median of three   */
+/*                 as the pivot. Partitions smaller than                */
+/*                 INSERTION_SORT_THRESHOLD are insertion sorted, and   */
+/*                 after depth_limit levels of partitioning the rest is */
+/*                 heap sorted, so the worst case is O(n log n).        */
+/* Parameters : array : the array.                                      */
+/*              lo, hi : bounds of the part to be sorted.               */
+/*              depth_limit : levels of partitioning left.              */
+/* Returns : Nothing.                                                   */
+/* Calls modules : insertion_sort                                       */
+/*                 heap_sort                                            */
+/*                 introsort                                            */
+/* Is called by modules : sort_candidates                               */
+/*                        introsort                                     */
+/* Remarks : Recurses on the smaller part only, so the stack stays      */
+/*           O(log n) deep.                                             */
+/************************************************************************/
+static introsort(array, lo, hi, depth_limit)
+     struct unidim *array;
+     int lo, hi, depth_limit;
+{
+  int i, j, mid;
+  double pivot;
+
+  while (hi - lo + 1 > INSERTION_SORT_THRESHOLD)
+    {
+      if (depth_limit-- == 0)
+	{
+	  heap_sort(array, lo, hi);
+	  return;
+	}
+
+      /* Put the median of array[lo], array[mid], array[hi] at hi-1;
+	 the other two then stop the scans below. */
+      mid = lo + (hi - lo) / 2;
+      if (array[mid].value < array[lo].value) SWAP(array[mid], array[lo]);
+      if (array[hi].value < array[lo].value) SWAP(array[hi], array[lo]);
+      if (array[hi].value < array[mid].value) SWAP(array[hi], array[mid]);
+      SWAP(array[mid], array[hi - 1]);
+      pivot = array[hi - 1].value;
+
+      i = lo;
+      j = hi - 1;
+      while (TRUE)
+	{
+	  while (array[++i].value < pivot);
+	  while (pivot < array[--j].value);
+	  if (i >= j) break;
+	  SWAP(array[i], array[j]);
+	}
+      SWAP(array[i], array[hi - 1]);
+
+      if (i - lo < hi - i)
+	{
+	  introsort(array, lo, i - 1, depth_limit);
+	  lo = i + 1;
+	}
+      else
+	{
+	  introsort(array, i + 1, hi, depth_limit);
+	  hi = i - 1;
+	}
+    }
+
+  insertion_sort(array, lo, hi);
+}
+
+/************************************************************************/
+/* Module name : insertion_sort                                         */
+/* Functionality : Sorts array[lo..hi] by insertion.                    */
+/* Parameters : array : the array.                                      */
+/*              lo, hi : bounds of the part to be sorted.               */
+/* Returns : Nothing.                                                   */
+/* Calls modules : None.                                                */
+/* Is called by modules : introsort                                     */
+/************************************************************************/
+static insertion_sort(array, lo, hi)
+     struct unidim *array;
+     int lo, hi;
+{
+  int i, j;
+  struct unidim current;
+
+  for (i = lo + 1; i <= hi; i++)
+    {
+      current = array[i];
+      for (j = i - 1; j >= lo && current.value < array[j].value; j--)
+	array[j + 1] = array[j];
+      array[j + 1] = current;
+    }
+}
+
+/************************************************************************/
+/* Module name : heap_sort                                              */
+/* Functionality : Sorts array[lo..hi] by heapsort.                     */
+/* Parameters : array : the array.                                      */
+/*              lo, hi : bounds of the part to be sorted.               */
+/* Returns : Nothing.                                                   */
+/* Calls modules : sift_down                                            */
+/* Is called by modules : introsort                                     */
+/************************************************************************/
+static heap_sort(array, lo, hi)
+     struct unidim *array;
+     int lo, hi;
+{
+  struct unidim *heap = array + lo - 1; /* heap[1..n] is array[lo..hi] */
+  int i, n = hi - lo + 1;
+
+  for (i = n / 2; i >= 1; i--) sift_down(heap, i, n);
+  for (i = n; i > 1; i--)
+    {
+      SWAP(heap[1], heap[i]);
+      sift_down(heap, 1, i - 1);
+    }
+}
+
+/************************************************************************/
+/* Module name : sift_down                                              */
+/* Functionality : Moves heap[root] down the max-heap heap[1..n] to its */
+/*                 place.                                               */
+/* Parameters : heap : the heap.                                        */
+/*              root : the entry to be moved.                           */
+/*              n : size of the heap.                                   */
+/* Returns : Nothing.                                                   */
+/* Calls modules : None.                                                */
+/* Is called by modules : heap_sort                                     */
+/************************************************************************/
+static sift_down(heap, root, n)
+     struct unidim *heap;
+     int root, n;
+{
+  int child;
+  struct unidim current = heap[root];
+
+  while ((child = 2 * root) <= n)
+    {
+      if (child < n && heap[child].value < heap[child + 1].value) child++;
+      if (!(current.value < heap[child].value)) break;
+      heap[root] = heap[child];
+      root = child;
+    }
+  heap[root] = current;
+}
+
+/************************************************************************/
+/* Module name : radix_sort                                             */
+/* Functionality : Sorts array[0..n-1] by the bits of the "value"       */
+/*                 fields, one byte per pass, least significant first.  */
+/* Parameters : array : the array (indexed from 0).                     */
+/*              n : number of entries.                                  */
+/*              buffer : work area of n entries.                        */
+/*              keys : work area of 2n entries.                         */
+/* Returns : Nothing.                                                   */
+/* Calls modules : None.                                                */
+/* Is called by modules : sort_candidates                               */
+/* Remarks : The bits of an IEEE-754 double, with the sign bit flipped  */
+/*           for positive numbers and all the bits flipped for negative */
+/*           ones, compare as unsigned integers in the same order as    */
+/*           the numbers themselves. Passes over a byte that is the     */
+/*           same in all the keys (such as the exponent, when the       */
+/*           values are of similar size) are skipped.                   */
+/************************************************************************/
+static radix_sort(array, n, buffer, keys)
+     struct unidim *array, *buffer;
+     int n;
+     unsigned long long *keys;
+{
+  static const unsigned long long sign = 1ULL << 63;
+  unsigned long long *from_keys = keys, *to_keys = keys + n, *temp_keys, bits;
+  struct unidim *from = array, *to = buffer, *temp;
+  int count[8][256], offset, pass, digit, i;
+
+  memset(count, 0, sizeof(count));
+  for (i = 0; i < n; i++)
+    {
+      memcpy(&bits, &array[i].value, sizeof(bits));
+      bits = (bits & sign) ? ~bits : (bits | sign);
+      keys[i] = bits;
+      for (pass = 0; pass < 8; pass++)
+	count[pass][(bits >> (8 * pass)) & 0xFF]++;
+    }
+
+  for (pass = 0; pass < 8; pass++)
+    {
+      if (count[pass][(from_keys[0] >> (8 * pass)) & 0xFF] == n) continue;
+
+      for (digit = 0, offset = 0; digit < 256; digit++)
+	{
+	  i = count[pass][digit];
+	  count[pass][digit] = offset;
+	  offset += i;
+	}
+      for (i = 0; i < n; i++)
+	{
+	  digit = (from_keys[i] >> (8 * pass)) & 0xFF;
+	  to_keys[count[pass][digit]] = from_keys[i];
+	  to[count[pass][digit]++] = from[i];
+	}
+
+      temp = from; from = to; to = temp;
+      temp_keys = from_keys; from_keys = to_keys; to_keys = temp_keys;
+    }
+
+  if (from != array) memcpy(array, from, n * sizeof(struct unidim));
+}
+
+/************************************************************************/
+/************************************************************************/
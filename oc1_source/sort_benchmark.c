@@ -0,0 +1,138 @@
+/****************************************************************/
+/* File Name : sort_benchmark.c					*/
+/* Contains modules :	main					*/
+/*			qsort_compare				*/
+/*			fill_candidates				*/
+/* Uses modules in :	oc1.h					*/
+/*			sort.c					*/
+/*			util.c					*/
+/* Is used by modules in :	None.				*/
+/* Remarks       :	Times sort_candidates (sort.c) against	*/
+/*			the qsort library routine, as linear_	*/
+/*			split used to call it, on arrays of	*/
+/*			different sizes and kinds of values,	*/
+/*			and checks that both give the same	*/
+/*			order of values.			*/
+/*			Usage : sort_benchmark [seconds]	*/
+/*			where seconds (default 0.2) is the	*/
+/*			time spent on each measurement.		*/
+/****************************************************************/
+#include "oc1.h"
+#include <time.h>
+
+#define UNIFORM		0
+#define FEW_VALUES	1
+#define PRESORTED	2
+
+char *kinds[] = {"uniform", "10 values", "presorted"};
+int sizes[] = {8, 32, 128, 512, 2048, 8192, 32768, 131072};
+
+/************************************************************************/
+/* Module name : qsort_compare                                          */
+/* Functionality : The comparison function linear_split (perturb.c)     */
+/*                 passed to qsort.                                     */
+/************************************************************************/
+int qsort_compare(ptr1, ptr2)
+     struct unidim *ptr1, *ptr2;
+{
+  double x;
+
+  x = (*ptr1).value - (*ptr2).value;
+
+  if (x > 0) return(1);
+  else if (x) return(-1);
+  else return(0);
+}
+
+/************************************************************************/
+/* Module name : fill_candidates                                        */
+/* Functionality : Fills candidates[1..n] with values of the given kind,*/
+/*                 the same for the same seed.                          */
+/************************************************************************/
+fill_candidates(candidates, n, kind, seed)
+     struct unidim *candidates;
+     int n, kind;
+     long seed;
+{
+  unsigned short state[3];
+  int i;
+
+  seed_random_state(state, seed);
+  for (i = 1; i <= n; i++)
+    {
+      if (kind == FEW_VALUES)
+	candidates[i].value = (int)myrandom_r(0.0, 10.0, state) - 5.0;
+      else if (kind == PRESORTED)
+	candidates[i].value = i - n / 2.0;
+      else candidates[i].value = myrandom_r(-1.0, 1.0, state);
+      candidates[i].cat = i;
+    }
+}
+
+/************************************************************************/
+/* Module name : main                                                   */
+/* Functionality : Prints, for each size and kind of array, the time    */
+/*                 per sort taken by qsort and by sort_candidates.      */
+/************************************************************************/
+main(argc, argv)
+     int argc;
+     char *argv[];
+{
+  struct unidim *candidates, *copy, *buffer;
+  unsigned long long *keys;
+  double seconds = 0.2, elapsed[3];
+  int s, kind, method, i, n, repeats;
+  clock_t start;
+
+  if (argc > 1) seconds = atof(argv[1]);
+
+  n = sizes[sizeof(sizes) / sizeof(int) - 1];
+  candidates = (struct unidim *)malloc(n * sizeof(struct unidim)) - 1;
+  copy = (struct unidim *)malloc(n * sizeof(struct unidim)) - 1;
+  buffer = (struct unidim *)malloc(n * sizeof(struct unidim));
+  keys = (unsigned long long *)malloc(2 * n * sizeof(unsigned long long));
+
+  printf("%8s %-10s %14s %14s %8s\n", "size", "values", "qsort (us)",
+	 "sort (us)", "speedup");
+  for (s = 0; s < sizeof(sizes) / sizeof(int); s++)
+    for (kind = UNIFORM; kind <= PRESORTED; kind++)
+      {
+	n = sizes[s];
+	/* Method 0 is qsort, 1 sort_candidates, and 2 only fills the
+	   arrays, which takes time that is subtracted from the others. */
+	for (method = 0; method < 3; method++)
+	  {
+	    repeats = 0;
+	    start = clock();
+	    do
+	      {
+		fill_candidates(candidates, n, kind, (long)repeats);
+		if (method == 0)
+		  qsort((char *)(candidates + 1), n, sizeof(struct unidim),
+			qsort_compare);
+		else if (method == 1)
+		  sort_candidates(candidates, n, buffer, keys);
+		repeats++;
+	      }
+	    while (clock() - start < seconds * CLOCKS_PER_SEC);
+	    elapsed[method] = 1e6 * (clock() - start) / CLOCKS_PER_SEC / repeats;
+	  }
+	elapsed[0] -= elapsed[2];
+	elapsed[1] -= elapsed[2];
+
+	fill_candidates(copy, n, kind, 0L);
+	qsort((char *)(copy + 1), n, sizeof(struct unidim), qsort_compare);
+	fill_candidates(candidates, n, kind, 0L);
+	sort_candidates(candidates, n, buffer, keys);
+	for (i = 1; i <= n; i++)
+	  if (copy[i].value != candidates[i].value)
+	    error("Sort_Benchmark : sort_candidates and qsort disagree.");
+
+	printf("%8d %-10s %14.2f %14.2f %7.2fx\n", n, kinds[kind],
+	       elapsed[0], elapsed[1], elapsed[0] / elapsed[1]);
+      }
+  return(0);
+}
+
+/************************************************************************/
+/************************************************************************/
@@ -0,0 +1,296 @@
+/****************************************************************/
+/* File Name : thread_pool.c					*/
+/* Contains modules :	create_thread_pool			*/
+/*			destroy_thread_pool			*/
+/*			submit_task				*/
+/*			wait_for_tasks				*/
+/*			take_task				*/
+/*			run_task				*/
+/*			pool_worker				*/
+/* Uses modules in :	oc1.h					*/
+/*			util.c					*/
+/* Is used by modules in :	mktree.c			*/
+/* Remarks       :	A fixed set of POSIX threads that run	*/
+/*			queued tasks. A task is a		*/
+/*			function called as			*/
+/*			  function(argument, thread_index)	*/
+/*			where thread_index is 0 for the thread	*/
+/*			that created the pool and 1..n-1 for	*/
+/*			the pool's own threads, so that tasks	*/
+/*			can pick per-thread work areas.		*/
+/*			Tasks are counted in TASK_GROUPs. A	*/
+/*			thread waiting for a group runs queued	*/
+/*			tasks itself in the meantime, so tasks	*/
+/*			may submit and wait for other tasks.	*/
+/*			Each thread queues the tasks it submits	*/
+/*			in a deque of its own, and runs the	*/
+/*			newest of them first. A thread with an	*/
+/*			empty deque steals the oldest task of	*/
+/*			another thread, which is usually the	*/
+/*			largest piece of work queued there.	*/
+/****************************************************************/
+#include "oc1.h"
+
+#define INITIAL_DEQUE_SIZE 16
+
+int take_task();
+void *pool_worker();
+
+/************************************************************************/
+/* Module name : create_thread_pool                                     */
+/* Functionality : Starts no_of_threads - 1 threads, which wait for     */
+/*                 tasks. The calling thread is counted as thread 0.    */
+/* Parameters : no_of_threads : total number of threads to run tasks on.*/
+/* Returns : pointer to the pool, NULL if no_of_threads <= 1 (tasks     */
+/*           submitted to a NULL pool are run immediately).             */
+/* Calls modules : error (util.c)                                       */
+/* Is called by modules : build_tree (mktree.c)                         */
+/************************************************************************/
+THREAD_POOL * create_thread_pool(no_of_threads)
+int no_of_threads; {
+  THREAD_POOL * pool;
+  struct pool_thread * thread;
+  TASK_DEQUE * deque;
+  int i;
+
+  if (no_of_threads <= 1) return (NULL);
+
+  pool = (THREAD_POOL * ) malloc(sizeof(THREAD_POOL));
+  if (pool == NULL) error("Create_Thread_Pool : Memory allocation failure.");
+
+  pool -> no_of_threads = no_of_threads;
+  pool -> deques = (TASK_DEQUE * ) malloc(no_of_threads * sizeof(TASK_DEQUE));
+  pool -> threads = (struct pool_thread * )
+    malloc((no_of_threads - 1) * sizeof(struct pool_thread));
+  if (pool -> deques == NULL || pool -> threads == NULL)
+    error("Create_Thread_Pool : Memory allocation failure.");
+  for (i = 0; i < no_of_threads; i++) {
+    deque = & pool -> deques[i];
+    deque -> size = INITIAL_DEQUE_SIZE;
+    deque -> tasks = (TASK * ) malloc(deque -> size * sizeof(TASK));
+    if (deque -> tasks == NULL)
+      error("Create_Thread_Pool : Memory allocation failure.");
+    deque -> top = deque -> no_of_tasks = 0;
+  }
+  pool -> no_of_tasks = 0;
+  pool -> shutdown = FALSE;
+  pthread_mutex_init( & pool -> lock, NULL);
+  pthread_cond_init( & pool -> changed, NULL);
+
+  for (i = 1; i < no_of_threads; i++) {
+    thread = & pool -> threads[i - 1];
+    thread -> pool = pool;
+    thread -> index = i;
+    if (pthread_create( & thread -> id, NULL, pool_worker, thread))
+      error("Create_Thread_Pool : Cannot start a thread.");
+  }
+  return (pool);
+}
+
+/************************************************************************/
+/* Module name : destroy_thread_pool                                    */
+/* Functionality : Stops the threads of a pool and frees it.            */
+/* Parameters : pool : pool created by create_thread_pool, or NULL.     */
+/* Returns : Nothing.                                                   */
+/* Calls modules : None.                                                */
+/* Is called by modules : build_tree (mktree.c)                         */
+/* Remarks : All the tasks submitted should have been waited for.       */
+/************************************************************************/
+destroy_thread_pool(pool)
+THREAD_POOL * pool; {
+  int i;
+
+  if (pool == NULL) return;
+
+  pthread_mutex_lock( & pool -> lock);
+  pool -> shutdown = TRUE;
+  pthread_cond_broadcast( & pool -> changed);
+  pthread_mutex_unlock( & pool -> lock);
+
+  for (i = 1; i < pool -> no_of_threads; i++)
+    pthread_join(pool -> threads[i - 1].id, NULL);
+
+  pthread_mutex_destroy( & pool -> lock);
+  pthread_cond_destroy( & pool -> changed);
+  for (i = 0; i < pool -> no_of_threads; i++)
+    free((char * ) pool -> deques[i].tasks);
+  free((char * ) pool -> deques);
+  free((char * ) pool -> threads);
+  free((char * ) pool);
+}
+
+/************************************************************************/
+/* Module name : submit_task                                            */
+/* Functionality : Queues function(argument, thread_index) to be run on */
+/*                 one of the threads of the pool.                      */
+/* Parameters : pool : pool created by create_thread_pool. If NULL, the */
+/*                     task is run right away, as thread 0.             */
+/*              group : the task is counted in this group until done.   */
+/*              function, argument : the task.                          */
+/*              thread_index : index of the calling thread in the pool. */
+/* Returns : Nothing.                                                   */
+/* Calls modules : error (util.c)                                       */
+/* Is called by modules : oblique_split (mktree.c)                      */
+/*                        build_subtree (mktree.c)                      */
+/************************************************************************/
+submit_task(pool, group, function, argument, thread_index)
+THREAD_POOL * pool;
+TASK_GROUP * group;
+void( * function)();
+void * argument;
+int thread_index; {
+  TASK_DEQUE * deque;
+  TASK * tasks, * task;
+  int i;
+
+  if (pool == NULL) {
+    ( * function)(argument, 0);
+    return;
+  }
+
+  pthread_mutex_lock( & pool -> lock);
+  deque = & pool -> deques[thread_index];
+  if (deque -> no_of_tasks == deque -> size) {
+    tasks = (TASK * ) malloc(2 * deque -> size * sizeof(TASK));
+    if (tasks == NULL) error("Submit_Task : Memory allocation failure.");
+    for (i = 0; i < deque -> no_of_tasks; i++)
+      tasks[i] = deque -> tasks[(deque -> top + i) % deque -> size];
+    free((char * ) deque -> tasks);
+    deque -> tasks = tasks;
+    deque -> top = 0;
+    deque -> size *= 2;
+  }
+  task = & deque -> tasks[(deque -> top + deque -> no_of_tasks) % deque -> size];
+  task -> function = function;
+  task -> argument = argument;
+  task -> group = group;
+  deque -> no_of_tasks++;
+  pool -> no_of_tasks++;
+  group -> pending++;
+  pthread_cond_broadcast( & pool -> changed);
+  pthread_mutex_unlock( & pool -> lock);
+}
+
+/************************************************************************/
+/* Module name : wait_for_tasks                                         */
+/* Functionality : Returns when all the tasks of a group are done.      */
+/*                 Queued tasks (of any group) are run by the waiting   */
+/*                 thread in the meantime.                              */
+/* Parameters : pool : pool the tasks were submitted to, or NULL.       */
+/*              group : the group waited for.                           */
+/*              thread_index : index of the calling thread in the pool. */
+/* Returns : Nothing.                                                   */
+/* Calls modules : take_task                                            */
+/*                 run_task                                             */
+/* Is called by modules : oblique_split (mktree.c)                      */
+/*                        build_subtree (mktree.c)                      */
+/************************************************************************/
+wait_for_tasks(pool, group, thread_index)
+THREAD_POOL * pool;
+TASK_GROUP * group;
+int thread_index; {
+  TASK task;
+
+  if (pool == NULL) return;
+
+  pthread_mutex_lock( & pool -> lock);
+  while (group -> pending > 0) {
+    if (take_task(pool, thread_index, & task)) run_task(pool, & task, thread_index);
+    else pthread_cond_wait( & pool -> changed, & pool -> lock);
+  }
+  pthread_mutex_unlock( & pool -> lock);
+}
+
+/************************************************************************/
+/* Module name : take_task                                              */
+/* Functionality : Takes the newest task off the deque of the calling   */
+/*                 thread, or if that is empty, the oldest task off the */
+/*                 deque of another thread.                             */
+/* Parameters : pool : the pool.                                        */
+/*              thread_index : index of the calling thread.             */
+/*              task : the task taken is copied here.                   */
+/* Returns : TRUE if a task was taken, FALSE if none is queued.         */
+/* Calls modules : None.                                                */
+/* Is called by modules : wait_for_tasks                                */
+/*                        pool_worker                                   */
+/* Remarks : Is called with pool -> lock held.                          */
+/************************************************************************/
+int take_task(pool, thread_index, task)
+THREAD_POOL * pool;
+int thread_index;
+TASK * task; {
+  TASK_DEQUE * deque;
+  int i;
+
+  if (pool -> no_of_tasks == 0) return (FALSE);
+
+  deque = & pool -> deques[thread_index];
+  if (deque -> no_of_tasks > 0) {
+    deque -> no_of_tasks--;
+    * task = deque -> tasks[(deque -> top + deque -> no_of_tasks) % deque -> size];
+  } else {
+    for (i = 1; i < pool -> no_of_threads; i++) {
+      deque = & pool -> deques[(thread_index + i) % pool -> no_of_threads];
+      if (deque -> no_of_tasks > 0) break;
+    }
+    * task = deque -> tasks[deque -> top];
+    deque -> top = (deque -> top + 1) % deque -> size;
+    deque -> no_of_tasks--;
+  }
+  pool -> no_of_tasks--;
+  return (TRUE);
+}
+
+/************************************************************************/
+/* Module name : run_task                                               */
+/* Functionality : Runs a task taken by take_task.                      */
+/* Parameters : pool : the pool.                                        */
+/*              task : the task.                                        */
+/*              thread_index : index of the calling thread.             */
+/* Returns : Nothing.                                                   */
+/* Calls modules : None.                                                */
+/* Is called by modules : wait_for_tasks                                */
+/*                        pool_worker                                   */
+/* Remarks : Is called, and returns, with pool -> lock held. The lock   */
+/*           is released while the task runs.                           */
+/************************************************************************/
+run_task(pool, task, thread_index)
+THREAD_POOL * pool;
+TASK * task;
+int thread_index; {
+  pthread_mutex_unlock( & pool -> lock);
+
+  ( * task -> function)(task -> argument, thread_index);
+
+  pthread_mutex_lock( & pool -> lock);
+  if (--task -> group -> pending == 0)
+    pthread_cond_broadcast( & pool -> changed);
+}
+
+/************************************************************************/
+/* Module name : pool_worker                                            */
+/* Functionality : Body of each thread of a pool. Runs queued tasks     */
+/*                 until the pool is destroyed.                         */
+/* Parameters : thread : the pool_thread structure of this thread.      */
+/* Returns : NULL.                                                      */
+/* Calls modules : take_task                                            */
+/*                 run_task                                             */
+/* Is called by modules : create_thread_pool (through pthread_create)   */
+/************************************************************************/
+void * pool_worker(thread)
+struct pool_thread * thread; {
+  THREAD_POOL * pool = thread -> pool;
+  TASK task;
+
+  pthread_mutex_lock( & pool -> lock);
+  while (TRUE) {
+    if (take_task(pool, thread -> index, & task)) run_task(pool, & task, thread -> index);
+    else if (pool -> shutdown) break;
+    else pthread_cond_wait( & pool -> changed, & pool -> lock);
+  }
+  pthread_mutex_unlock( & pool -> lock);
+  return (NULL);
+}
+
+/************************************************************************/
+/************************************************************************/
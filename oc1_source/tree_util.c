@@ -9,15 +9,13 @@
 /* Author : Sreerama K. Murthy					*/
 /* Last modified : July 1994					*/
 /* Contains modules : 	read_tree				*/
-/*			read_subtree				*/
 /*			read_hp					*/
+/*			number_nodes				*/
 /*			read_header				*/
 /*			write_tree				*/
 /*			write_subtree				*/
 /*			write_hp       				*/
 /*			write_header				*/
-/*			isleftchild				*/
-/*			isrightchild				*/
 /*			leaf_count				*/
 /*			tree_depth				*/
 /* Uses modules in :	oc1.h					*/
@@ -41,9 +39,9 @@ char train_data[LINESIZE];
 /* Parameters :	decision_tree : Name of the file in which the tree is	*/
 /*		stored.							*/
 /* Returns :	pointer to the root node of the tree.			*/
-/* Calls modules :	read_subtree					*/
-/*			read_header					*/
+/* Calls modules :	read_header					*/
 /*			read_hp						*/
+/*			number_nodes					*/
 /*			error (util.c)					*/
 /* Is called by modules :	main (mktree.c)				*/
 /*				main (gen_data.c)			*/
@@ -51,12 +49,18 @@ char train_data[LINESIZE];
 /* 		written in a format similar to the output of the	*/
 /*		write_tree module. A sample decision tree is given in   */
 /*              the file sample.dt.				        */ 
+/*		The nodes are kept in an array indexed by their ids as	*/
+/*		they are read, and linked to their parents once all are	*/
+/*		read, so the nodes may come in any order, and reading	*/
+/*		takes time linear in the number of nodes.		*/
 /************************************************************************/
 struct tree_node *read_tree(decision_tree)
      char *decision_tree;
 {
   FILE *dtree;
-  struct tree_node *root,*cur_node,*read_hp();
+  struct tree_node *root,*cur_node,*parent,**nodes = NULL,*read_hp();
+  int *parent_ids = NULL,*sides = NULL;
+  int i,id,parent_id,side,max_id = 0,size = 0;
   int read_header();
   
   if ((dtree = fopen(decision_tree,"r")) == NULL)
@@ -65,77 +69,61 @@ struct tree_node *read_tree(decision_tree)
   if ( !(read_header(dtree))) 
     error("Decision tree invalid/absent.");
   
-  if ((root = read_hp(dtree)) == NULL)
-    error("Decision tree invalid/absent.");
-  
-  root->parent = NULL;
-  extra_node = NULL;
-  read_subtree(root,dtree);
-  
-  fclose(dtree);
-  return(root);
-}
-
-
-/************************************************************************/
-/* Module name :	read_subtree					*/ 
-/* Functionality :	recursively reads in the hyperplane, left 	*/
-/*			subtree and the right subtree at a node of 	*/
-/*			the decision tree. 				*/
-/* Parameters :	root : node, the subtree at which is to be read.	*/
-/*		dtree: file pointer where the tree is available.	*/
-/* Returns :	nothing.						*/
-/* Calls modules :	read_subtree					*/
-/*			read_hp						*/
-/*			isleftchild					*/
-/*			isrightchild					*/
-/* Is called by modules :	read_tree				*/
-/*				read_subtree				*/
-/* Important Variables Used :	extra_node 				*/
-/*	Hyperplanes are read from the file "dtree" in the order "parent,*/
-/*	left child, right child". In case a node does not have either a	*/
-/* 	left child or a right child or both, this routine reads one 	*/
-/*	hyperplane before it is needed. Such hyperplanes, that are read	*/
-/*	before they are needed, are stored in extra_node.		*/
-/************************************************************************/
-read_subtree(root,dtree)
-     struct tree_node *root;
-     FILE *dtree;
-{
-  struct tree_node *cur_node,*read_hp();
-  int isleftchild(),isrightchild();
-  
-  if (extra_node != NULL)
+  while ((cur_node = read_hp(dtree,&parent_id,&side)) != NULL)
     {
-      cur_node = extra_node;
-      extra_node = NULL;
+      id = cur_node->id;
+      if (id > size)
+	{
+	  i = size;
+	  size = (2 * size > id) ? 2 * size : id;
+	  nodes = (struct tree_node **)realloc((char *)nodes,
+					       (size+1) * sizeof(struct tree_node *));
+	  parent_ids = (int *)realloc((char *)parent_ids,(size+1) * sizeof(int));
+	  sides = (int *)realloc((char *)sides,(size+1) * sizeof(int));
+	  if (nodes == NULL || parent_ids == NULL || sides == NULL)
+	    error("Read_Tree : Memory allocation failure.");
+	  for (i++;i<=size;i++) nodes[i] = NULL;
+	}
+      if (nodes[id] != NULL) error("Read_Tree: Two nodes with the same id.");
+      nodes[id] = cur_node;
+      parent_ids[id] = parent_id;
+      sides[id] = side;
+      if (id > max_id) max_id = id;
     }
-  else cur_node = read_hp(dtree);
-  
-  if (cur_node == NULL) return;
-  if (isleftchild(cur_node,root))
+  fclose(dtree);
+
+  root = NULL;
+  for (id=1;id<=max_id;id++)
     {
-      cur_node->parent = root;
-      root->left = cur_node;
-      
-      read_subtree(cur_node,dtree);
-      if (extra_node != NULL)
+      if ((cur_node = nodes[id]) == NULL) continue;
+      if (parent_ids[id] == 0)
+	{
+	  if (root != NULL) error("Read_Tree: More than one root.");
+	  root = cur_node;
+	  continue;
+	}
+      if (parent_ids[id] > max_id || (parent = nodes[parent_ids[id]]) == NULL)
+	error("Read_Tree: Parent of a node absent.");
+      if (sides[id] == LEFT)
 	{
-	  cur_node = extra_node;
-	  extra_node = NULL;
+	  if (parent->left != NULL) error("Read_Tree: Two left children.");
+	  parent->left = cur_node;
 	}
       else
-	cur_node = read_hp(dtree);
-      if (cur_node == NULL) return;
+	{
+	  if (parent->right != NULL) error("Read_Tree: Two right children.");
+	  parent->right = cur_node;
+	}
+      cur_node->parent = parent;
     }
 
-  if (isrightchild(cur_node,root))
-    {
-      cur_node->parent = root;
-      root->right = cur_node;
-      read_subtree(cur_node,dtree);
-    }
-  else extra_node = cur_node;
+  if (root == NULL) error("Decision tree invalid/absent.");
+  number_nodes(root,1,0);
+
+  free((char *)nodes);
+  free((char *)parent_ids);
+  free((char *)sides);
+  return(root);
 }
 
 /************************************************************************/
@@ -143,22 +131,28 @@ read_subtree(root,dtree)
 /* Functionality :	Reads a hyperplane (one node of the decision	*/
 /*			tree).						*/
 /* Parameters :	dtree : file pointer to the decision tree file.		*/
-/* Returns : pointer to the decision tree node read.			*/
+/*		parent_id : set to the id of the parent of the node,	*/
+/*		            0 for the root.				*/
+/*		side : set to LEFT or RIGHT, the side of its parent the	*/
+/*		       node is on.					*/
+/* Returns : pointer to the decision tree node read, with its id set.	*/
+/*	     NULL, if there are no more nodes.				*/
 /* Calls modules :	vector (util.c)					*/
 /*			error (util.c)					*/
 /* Is called by modules :	read_tree				*/
-/*				read_subtree				*/
+/*				replay_tree (display.c)			*/
 /* Remarks :	Rather strict adherance to format.			*/
 /*		Please carefully follow the format in sample.dt, if	*/
 /*		your decision tree files are not produced by "mktree".	*/
 /************************************************************************/
-struct tree_node *read_hp(dtree)
+struct tree_node *read_hp(dtree,parent_id,side)
      FILE *dtree;
+     int *parent_id,*side;
 {
   struct tree_node *cur_node;
   double temp;
-  char c;
-  int i;
+  char c,side_str[6];
+  int i,n;
 
   cur_node = (struct tree_node *)malloc(sizeof(struct tree_node));
   cur_node->coefficients = vector(1,no_of_dimensions+1);
@@ -167,13 +161,25 @@ struct tree_node *read_hp(dtree)
   
   for (i=1;i<=no_of_dimensions+1;i++) cur_node->coefficients[i] = 0;
   
-  cur_node->left = cur_node->right = NULL;
+  cur_node->parent = cur_node->left = cur_node->right = NULL;
   
   while (isspace(c = getc(dtree)));
   ungetc(c,dtree); 
   
-  if (fscanf(dtree,"%[^' '] Hyperplane: Left = [", cur_node->label) != 1)
+  if (fscanf(dtree,"Node %d",&cur_node->id) != 1 || cur_node->id <= 0)
     return(NULL);
+  *parent_id = 0;
+  *side = LEFT;
+  if (fscanf(dtree," (%5[a-z] of %d)",side_str,parent_id) == 2)
+    {
+      if (!strcmp(side_str,"right")) *side = RIGHT;
+      else if (strcmp(side_str,"left"))
+	error("Read_Hp: Invalid side of the parent.");
+      if (*parent_id <= 0) error("Read_Hp: Invalid parent id.");
+    }
+  n = 0;
+  fscanf(dtree," Hyperplane: Left = [%n",&n);
+  if (n == 0) return(NULL);
 
   for (i=1;i<no_of_categories;i++)
     if (fscanf(dtree,"%d,",&cur_node->left_count[i]) != 1)
@@ -187,11 +193,9 @@ struct tree_node *read_hp(dtree)
   if (fscanf(dtree,"%d]\n", &cur_node->right_count[no_of_categories]) != 1)
     return(NULL); 
 
-  if (!strcmp(cur_node->label,"Root")) strcpy(cur_node->label,"");
-  
   while (TRUE)
     {
-      if ((fscanf(dtree,"%f %c",&temp,&c)) != 2)
+      if ((fscanf(dtree,"%lf %c",&temp,&c)) != 2)
 	error("Invalid/Absent hyperplane equation.");
       if (c == 'x')
 	{ 
@@ -225,43 +229,31 @@ struct tree_node *read_hp(dtree)
 }
 
 /************************************************************************/
-/* Module name : isleftchild						*/
-/* Functionality : 	Checks if node x is a left child of node y.	*/
-/*			i.e., checks if the label of node x is the same	*/
-/*			as label of y, concatenated with "l".		*/
-/* Parameters : x,y : pointers to two decision tree nodes.		*/
-/* Returns :	1 : if x is the left child of y				*/
-/*		0 : otherwise						*/
-/* Is called by modules :	read_subtree				*/
+/* Module name : number_nodes						*/
+/* Functionality :	Numbers the nodes of a subtree in preorder, and	*/
+/*			sets their depths.				*/
+/* Parameters : cur_node : root of the subtree, or NULL.		*/
+/*		id : id of cur_node.					*/
+/*		depth : depth of cur_node.				*/
+/* Returns :	the id following the last one given in the subtree.	*/
+/* Calls modules :	number_nodes					*/
+/* Is called by modules :	read_tree				*/
+/*				number_nodes				*/
+/*				build_tree (mktree.c)			*/
+/* Remarks :	The root of a tree is numbered 1, so the id of every	*/
+/*		node is larger than that of its parent.			*/
 /************************************************************************/
-int isleftchild(x,y)
-     struct tree_node *x,*y;
+int number_nodes(cur_node,id,depth)
+     struct tree_node *cur_node;
+     int id,depth;
 {
-  char temp[MAX_DT_DEPTH];
-  
-  strcpy(temp,y->label);
-  if (!strcmp(strcat(temp,"l"),x->label)) return(1);
-  else return(0);
-}
+  int number_nodes();
 
-/************************************************************************/
-/* Module name : isrightchild						*/
-/* Functionality : 	Checks if node x is a right child of node y.	*/
-/*			i.e., checks if the label of node x is the same	*/
-/*			as label of y, concatenated with "l".		*/
-/* Parameters : x,y : pointers to two decision tree nodes.		*/
-/* Returns :	1 : if x is the right child of y			*/
-/*		0 : otherwise						*/
-/* Is called by modules :	read_subtree				*/
-/************************************************************************/
-int isrightchild(x,y)
-     struct tree_node *x,*y;
-{
-  char temp[MAX_DT_DEPTH];
-  
-  strcpy(temp,y->label);
-  if (!strcmp(strcat(temp,"r"),x->label)) return(1);
-  else return(0);
+  if (cur_node == NULL) return(id);
+  cur_node->id = id;
+  cur_node->depth = depth;
+  id = number_nodes(cur_node->left,id+1,depth+1);
+  return(number_nodes(cur_node->right,id,depth+1));
 }
 
 /************************************************************************/
@@ -273,6 +265,7 @@ int isrightchild(x,y)
 /*		0 : otherwise.						*/
 /* Calls modules : none.						*/
 /* Is called by modules :	read_tree				*/
+/*				replay_tree (display.c)			*/
 /* Remarks :	Rather strict adherance to format.			*/
 /*		Please carefully follow the format in sample.dt, if	*/
 /*		your decision tree files are not produced by "mktree".	*/
@@ -393,14 +386,15 @@ write_subtree(cur_node,dtree)
 /* Parameters :	cur_node : Pointer to the DT node under consideration.	*/
 /*		dtree : File pointer to the output file.		*/
 /* Is called by modules :	write_subtree				*/
-/* Important Variables used :	cur_node->label : Label is the empty	*/
-/*				string for the root node. If string x	*/
-/*				is the label of a node, xl is the label	*/
-/*				of its left child, and xr of its right	*/
-/*				child. Label plays an important role,	*/
-/*				because it informs the tree reading	*/
-/*				routines (in classify_util.c) about the	*/
-/*				structure of the DT.			*/
+/*				write_hyperplane (mktree.c)		*/
+/* Important Variables used :	cur_node->id : The node is written as	*/
+/*				"Node <id>", followed by "(left of <id	*/
+/*				of the parent>)" or "(right of ...)"	*/
+/*				unless it is the root. This is what	*/
+/*				tells read_tree the structure of the	*/
+/*				DT. In animation files, the nodes have	*/
+/*				provisional ids (see write_hyperplane	*/
+/*				in mktree.c).				*/
 /************************************************************************/
 write_hp(cur_node,dtree)
      struct tree_node *cur_node;
@@ -410,10 +404,12 @@ write_hp(cur_node,dtree)
   
   if (dtree == NULL) return;
   
-  if (strcmp(cur_node->label,"\0") == 0)
-    fprintf(dtree, "Root Hyperplane: ");
+  if (cur_node->parent == NULL)
+    fprintf(dtree, "Node %d Hyperplane: ",cur_node->id);
   else
-    fprintf(dtree, "%s Hyperplane: ",cur_node->label);
+    fprintf(dtree, "Node %d (%s of %d) Hyperplane: ",cur_node->id,
+	    (cur_node->parent->left == cur_node) ? "left" : "right",
+	    cur_node->parent->id);
 
   fprintf(dtree,"Left = [");
   for (i=1;i<=no_of_categories;i++)
@@ -445,6 +441,7 @@ write_hp(cur_node,dtree)
 /* Functionality :	Writes the decision tree header.		*/
 /* Parameters :	dtree : file pointer to the output file.		*/
 /* Is called by modules :	write_tree				*/
+/*				main (mktree.c)				*/
 /************************************************************************/
 write_header(dtree)
      FILE *dtree;
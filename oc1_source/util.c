@@ -10,6 +10,8 @@
 /* Last modified : July 1994					*/
 /* Contains modules : 	error					*/
 /*			myrandom				*/
+/*			myrandom_r				*/
+/*			seed_random_state			*/
 /*			vector					*/
 /*			free_vector				*/
 /*			ivector					*/
@@ -32,6 +34,10 @@
 /****************************************************************/	
 #include <stdio.h>
 
+/* State of the random number sequence used by myrandom. Starts out as */
+/* the state of an unseeded drand48().                                  */
+unsigned short random_state[3] = {0x330E, 0xABCD, 0x1234};
+
 
 /************************************************************************/
 /* Module name : MyLog2                                                  */
@@ -76,17 +82,56 @@ error(error_text)
 /* Parameters :	above, below : lower and upper limits, respectively on	*/
 /*		the random number to be generated.			*/
 /* Returns :	a doubleing point number.				*/
-/* Calls modules :	drand48 (C library call)			*/
-/* Remarks: If your system doesn't support drand48(), you can substitute*/
-/*          the call below with any good pseudo random number generator */
-/*          function call.                                              */
+/* Calls modules :	myrandom_r					*/
 /************************************************************************/
 double myrandom(above,below)
      double above,below;
 {
-  double drand48();
+  double myrandom_r();
+  
+  return (myrandom_r(above,below,random_state));
+}
+
+/************************************************************************/
+/* Module name :	myrandom_r					*/ 
+/* Functionality :	Same as myrandom, but draws from the sequence	*/
+/*			whose state is given, so that each decision	*/
+/*			tree being built can have its own sequence.	*/
+/* Parameters :	above, below : lower and upper limits, respectively on	*/
+/*		the random number to be generated.			*/
+/*		state : three word state of the sequence (see seed_	*/
+/*		random_state). Is updated.				*/
+/* Returns :	a doubleing point number.				*/
+/* Calls modules :	erand48 (C library call)			*/
+/* Remarks: If your system doesn't support erand48(), you can substitute*/
+/*          the call below with any good pseudo random number generator */
+/*          function call that keeps its state in "state".              */
+/************************************************************************/
+double myrandom_r(above,below,state)
+     double above,below;
+     unsigned short *state;
+{
+  double erand48();
   
-  return ((double)(above + drand48() * (below - above)));
+  return ((double)(above + erand48(state) * (below - above)));
+}
+
+/************************************************************************/
+/* Module name :	seed_random_state				*/ 
+/* Functionality :	Seeds the state of a random number sequence, 	*/
+/*			the same way srand48() seeds drand48().		*/
+/* Parameters :	state : three word state, used by myrandom_r.		*/
+/*		seed : the seed.					*/
+/* Returns :	Nothing.						*/
+/* Calls modules :	None.						*/
+/************************************************************************/
+seed_random_state(state,seed)
+     unsigned short *state;
+     long seed;
+{
+  state[0] = 0x330E;
+  state[1] = (unsigned short)(seed & 0xFFFF);
+  state[2] = (unsigned short)((seed >> 16) & 0xFFFF);
 }
 
 
@@ -255,20 +300,22 @@ free_dvector(v,nl,nh)
 /* Functionality :	generates coefficients of a hyperplane randomly.*/
 /* Parameters :	array_name, length of the array.                        */
 /*              max_value : maximum absolute  value of any coefficient  */
+/*              state : random number sequence to draw from.            */
 /* Returns :	Nothing.						*/
-/* Calls modules :	myrandom        				*/
+/* Calls modules :	myrandom_r      				*/
 /* Is called by modules :	oblique_split (mktree.c)		*/
 /*				perturb_randomly (perturb.c)		*/
 /************************************************************************/
-generate_random_hyperplane(array_name,length,max_value)
+generate_random_hyperplane(array_name,length,max_value,state)
      double *array_name,max_value;
      int length;
+     unsigned short *state;
 {
   int i;
-  double myrandom();
+  double myrandom_r();
   
   for (i=1;i<=length;i++)
-    array_name[i] = myrandom(-1.0 * max_value, max_value);
+    array_name[i] = myrandom_r(-1.0 * max_value, max_value, state);
 }
  
 
@@ -288,7 +335,7 @@ usage(pname)
 {
   if (!strcmp(pname, "mktree"))
     {
-      fprintf(stderr,"\n\nUsage: mktree aA:b:Bc:d:D:i:j:Kl:m:M:n:Nop:r:R:s:t:T:uvV:");
+      fprintf(stderr,"\n\nUsage: mktree aA:b:Bc:C:d:D:E:f:F:g:H:i:j:Kl:L:m:M:n:NoP:p:q:Q:r:R:s:St:T:uvV:x:");
       fprintf(stderr,"\nOptions :");
       fprintf(stderr,"\n    -a : Only axis parallel splits.");
       fprintf(stderr,"\n    -A<file to output animation information to>");
@@ -298,16 +345,29 @@ usage(pname)
       fprintf(stderr,"\n    -B : Order of coeff. perturbation= Best First");
       fprintf(stderr,"\n    -c<number of classes> ");
       fprintf(stderr,"\n      (Default: computed from data or decision tree)");
+      fprintf(stderr,"\n    -C<impurity measure : gini, entropy, twoing, hellinger,");
+      fprintf(stderr,"\n       maxminority, summinority or variance> (Default=gini)");
       fprintf(stderr,"\n    -d<number of attributes> ");
       fprintf(stderr,"\n      (Default: computed from data or decision tree)");
       fprintf(stderr,"\n    -D<decision tree file>");
       fprintf(stderr,"\n      (Default=<training data>.dt, for outputting.)");
+      fprintf(stderr,"\n    -E<minimum impurity decrease of a split> (Default=0)");
+      fprintf(stderr,"\n    -f<#attributes, chosen at random, to split each node on>");
+      fprintf(stderr,"\n      (Default=0 i.e., all the attributes)");
+      fprintf(stderr,"\n    -F<binary model file to write the tree to>");
+      fprintf(stderr,"\n      (Default = No output)");
+      fprintf(stderr,"\n    -g<#points to hill climb oblique splits on, sampled");
+      fprintf(stderr,"\n       at larger nodes> (Default=0 i.e., all the points)");
+      fprintf(stderr,"\n    -H<#bins for the split search on large nodes>");
+      fprintf(stderr,"\n      (Default=0 i.e., search over all values)");
       fprintf(stderr,"\n    -i<#restarts for the perturbation alg.>");
       fprintf(stderr,"\n      (Default=20)");
       fprintf(stderr,"\n    -j<maximum number of random jumps");
       fprintf(stderr,"\n       tried at each local minimum> (Default = 5)");
       fprintf(stderr,"\n    -K : CART-linear combinations mode");
       fprintf(stderr,"\n    -l<log file>  (Default=oc1.log)");
+      fprintf(stderr,"\n    -L<maximum number of leaves, grown best first>");
+      fprintf(stderr,"\n      (Default=0 i.e., no maximum)");
       fprintf(stderr,"\n    -m<maximum number of random jumps");
       fprintf(stderr,"\n       tried at each local minimum> (Default = 5)");
       fprintf(stderr,"\n    -M<file to output misclassified instances to>");
@@ -315,13 +375,17 @@ usage(pname)
       fprintf(stderr,"\n    -n<number of training examples> ");
       fprintf(stderr,"\n    -N : No normalization at each tree node.");
       fprintf(stderr,"\n    -o : Only oblique splits.");
+      fprintf(stderr,"\n    -P<#threads to grow the tree on> (Default=1)");
       fprintf(stderr,"\n    -p<portion of training set to be used in pruning>");
       fprintf(stderr,"\n      (Default=0.10 i.e., 10%)");
+      fprintf(stderr,"\n    -q<minimum #points in a node to split it> (Default=2)");
+      fprintf(stderr,"\n    -Q<minimum #points on each side of a split> (Default=1)");
       fprintf(stderr,"\n    -r<#restarts for the perturbation alg.>");
       fprintf(stderr,"\n      (Default=20)");
       fprintf(stderr,"\n    -R<cycle_count>");
       fprintf(stderr,"\n      Order of coeff. pert.= Random. Perturb Cycle_Count times.");
       fprintf(stderr,"\n    -s<integer seed for the random number generator>");
+      fprintf(stderr,"\n    -S : Sort the attributes once, for axis parallel splits.");
       fprintf(stderr,"\n    -t<file containing training data> (Default=None)");
       fprintf(stderr,"\n    -T<file containing testing data> (Default=None)");
       fprintf(stderr,"\n    -u : test data is unlabelled. Label it!");
@@ -329,6 +393,7 @@ usage(pname)
       fprintf(stderr,"\n         very verbose if specified more than once.");
       fprintf(stderr,"\n    -V<#partitions for cross validation>  (Default=0)");
       fprintf(stderr,"\n       (-1 : leave-one-out, 0 = no CV)");
+      fprintf(stderr,"\n    -x<maximum depth of the tree> (Default=0 i.e., no maximum)");
     }
   
  if (!strcmp(pname,"display"))
@@ -0,0 +1,372 @@
+/****************************************************************/
+/* File Name : vector_kernels.c					*/
+/* Contains modules :	select_vector_kernels			*/
+/*			choose_vector_kernels			*/
+/*			substitute_point			*/
+/*			hyperplane_values_scalar		*/
+/*			add_scaled_column_scalar		*/
+/*			hyperplane_values_sse2			*/
+/*			add_scaled_column_sse2			*/
+/*			hyperplane_values_avx2			*/
+/*			add_scaled_column_avx2			*/
+/*			hyperplane_values_avx512		*/
+/*			add_scaled_column_avx512		*/
+/* Uses modules in :	oc1.h					*/
+/* Is used by modules in :	compute_impurity.c		*/
+/*				mktree.c			*/
+/* Remarks       :	The two loops OC1 spends most of its	*/
+/*			time in, substituting points into a	*/
+/*			hyperplane and updating the "val"	*/
+/*			fields after one coefficient changes,	*/
+/*			written with SSE2, AVX2 and AVX-512	*/
+/*			intrinsics. The version to use is	*/
+/*			chosen at run time from what the CPU	*/
+/*			supports, and can be limited by setting	*/
+/*			OC1_VECTOR_ISA to scalar, sse2, avx2 or	*/
+/*			avx512 in the environment.		*/
+/*			The kernels work on several points at	*/
+/*			once, one per lane, and add up the	*/
+/*			terms for each point in the same order	*/
+/*			as the scalar code, without fused	*/
+/*			multiply-adds. So all the versions give	*/
+/*			bit for bit the same results, and the	*/
+/*			tree grown does not depend on the CPU.	*/
+/****************************************************************/
+#include "oc1.h"
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize ("fp-contract=off")
+#endif
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define X86_KERNELS
+#endif
+
+#define SCALAR	0
+#define SSE2	1
+#define AVX2	2
+#define AVX512	3
+
+void hyperplane_values_scalar(), add_scaled_column_scalar();
+void choose_vector_kernels();
+
+/* The kernels in use, set by select_vector_kernels. */
+void (*hyperplane_values)() = hyperplane_values_scalar;
+void (*add_scaled_column)() = add_scaled_column_scalar;
+char *vector_isa = "scalar";
+
+static pthread_once_t vector_kernels_chosen = PTHREAD_ONCE_INIT;
+
+/************************************************************************/
+/* Module name : select_vector_kernels                                  */
+/* Functionality : Points hyperplane_values and add_scaled_column to    */
+/*                 the fastest kernels the CPU supports. Only the first */
+/*                 call, from any thread, does anything.                */
+/* Parameters : None.                                                   */
+/* Returns : Nothing.                                                   */
+/* Calls modules : choose_vector_kernels (through pthread_once)         */
+/* Is called by modules : build_tree (mktree.c)                         */
+/************************************************************************/
+select_vector_kernels()
+{
+  pthread_once(&vector_kernels_chosen, choose_vector_kernels);
+}
+
+/************************************************************************/
+/* Module name : choose_vector_kernels                                  */
+/* Functionality : Does the work of select_vector_kernels.              */
+/* Parameters : None.                                                   */
+/* Returns : Nothing.                                                   */
+/* Calls modules : None.                                                */
+/* Is called by modules : select_vector_kernels                         */
+/************************************************************************/
+void choose_vector_kernels()
+{
+  char *isa = getenv("OC1_VECTOR_ISA");
+  int level = AVX512;
+
+  if (isa != NULL)
+    {
+      if (!strcmp(isa, "scalar")) level = SCALAR;
+      else if (!strcmp(isa, "sse2")) level = SSE2;
+      else if (!strcmp(isa, "avx2")) level = AVX2;
+    }
+
+#ifdef X86_KERNELS
+  __builtin_cpu_init();
+  if (level >= AVX512 && __builtin_cpu_supports("avx512f"))
+    {
+      void hyperplane_values_avx512(), add_scaled_column_avx512();
+
+      hyperplane_values = hyperplane_values_avx512;
+      add_scaled_column = add_scaled_column_avx512;
+      vector_isa = "avx512";
+    }
+  else if (level >= AVX2 && __builtin_cpu_supports("avx2"))
+    {
+      void hyperplane_values_avx2(), add_scaled_column_avx2();
+
+      hyperplane_values = hyperplane_values_avx2;
+      add_scaled_column = add_scaled_column_avx2;
+      vector_isa = "avx2";
+    }
+  else if (level >= SSE2)
+    {
+      void hyperplane_values_sse2(), add_scaled_column_sse2();
+
+      hyperplane_values = hyperplane_values_sse2;
+      add_scaled_column = add_scaled_column_sse2;
+      vector_isa = "sse2";
+    }
+#endif
+}
+
+/************************************************************************/
+/* Module name : substitute_point                                       */
+/* Functionality : Substitutes one point into the equation of a         */
+/*                 hyperplane.                                          */
+/* Parameters : store : the point store.                                */
+/*              coefficients : the hyperplane (1..no_of_dimensions+1).  */
+/*              point : index of the point in the store.                */
+/* Returns : the value of the hyperplane at the point.                  */
+/* Calls modules : None.                                                */
+/* Is called by modules : all the hyperplane_values kernels             */
+/************************************************************************/
+static double substitute_point(store, coefficients, point)
+     POINT_STORE *store;
+     double *coefficients;
+     int point;
+{
+  int j, dimensions = store->no_of_dimensions;
+  double sum, *row = ROW(store, point);
+
+  sum = coefficients[dimensions + 1];
+  for (j = 1; j <= dimensions; j++)
+    sum += row[j] * coefficients[j];
+  return(sum);
+}
+
+/************************************************************************/
+/* Module name : hyperplane_values_scalar                               */
+/* Functionality : Sets the "val" fields of the given points, by        */
+/*                 substituting them into the equation of a hyperplane. */
+/* Parameters : store : the point store.                                */
+/*              coefficients : the hyperplane (1..no_of_dimensions+1).  */
+/*              points : indices of the points (1..no_of_points).       */
+/*              no_of_points : number of points.                        */
+/* Returns : Nothing.                                                   */
+/* Calls modules : substitute_point                                     */
+/* Is called by modules : find_values (compute_impurity.c), through     */
+/*                        hyperplane_values                             */
+/* Remarks : The vector versions below take the same parameters.        */
+/************************************************************************/
+void hyperplane_values_scalar(store, coefficients, points, no_of_points)
+     POINT_STORE *store;
+     double *coefficients;
+     int *points, no_of_points;
+{
+  int i;
+
+  for (i = 1; i <= no_of_points; i++)
+    store->val[points[i]] = substitute_point(store, coefficients, points[i]);
+}
+
+/************************************************************************/
+/* Module name : add_scaled_column_scalar                               */
+/* Functionality : Adds scale times the value of an attribute to the    */
+/*                 "val" field of each of the given points.             */
+/* Parameters : val : the "val" fields (of the store).                  */
+/*              column : the attribute, COLUMN(store, attribute).       */
+/*              scale : the change in the coefficient of the attribute. */
+/*              points : indices of the points (1..no_of_points).       */
+/*              no_of_points : number of points.                        */
+/* Returns : Nothing.                                                   */
+/* Calls modules : None.                                                */
+/* Is called by modules : alter_coefficients (mktree.c), through        */
+/*                        add_scaled_column                             */
+/* Remarks : The vector versions below take the same parameters.        */
+/************************************************************************/
+void add_scaled_column_scalar(val, column, scale, points, no_of_points)
+     double *val, *column, scale;
+     int *points, no_of_points;
+{
+  int i;
+
+  for (i = 1; i <= no_of_points; i++)
+    val[points[i]] += scale * column[points[i]];
+}
+
+#ifdef X86_KERNELS
+
+/* Two points at a time. SSE2 has no gathers, so the lanes are loaded  */
+/* one by one; the gain is from the two independent sums.             */
+__attribute__((target("sse2")))
+void hyperplane_values_sse2(store, coefficients, points, no_of_points)
+     POINT_STORE *store;
+     double *coefficients;
+     int *points, no_of_points;
+{
+  int i, j, dimensions = store->no_of_dimensions;
+  double *row0, *row1, lanes[2];
+  __m128d sum;
+
+  for (i = 1; i + 1 <= no_of_points; i += 2)
+    {
+      row0 = ROW(store, points[i]);
+      row1 = ROW(store, points[i + 1]);
+      sum = _mm_set1_pd(coefficients[dimensions + 1]);
+      for (j = 1; j <= dimensions; j++)
+	sum = _mm_add_pd(sum, _mm_mul_pd(_mm_set_pd(row1[j], row0[j]),
+					 _mm_set1_pd(coefficients[j])));
+      _mm_storeu_pd(lanes, sum);
+      store->val[points[i]] = lanes[0];
+      store->val[points[i + 1]] = lanes[1];
+    }
+  for (; i <= no_of_points; i++)
+    store->val[points[i]] = substitute_point(store, coefficients, points[i]);
+}
+
+__attribute__((target("sse2")))
+void add_scaled_column_sse2(val, column, scale, points, no_of_points)
+     double *val, *column, scale;
+     int *points, no_of_points;
+{
+  int i;
+  double lanes[2];
+  __m128d factor = _mm_set1_pd(scale);
+
+  for (i = 1; i + 1 <= no_of_points; i += 2)
+    {
+      _mm_storeu_pd(lanes,
+		    _mm_add_pd(_mm_set_pd(val[points[i + 1]], val[points[i]]),
+			       _mm_mul_pd(factor,
+					  _mm_set_pd(column[points[i + 1]],
+						     column[points[i]]))));
+      val[points[i]] = lanes[0];
+      val[points[i + 1]] = lanes[1];
+    }
+  for (; i <= no_of_points; i++)
+    val[points[i]] += scale * column[points[i]];
+}
+
+/* Four points at a time, with each attribute gathered from the four   */
+/* rows. AVX2 has no scatter, so the results are stored one by one.   */
+__attribute__((target("avx2")))
+void hyperplane_values_avx2(store, coefficients, points, no_of_points)
+     POINT_STORE *store;
+     double *coefficients;
+     int *points, no_of_points;
+{
+  int i, j, dimensions = store->no_of_dimensions;
+  double lanes[4];
+  __m256d sum;
+  __m256i rows;
+
+  for (i = 1; i + 3 <= no_of_points; i += 4)
+    {
+      /* Offsets of the rows from the start of the store. */
+      rows = _mm256_set_epi64x((long long)(points[i + 3] - 1) * dimensions,
+			       (long long)(points[i + 2] - 1) * dimensions,
+			       (long long)(points[i + 1] - 1) * dimensions,
+			       (long long)(points[i] - 1) * dimensions);
+      sum = _mm256_set1_pd(coefficients[dimensions + 1]);
+      for (j = 1; j <= dimensions; j++)
+	sum = _mm256_add_pd(sum,
+			    _mm256_mul_pd(_mm256_i64gather_pd(store->row_major + j,
+							      rows, 8),
+					  _mm256_set1_pd(coefficients[j])));
+      _mm256_storeu_pd(lanes, sum);
+      store->val[points[i]] = lanes[0];
+      store->val[points[i + 1]] = lanes[1];
+      store->val[points[i + 2]] = lanes[2];
+      store->val[points[i + 3]] = lanes[3];
+    }
+  for (; i <= no_of_points; i++)
+    store->val[points[i]] = substitute_point(store, coefficients, points[i]);
+}
+
+__attribute__((target("avx2")))
+void add_scaled_column_avx2(val, column, scale, points, no_of_points)
+     double *val, *column, scale;
+     int *points, no_of_points;
+{
+  int i;
+  double lanes[4];
+  __m128i index;
+  __m256d factor = _mm256_set1_pd(scale);
+
+  for (i = 1; i + 3 <= no_of_points; i += 4)
+    {
+      index = _mm_loadu_si128((__m128i *)(points + i));
+      _mm256_storeu_pd(lanes,
+		       _mm256_add_pd(_mm256_i32gather_pd(val, index, 8),
+				     _mm256_mul_pd(factor,
+						   _mm256_i32gather_pd(column, index, 8))));
+      val[points[i]] = lanes[0];
+      val[points[i + 1]] = lanes[1];
+      val[points[i + 2]] = lanes[2];
+      val[points[i + 3]] = lanes[3];
+    }
+  for (; i <= no_of_points; i++)
+    val[points[i]] += scale * column[points[i]];
+}
+
+/* Eight points at a time, with gathers and scatters. The points of a  */
+/* node are all different, so the lanes of a scatter never collide.   */
+__attribute__((target("avx512f")))
+void hyperplane_values_avx512(store, coefficients, points, no_of_points)
+     POINT_STORE *store;
+     double *coefficients;
+     int *points, no_of_points;
+{
+  int i, j, dimensions = store->no_of_dimensions;
+  __m512d sum;
+  __m512i rows;
+  __m256i index;
+
+  for (i = 1; i + 7 <= no_of_points; i += 8)
+    {
+      index = _mm256_loadu_si256((__m256i *)(points + i));
+      /* Offsets of the rows from the start of the store. */
+      rows = _mm512_mul_epu32(_mm512_sub_epi64(_mm512_cvtepi32_epi64(index),
+					       _mm512_set1_epi64(1)),
+			      _mm512_set1_epi64(dimensions));
+      sum = _mm512_set1_pd(coefficients[dimensions + 1]);
+      for (j = 1; j <= dimensions; j++)
+	sum = _mm512_add_pd(sum,
+			    _mm512_mul_pd(_mm512_i64gather_pd(rows,
+							      store->row_major + j, 8),
+					  _mm512_set1_pd(coefficients[j])));
+      _mm512_i32scatter_pd(store->val, index, sum, 8);
+    }
+  for (; i <= no_of_points; i++)
+    store->val[points[i]] = substitute_point(store, coefficients, points[i]);
+}
+
+__attribute__((target("avx512f")))
+void add_scaled_column_avx512(val, column, scale, points, no_of_points)
+     double *val, *column, scale;
+     int *points, no_of_points;
+{
+  int i;
+  __m256i index;
+  __m512d factor = _mm512_set1_pd(scale);
+
+  for (i = 1; i + 7 <= no_of_points; i += 8)
+    {
+      index = _mm256_loadu_si256((__m256i *)(points + i));
+      _mm512_i32scatter_pd(val, index,
+			   _mm512_add_pd(_mm512_i32gather_pd(index, val, 8),
+					 _mm512_mul_pd(factor,
+						       _mm512_i32gather_pd(index, column, 8))),
+			   8);
+    }
+  for (; i <= no_of_points; i++)
+    val[points[i]] += scale * column[points[i]];
+}
+
+#endif
+
+/************************************************************************/
+/************************************************************************/
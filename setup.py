@@ -12,7 +12,6 @@ packages = find_packages()
 extensions = [
      Extension("sklearn_oblique_tree.oblique._oblique",["sklearn_oblique_tree/oblique/_oblique.pyx",
                                                         "oc1_source/load_data.c",
-                                                        #"oc1_source/train_util.c",
                                                         "oc1_source/perturb.c",
                                                         "oc1_source/classify.c",
 
@@ -20,16 +19,22 @@ extensions = [
                                                         "oc1_source/impurity_measures.c",
                                                         "oc1_source/prune.c",
                                                         "oc1_source/util.c",
-                                                       # "oc1_source/classify_util.c",
-                                                        "oc1_source/tree_util.c"
+                                                        "oc1_source/tree_util.c",
+                                                        "oc1_source/thread_pool.c",
+                                                        "oc1_source/vector_kernels.c",
+                                                        "oc1_source/sort.c",
+                                                        "oc1_source/flat_tree.c",
+                                                        "oc1_source/model_file.c",
+                                                        "oc1_source/arena.c"
                                                         ],
                include_dirs=[numpy.get_include(), '.'],
-               extra_compile_args=["-w"]
+               extra_compile_args=["-w", "-pthread"],
+               extra_link_args=["-pthread"]
 
      )
     ]
 
-#util.c tree_util.c load_data.c perturb.c compute_impurity.c impurity_measures.c classify.c prune.c
+#util.c tree_util.c load_data.c perturb.c compute_impurity.c impurity_measures.c classify.c prune.c thread_pool.c vector_kernels.c sort.c flat_tree.c model_file.c
 
 def readme():
     with open('README.md') as f:
@@ -1,11 +1,8 @@
 import numpy
 cimport numpy
 
-cdef extern from "stdio.h":
-    double drand48()
-    void srand48(long int seedval)
-
-cdef extern from "../../oc1_source/mktree.c":
+#nothing in here touches python objects, so all of it can be called without the GIL
+cdef extern from "../../oc1_source/mktree.c" nogil:
 
     struct tree_node:
           # double *coefficients
@@ -16,7 +13,8 @@ cdef extern from "../../oc1_source/mktree.c":
           # tree_node *right
           # int left_cat
           # int right_cat
-          # #char label[MAX_DT_DEPTH]
+          # int id
+          # int depth
           # double alpha #used only in error_complexity pruning.
           # int no_of_points
         pass
@@ -24,35 +22,77 @@ cdef extern from "../../oc1_source/mktree.c":
     struct test_outcome:
         pass
 
-    cdef int no_of_dimensions
-    cdef int no_of_categories
-    cdef int no_of_restarts
-    cdef int no_of_train_points
-    cdef int max_no_of_random_perturbations
-
-    cdef int oblique
-    cdef int axis_parallel
-    cdef int cart_mode
-
-
-    cdef tree_node* sklearn_root_node
-
-    cdef float IMPURITY "IMPURITY"
+    ctypedef struct ARENA:
+        pass
 
     ctypedef struct POINT:
         double *dimension
         int category
         double val
 
-    void allocate_structures(int no_of_points)
-    void deallocate_structures(int no_of_points)
-    void classify(POINT** points, int no_of_points, tree_node* root,char* output)
+    #all the state for growing one tree, see oc1.h
+    ctypedef struct TRAINING_CONTEXT:
+        int no_of_dimensions
+        int no_of_categories
+        int no_of_restarts
+        int max_no_of_random_perturbations
+        int oblique
+        int axis_parallel
+        int cart_mode
+        int presort
+        int max_bins
+        int criterion
+        int max_leaf_nodes
+        int max_depth
+        int min_samples_split
+        int min_samples_leaf
+        double min_impurity_decrease
+        int max_climb_points
+        int max_features
+        unsigned short random_state[3]
+        int no_of_threads
+        ARENA* arena #the nodes of the tree are allocated from it, see arena.c
+        tree_node* root
+        int* root_count #the samples of each class, for a tree that is a single leaf
+
+    void initialize_context(TRAINING_CONTEXT* context)
+    void allocate_structures(TRAINING_CONTEXT* context, int no_of_points)
+    void deallocate_structures(TRAINING_CONTEXT* context, int no_of_points)
+    int find_criterion(char* name)
+    void seed_random_state(unsigned short* state, long int seed)
+    void classify(POINT** points, int no_of_points, int dimensions, tree_node* root, int* root_count, char* output)
+    void free_arena(ARENA* arena)
+
+    #the tree packed into arrays for classification, see flat_tree.c
+    ctypedef struct FLAT_TREE:
+        int no_of_nodes
+        int no_of_dimensions
+        int no_of_categories
+        int no_of_leaves
+
+    FLAT_TREE* flatten_tree(tree_node* root, int dimensions, int categories, int* root_count)
+    void free_flat_tree(FLAT_TREE* tree)
+    int flat_tree_category(FLAT_TREE* tree, double* attributes)
+    void classify_rows(FLAT_TREE* tree, double* rows, int no_of_rows, int* categories)
+    void rows_probabilities(FLAT_TREE* tree, double* rows, int no_of_rows, double* probabilities)
+
+    #binary model files, see model_file.c
+    int write_model(FLAT_TREE* tree, char* model_file)
+    FLAT_TREE* map_model(char* model_file)
+    size_t model_size(FLAT_TREE* tree)
+    int store_model(FLAT_TREE* tree, char* image)
+    FLAT_TREE* read_model(char* image, size_t size)
 
-    tree_node* build_tree(POINT** points, int no_of_points, char * dt_file)
+    tree_node* build_tree(TRAINING_CONTEXT* context, POINT** points, int no_of_points, char * dt_file)
 
 
 
 cdef class Tree:
-    cpdef str splitter
-    cpdef fit(self, numpy.ndarray[numpy.float_t, ndim=2, mode="c"] X, numpy.ndarray[numpy.int_t, mode="c"] y, long int random_state, str splitter,  int number_of_restarts, int max_perturbations)
-    cpdef predict(self, numpy.ndarray y)
+    cdef public str splitter
+    cdef TRAINING_CONTEXT context
+    cdef FLAT_TREE* flat
+    cpdef fit(self, numpy.ndarray[numpy.float_t, ndim=2, mode="c"] X, numpy.ndarray[numpy.int_t, mode="c"] y, long int random_state, str splitter,  int number_of_restarts, int max_perturbations, int n_jobs, bint presort, int max_bins, str criterion, int max_leaf_nodes, int max_depth, int min_samples_split, int min_samples_leaf, double min_impurity_decrease, int max_climb_samples, int max_features)
+    cpdef predict(self, numpy.ndarray[numpy.float_t, ndim=2, mode="c"] X)
+    cpdef predict_proba(self, numpy.ndarray[numpy.float_t, ndim=2, mode="c"] X)
+    cpdef save_model(self, path)
+    cpdef load_model(self, path)
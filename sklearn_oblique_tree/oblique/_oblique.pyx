@@ -1,19 +1,37 @@
-from _oblique cimport build_tree, srand48 #Struct for an oblique tree node with references to children
 from libc.stdio cimport printf
+import os
 import numpy as np
 cimport numpy as np
+cimport cython
 from libc.stdlib cimport malloc, free
+from cpython.bytes cimport PyBytes_FromStringAndSize, PyBytes_AS_STRING
 
 
 cdef class Tree:
 
     def __cinit__(self, str splitter):
         self.splitter = splitter
+        initialize_context(&self.context)
+        self.flat = NULL
     def __dealloc__(self):
-        global no_of_train_points
-        deallocate_structures(no_of_train_points)
+        free_flat_tree(self.flat)
+        free_arena(self.context.arena)
 
-    cpdef fit(self, np.ndarray[np.float_t, ndim=2, mode="c"] X, numpy.ndarray[np.int_t, mode="c"] y, long int random_state, str splitter, int number_of_restarts, int max_perturbations):
+    @property
+    def n_features(self):
+        return self.context.no_of_dimensions
+
+    @property
+    def n_classes(self):
+        return self.context.no_of_categories
+
+    @property
+    def n_leaves(self):
+        if self.flat == NULL:
+            raise ValueError("The tree has not been fit.")
+        return self.flat.no_of_leaves
+
+    cpdef fit(self, np.ndarray[np.float_t, ndim=2, mode="c"] X, numpy.ndarray[np.int_t, mode="c"] y, long int random_state, str splitter, int number_of_restarts, int max_perturbations, int n_jobs, bint presort, int max_bins, str criterion, int max_leaf_nodes, int max_depth, int min_samples_split, int min_samples_leaf, double min_impurity_decrease, int max_climb_samples, int max_features):
         """
         Grows an Oblique Decision Tree by calling sub-routines from Murphys implementation of OC1 and Cart-Linear
         :param X:
@@ -22,85 +40,166 @@ cdef class Tree:
         """
         cdef int num_points = len(y)
         cdef int i
-        #modify global settings in implementation
-        global no_of_dimensions
-        global no_of_categories #number of classes
-        global no_of_train_points #number of points trained with
-        global sklearn_root_node #point to root node of tree to build
-        global no_of_restarts
-        global max_no_of_random_perturbations
-        global oblique
-        global axis_parallel
-        global cart_mode
-        oblique = False
-        axis_parallel = False
-        cart_mode = False
+        cdef int criterion_number = find_criterion(criterion.encode())
+        if criterion_number < 0:
+            raise ValueError("Unknown criterion %r." % criterion)
+        #each tree keeps its settings and work areas in its own context, so several trees can coexist
+        cdef TRAINING_CONTEXT *context = &self.context
+
+        free_flat_tree(self.flat) #refitting replaces the previous tree
+        self.flat = NULL
+        free_arena(context.arena)
+        initialize_context(context)
+
+        context.oblique = False
+        context.axis_parallel = False
+        context.cart_mode = False
 
         if "oc1" in splitter:
-            oblique = True
+            context.oblique = True
         if "cart" in splitter: #if this is set, the implementation overrides the other splitters.
-            cart_mode = True
+            context.cart_mode = True
         if "axis_parallel" in splitter:
-            axis_parallel = True
+            context.axis_parallel = True
 
 
-        srand48(random_state) #set random state
+        seed_random_state(context.random_state, random_state) #set random state
 
-        max_no_of_random_perturbations = max_perturbations
-        no_of_train_points = num_points
-        no_of_restarts = number_of_restarts
+        context.max_no_of_random_perturbations = max_perturbations
+        context.no_of_restarts = number_of_restarts
+        context.no_of_threads = n_jobs #restarts at a node and sibling subtrees are run on this many threads
+        context.presort = presort #sort the attributes once at the root instead of at every axis parallel split
+        context.max_bins = max_bins #0 searches over all the values, otherwise splits of large nodes are searched over this many bins
+        context.criterion = criterion_number #the impurity measure, its routines are picked once in build_tree
+        context.max_leaf_nodes = max_leaf_nodes #0 grows the tree depth first, otherwise best first up to this many leaves
+        context.max_depth = max_depth #0 for no maximum
+        context.min_samples_split = min_samples_split #nodes failing these are not searched for splits at all
+        context.min_samples_leaf = min_samples_leaf
+        context.min_impurity_decrease = min_impurity_decrease
+        context.max_climb_points = max_climb_samples #0 hill climbs on all the points of a node, otherwise on a sample of larger nodes
+        context.max_features = max_features #0 searches the split of a node on all the attributes, otherwise on this many drawn for it
 
-        #no_of_restarts = self.no_of_restarts
-        no_of_categories = len(np.unique(y))
-        no_of_dimensions = len(X[0])
+        context.no_of_categories = len(np.unique(y)) #number of classes
+        context.no_of_dimensions = len(X[0])
 
         cdef POINT ** points = <POINT**> malloc(num_points * sizeof(POINT*))
-        allocate_structures(num_points)
+        cdef POINT * point_block = <POINT*> malloc(num_points * sizeof(POINT))
 
         #implementation is indexed from 1 like why the hell.
         points -= 1
 
         for i in range(1,num_points+1):
-            points[i] = <POINT * > malloc( sizeof(POINT *))
-
-        for i in range(1,num_points+1):
+            points[i] = &point_block[i-1]
             points[i].dimension = (&X[i-1,0] - 1)
             points[i].category = y[i-1] + 1
             points[i].val = 0
 
+        with nogil: #the tree is grown from the C copies only, so other python threads can run meanwhile
+            allocate_structures(context, num_points)
+            build_tree(context, points, num_points, NULL)
+            deallocate_structures(context, num_points)
+            #predict walks this copy of the tree, a single leaf if the root was not split
+            self.flat = flatten_tree(context.root, context.no_of_dimensions, context.no_of_categories, context.root_count)
+            free_arena(context.arena) #so the nodes of the grown tree are not kept beside it
+            context.arena = NULL
+            context.root = NULL
+            context.root_count = NULL
 
-
-        sklearn_root_node = build_tree(points, num_points, NULL)
-
+        free(point_block)
+        free(points + 1)
 
 
 
+    @cython.boundscheck(False)
+    @cython.wraparound(False)
     cpdef predict(self, np.ndarray[np.float_t, ndim=2, mode="c"] X):
         cdef int num_predict_points = len(X)
-        cdef int i
-        cdef POINT ** points_predict = <POINT**> malloc(num_predict_points * sizeof(POINT*))
         cdef np.ndarray[np.int32_t, ndim=1] predictions = np.empty(num_predict_points, dtype=np.int32)
-        global sklearn_root_node
-        points_predict -= 1 #implementation is indexed from 1.
 
-        for i in range(1,num_predict_points+1):
-            points_predict[i] = <POINT * > malloc( sizeof(POINT *))
+        if self.flat == NULL:
+            raise ValueError("The tree has not been fit.")
+        if X.shape[1] != self.flat.no_of_dimensions:
+            raise ValueError("X has %d features, but the tree was grown on %d." % (X.shape[1], self.flat.no_of_dimensions))
 
-        for i in range(1,num_predict_points+1):
-            points_predict[i].dimension = (&X[i-1,0] - 1)
-            points_predict[i].category = -1
-            points_predict[i].val = 0
+        if num_predict_points == 0:
+            return predictions
 
+        with nogil: #categories are written from index 1
+            classify_rows(self.flat, &X[0,0], num_predict_points, <int*> &predictions[0] - 1)
 
-        classify(points_predict, num_predict_points, sklearn_root_node, NULL)
-
-        for i in range(1,num_predict_points+1):
-            predictions[i-1] = points_predict[i].category - 1 #decrement to account for increment in train
+        predictions -= 1 #decrement to account for increment in train
 
         return predictions
 
+    cpdef predict_proba(self, np.ndarray[np.float_t, ndim=2, mode="c"] X):
+        if self.flat == NULL:
+            raise ValueError("The tree has not been fit.")
+        if X.shape[1] != self.flat.no_of_dimensions:
+            raise ValueError("X has %d features, but the tree was grown on %d." % (X.shape[1], self.flat.no_of_dimensions))
+
+        cdef int num_predict_points = len(X)
+        #column c is the fraction of the training samples of class c in the leaf reached
+        cdef np.ndarray[np.float_t, ndim=2, mode="c"] probabilities = np.empty((num_predict_points, self.flat.no_of_categories))
 
+        if num_predict_points == 0:
+            return probabilities
 
+        with nogil:
+            rows_probabilities(self.flat, &X[0,0], num_predict_points, &probabilities[0,0])
 
+        return probabilities
 
+    cpdef save_model(self, path):
+        """
+        Writes the tree to a binary model file, that load_model maps back into memory
+        """
+        if self.flat == NULL:
+            raise ValueError("The tree has not been fit.")
+        cdef bytes file_name = os.fsencode(path)
+        if not write_model(self.flat, file_name):
+            raise OSError("Cannot write the model to %s." % path)
 
+    cpdef load_model(self, path):
+        """
+        Replaces the tree by the one in a model file written by save_model. The file is mapped, not read, so processes
+        loading the same model share it.
+        """
+        cdef bytes file_name = os.fsencode(path)
+        cdef FLAT_TREE *flat = map_model(file_name)
+        if flat == NULL:
+            raise ValueError("%s is not a readable model file." % path)
+
+        free_flat_tree(self.flat)
+        free_arena(self.context.arena)
+        initialize_context(&self.context)
+        self.flat = flat
+        self.context.no_of_dimensions = flat.no_of_dimensions
+        self.context.no_of_categories = flat.no_of_categories
+
+    def __reduce__(self):
+        """
+        Pickles the tree as the image of its model file (see model_file.c), so that trees can be pickled and sent to
+        joblib workers. Only what predict needs is kept, as with load_model.
+        """
+        cdef bytes image
+        if self.flat == NULL:
+            return (Tree, (self.splitter,), None)
+        image = PyBytes_FromStringAndSize(NULL, model_size(self.flat)) #a new string, written before anyone else sees it
+        if not store_model(self.flat, PyBytes_AS_STRING(image)):
+            raise ValueError("The tree cannot be pickled on a big endian machine.")
+        return (Tree, (self.splitter,), image)
+
+    def __setstate__(self, bytes image):
+        cdef FLAT_TREE *flat
+        if image is None:
+            return
+        flat = read_model(image, len(image)) #a copy, as the bytes object goes away
+        if flat == NULL:
+            raise ValueError("The pickled tree is damaged.")
+
+        free_flat_tree(self.flat)
+        free_arena(self.context.arena)
+        initialize_context(&self.context)
+        self.flat = flat
+        self.context.no_of_dimensions = flat.no_of_dimensions
+        self.context.no_of_categories = flat.no_of_categories
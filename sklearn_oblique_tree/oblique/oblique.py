@@ -1,12 +1,17 @@
+import numbers
+import numpy as np
 from sklearn.base import BaseEstimator, ClassifierMixin
 from sklearn.utils.validation import check_X_y, check_array, check_is_fitted, check_random_state
 from sklearn.utils.multiclass import unique_labels
+from joblib import effective_n_jobs
 from ._oblique import Tree
 
 class ObliqueTree(BaseEstimator, ClassifierMixin):
 
 
-    def __init__(self, splitter="oc1, axis_parallel", number_of_restarts=20, max_perturbations=5, random_state=1):
+    def __init__(self, splitter="oc1, axis_parallel", number_of_restarts=20, max_perturbations=5, random_state=1, n_jobs=1, presort=False, max_bins=None, criterion="gini", max_leaf_nodes=None,
+                 max_depth=None, min_samples_split=2, min_samples_leaf=1, min_impurity_decrease=0., max_climb_samples=None,
+                 max_features=None):
         """
 
         :param splitter: 'oc1' for stochastic hill climbing, 'cart' for CART multivariate, 'axis_parallel' for traditional.
@@ -14,11 +19,52 @@ class ObliqueTree(BaseEstimator, ClassifierMixin):
         :param number_of_restarts: number of times to restart in effort to escape local minimums
         :param max_perturbations: number of random vector perturbations
         :param random_state: an integer serving as the seed (NOT a numpy random state object)
+        :param n_jobs: number of threads the tree is grown on (restarts at a node and sibling subtrees run in parallel), -1 for all processors.
+        The tree grown does not depend on it.
+        :param presort: sort each attribute once at the root, and keep the order through the splits, instead of sorting
+        at every node when searching axis parallel splits. Faster on large or wide data, at the cost of an int per
+        attribute per sample. The tree grown does not depend on it.
+        :param max_bins: if set (>= 2), the split along a coefficient at a node with more than 4 * max_bins samples is
+        searched over at most max_bins bins of the values (quantiles of a sample of them) instead of over every value.
+        Much faster on large data, at a small cost in split quality. None searches over every value. Axis parallel splits
+        with presort are always searched over every value.
+        :param criterion: the impurity measure splits are chosen by: 'gini', 'entropy' (information gain), 'twoing',
+        'hellinger', 'maxminority', 'summinority' or 'variance' (see oc1_source/impurity_measures.c).
+        :param max_leaf_nodes: if set (>= 2), the tree is grown best first: the leaf whose split decreases the impurity
+        most (weighted by its number of samples) is split next, until the tree has max_leaf_nodes leaves. Bounds the
+        size of the tree and the time to grow it. None grows the tree depth first, until no leaf can be split. Below
+        the bound, both grow the same tree.
+        :param max_depth: if set (>= 1), nodes at this depth (the root being at depth 0) are not split.
+        :param min_samples_split: nodes with fewer samples are not split. Nodes of 3 samples or fewer never are.
+        :param min_samples_leaf: splits leaving fewer samples on a side are not considered.
+        :param min_impurity_decrease: a split must decrease the impurity, weighted by the fraction of the training samples
+        in the node (as in scikit-learn), by at least this much. For 'entropy' and 'twoing' the decrease is the gain.
+        Nodes that cannot be split by max_depth, min_samples_split or min_samples_leaf are not searched at all, which is
+        where a fully grown tree spends most of its time.
+        :param max_climb_samples: if set (>= 1), the hill climbing of oblique splits ('oc1') at nodes with more samples
+        is run on a random sample of about this many of them, stratified by class. The hyperplane found is then moved
+        to its best position for all the samples of the node, and compared with the axis parallel split on all of them.
+        Much faster on large data, as the hill climbing is where oc1 spends its time. None climbs on all the samples.
+        :param max_features: the number of features, drawn at random for each node, its split is searched on: the axis
+        parallel splits are searched along them only, and the other coefficients of oblique splits are held at 0. An int,
+        a float (the fraction of the features), 'sqrt', 'log2', or None for all the features. Cuts the time spent at each
+        node in proportion, and makes the trees random enough for forests.
         """
         self.random_state = random_state
         self.splitter = splitter
         self.number_of_restarts = number_of_restarts
         self.max_perturbations = max_perturbations
+        self.n_jobs = n_jobs
+        self.presort = presort
+        self.max_bins = max_bins
+        self.criterion = criterion
+        self.max_leaf_nodes = max_leaf_nodes
+        self.max_depth = max_depth
+        self.min_samples_split = min_samples_split
+        self.min_samples_leaf = min_samples_leaf
+        self.min_impurity_decrease = min_impurity_decrease
+        self.max_climb_samples = max_climb_samples
+        self.max_features = max_features
 
 
 
@@ -26,17 +72,94 @@ class ObliqueTree(BaseEstimator, ClassifierMixin):
         """
         Grows an Oblique Decision Tree
         :param X: a 2d numpy array of attributes
-        :param y: a numpy array of integer labels
+        :param y: a numpy array of labels
         :return:
         """
         X, y = check_X_y(X, y)
+        if self.max_bins is not None and self.max_bins < 2:
+            raise ValueError("max_bins must be at least 2, or None.")
+        if self.max_leaf_nodes is not None and self.max_leaf_nodes < 2:
+            raise ValueError("max_leaf_nodes must be at least 2, or None.")
+        if self.max_depth is not None and self.max_depth < 1:
+            raise ValueError("max_depth must be at least 1, or None.")
+        if self.min_samples_split < 2:
+            raise ValueError("min_samples_split must be at least 2.")
+        if self.min_samples_leaf < 1:
+            raise ValueError("min_samples_leaf must be at least 1.")
+        if self.min_impurity_decrease < 0:
+            raise ValueError("min_impurity_decrease must not be negative.")
+        if self.max_climb_samples is not None and self.max_climb_samples < 1:
+            raise ValueError("max_climb_samples must be at least 1, or None.")
+        max_features = self._max_features(X.shape[1])
         random_state = self.random_state
-        self.classes_ = unique_labels(y)
+        self.classes_, y = np.unique(y, return_inverse=True) #the tree is grown on the classes numbered 0..k-1
         self.tree = Tree(splitter = self.splitter)
-        self.tree.fit(X,y, random_state, self.splitter, self.number_of_restarts, self.max_perturbations)
+        self.tree.fit(X,y, random_state, self.splitter, self.number_of_restarts, self.max_perturbations, effective_n_jobs(self.n_jobs), self.presort, self.max_bins or 0, self.criterion, self.max_leaf_nodes or 0,
+                      self.max_depth or 0, self.min_samples_split, self.min_samples_leaf, self.min_impurity_decrease,
+                      self.max_climb_samples or 0, max_features)
+        return self
 
 
 
+    def _max_features(self, n_features):
+        """
+        The number of features to search the split of each node on, 0 for all of them
+        """
+        max_features = self.max_features
+        if max_features is None:
+            return 0
+        if max_features == "sqrt":
+            return max(1, int(np.sqrt(n_features)))
+        if max_features == "log2":
+            return max(1, int(np.log2(n_features)))
+        if isinstance(max_features, numbers.Integral) and not isinstance(max_features, bool):
+            if not 1 <= max_features <= n_features:
+                raise ValueError("max_features must be in [1, n_features], got %d." % max_features)
+            return max_features
+        if isinstance(max_features, numbers.Real) and 0 < max_features <= 1:
+            return max(1, int(max_features * n_features))
+        raise ValueError("max_features must be an int, a float in (0, 1], 'sqrt', 'log2' or None, got %r." % (max_features,))
+
     def predict(self, X):
-        return self.tree.predict(X)
+        return self.classes_[self.tree.predict(X)]
+
+    def predict_proba(self, X):
+        """
+        Class probabilities: the fractions of the training samples of each class in the leaf each sample reaches
+        :param X: a 2d numpy array of attributes
+        :return: a 2d numpy array with a column per class, in the order of classes_
+        """
+        return self.tree.predict_proba(X)
 
+    def predict_log_proba(self, X):
+        with np.errstate(divide="ignore"): #classes absent from a leaf get -inf
+            return np.log(self.predict_proba(X))
+
+    def save_model(self, path):
+        """
+        Writes the fitted tree to a compact binary model file (see oc1_source/model_file.c)
+        :param path: name of the file
+        """
+        self.tree.save_model(path)
+
+    @classmethod
+    def load_model(cls, path, classes=None, **params):
+        """
+        Loads a tree written by save_model, for prediction. The file is memory mapped, so processes loading the same
+        model share one copy of it.
+        :param path: name of the file
+        :param classes: the classes_ of the ObliqueTree that was saved. The file keeps the class numbers only, so
+        without them the classes are 0..k-1.
+        :param params: parameters of the returned ObliqueTree, used if it is refit
+        :return: an ObliqueTree with the tree of the file
+        """
+        model = cls(**params)
+        model.tree = Tree(splitter=model.splitter)
+        model.tree.load_model(path)
+        if classes is None:
+            model.classes_ = np.arange(model.tree.n_classes)
+        else:
+            model.classes_ = np.asarray(classes)
+            if model.classes_.shape != (model.tree.n_classes,):
+                raise ValueError("The model has %d classes, %d given." % (model.tree.n_classes, model.classes_.size))
+        return model
@@ -1,8 +1,14 @@
 from unittest import TestCase
-from sklearn.datasets import load_iris, load_breast_cancer
+from threading import Thread
+from tempfile import TemporaryDirectory
+import os
+import pickle
+import struct
+from sklearn.datasets import load_iris, load_breast_cancer, make_classification
 from sklearn.model_selection import train_test_split
 from sklearn_oblique_tree.oblique import ObliqueTree
 from sklearn.metrics import accuracy_score
+import numpy as np
 
 class TestObliqueTree(TestCase):
     """
@@ -34,3 +40,266 @@ class TestObliqueTree(TestCase):
 
         print("Breast Cancer Accuracy:", accuracy_score(y_test, predictions))
 
+    def test_independent_trees(self):
+        X_iris, y_iris = load_iris(return_X_y=True)
+        X_breast, y_breast = load_breast_cancer(return_X_y=True)
+
+        first = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state)
+        first.fit(X_iris, y_iris)
+        predictions = first.predict(X_iris)
+
+        second = self.classifier(splitter="oc1", random_state=self.random_state)
+        second.fit(X_breast, y_breast)
+        del second
+
+        self.assertTrue((first.predict(X_iris) == predictions).all())
+
+    def test_threaded_fit(self):
+        X, y = load_breast_cancer(return_X_y=True)
+        sequential = self.classifier(splitter="oc1", random_state=self.random_state).fit(X, y).predict(X)
+
+        classifiers = [self.classifier(splitter="oc1", random_state=self.random_state) for _ in range(4)]
+        threads = [Thread(target=classifier.fit, args=(X, y)) for classifier in classifiers]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+
+        for classifier in classifiers:
+            self.assertTrue((classifier.predict(X) == sequential).all())
+
+    def test_n_jobs(self):
+        X, y = load_breast_cancer(return_X_y=True)
+        sequential = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state).fit(X, y).predict(X)
+
+        for n_jobs in [2, 4]:
+            parallel = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state, n_jobs=n_jobs)
+            self.assertTrue((parallel.fit(X, y).predict(X) == sequential).all())
+
+    def test_presort(self):
+        X, y = load_breast_cancer(return_X_y=True)
+
+        for splitter in ["axis_parallel", "cart", "oc1, axis_parallel"]:
+            unsorted = self.classifier(splitter=splitter, random_state=self.random_state).fit(X, y).predict(X)
+            presorted = self.classifier(splitter=splitter, random_state=self.random_state, presort=True)
+            self.assertTrue((presorted.fit(X, y).predict(X) == unsorted).all())
+
+    def test_max_bins(self):
+        X_train, X_test, y_train, y_test = train_test_split(*load_breast_cancer(return_X_y=True), test_size=.4, random_state=self.random_state)
+
+        for splitter in ["axis_parallel", "cart", "oc1, axis_parallel"]:
+            exact = self.classifier(splitter=splitter, random_state=self.random_state).fit(X_train, y_train)
+            binned = self.classifier(splitter=splitter, random_state=self.random_state, max_bins=16).fit(X_train, y_train)
+            self.assertGreater(accuracy_score(y_test, binned.predict(X_test)), accuracy_score(y_test, exact.predict(X_test)) - 0.05)
+
+        with self.assertRaises(ValueError):
+            self.classifier(max_bins=1).fit(X_train, y_train)
+
+    def test_max_climb_samples(self):
+        X_train, X_test, y_train, y_test = train_test_split(*load_breast_cancer(return_X_y=True), test_size=.4, random_state=self.random_state)
+
+        for splitter in ["oc1", "oc1, axis_parallel"]:
+            exact = self.classifier(splitter=splitter, random_state=self.random_state).fit(X_train, y_train)
+            sampled = self.classifier(splitter=splitter, random_state=self.random_state, max_climb_samples=100).fit(X_train, y_train)
+            self.assertGreater(accuracy_score(y_test, sampled.predict(X_test)), accuracy_score(y_test, exact.predict(X_test)) - 0.05)
+
+        with self.assertRaises(ValueError):
+            self.classifier(max_climb_samples=0).fit(X_train, y_train)
+
+    def test_max_features(self):
+        X_train, X_test, y_train, y_test = train_test_split(*load_breast_cancer(return_X_y=True), test_size=.4, random_state=self.random_state)
+        everything = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state, max_features=X_train.shape[1]).fit(X_train, y_train)
+        default = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state).fit(X_train, y_train)
+        self.assertTrue((everything.predict(X_test) == default.predict(X_test)).all())
+
+        for splitter in ["axis_parallel", "cart", "oc1, axis_parallel"]:
+            for max_features in [5, .3, "sqrt", "log2"]:
+                classifier = self.classifier(splitter=splitter, random_state=self.random_state, max_features=max_features).fit(X_train, y_train)
+                self.assertGreater(accuracy_score(y_test, classifier.predict(X_test)), .85, (splitter, max_features))
+
+        for max_features in [0, X_train.shape[1] + 1, 0., 1.5, "all"]:
+            with self.assertRaises(ValueError):
+                self.classifier(max_features=max_features).fit(X_train, y_train)
+
+    def test_cart_degenerate_splits(self):
+        #the CART hill climbing used to grow its coefficients until they overflowed, leaving every sample on one side
+        #of the split, and the node was split again and again on the same samples
+        X, y = make_classification(n_samples=200, n_features=12, n_informative=6, n_classes=5, random_state=4)
+        classifier = self.classifier(splitter="cart", random_state=self.random_state).fit(X, y)
+        self.assertLess(classifier.tree.n_leaves, len(y))
+        self.assertGreater(accuracy_score(y, classifier.predict(X)), .9)
+
+    def test_refit(self):
+        X_iris, y_iris = load_iris(return_X_y=True)
+        X_breast, y_breast = load_breast_cancer(return_X_y=True)
+        fresh = self.classifier(splitter="oc1", random_state=self.random_state).fit(X_breast, y_breast).predict(X_breast)
+
+        classifier = self.classifier(splitter="oc1", random_state=self.random_state).fit(X_iris, y_iris)
+        self.assertTrue((classifier.fit(X_breast, y_breast).predict(X_breast) == fresh).all())
+
+    def test_batch_predict(self):
+        X, y = load_breast_cancer(return_X_y=True)
+        classifier = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state).fit(X, y)
+
+        #enough rows for several blocks, the last one partial
+        X_test = np.vstack([X * scale for scale in np.linspace(0.5, 1.5, 9)])
+        one_by_one = np.array([classifier.predict(X_test[i:i+1])[0] for i in range(len(X_test))])
+        self.assertTrue((classifier.predict(X_test) == one_by_one).all())
+
+    def test_unused_attributes(self):
+        X, y = load_breast_cancer(return_X_y=True)
+        X = np.hstack([X, np.zeros((len(X), 100))]) #constant attributes are never split on
+        classifier = self.classifier(splitter="axis_parallel", random_state=self.random_state).fit(X, y)
+
+        X_test = X.copy()
+        X_test[:, -100:] = np.nan #so the predictions change if they are read
+        self.assertTrue((classifier.predict(X_test) == classifier.predict(X)).all())
+
+    def test_predict_proba(self):
+        X_train, X_test, y_train, y_test = train_test_split(*load_iris(return_X_y=True), test_size=.4, random_state=self.random_state)
+
+        for splitter in ["axis_parallel", "oc1, axis_parallel"]:
+            classifier = self.classifier(splitter=splitter, random_state=self.random_state).fit(X_train, y_train)
+            probabilities = classifier.predict_proba(X_test)
+
+            self.assertEqual(probabilities.shape, (len(X_test), len(classifier.classes_)))
+            self.assertTrue(np.allclose(probabilities.sum(axis=1), 1))
+            self.assertTrue((probabilities.max(axis=1) == probabilities[np.arange(len(X_test)), classifier.predict(X_test)]).all())
+            self.assertTrue(np.allclose(np.exp(classifier.predict_log_proba(X_test)), probabilities))
+
+    def test_class_labels(self):
+        X_train, X_test, y_train, y_test = train_test_split(*load_iris(return_X_y=True), test_size=.4, random_state=self.random_state)
+        classifier = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state).fit(X_train, y_train)
+
+        labels = np.array([3, 7, 12]) #the tree is grown on the classes, whatever their labels
+        relabeled = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state).fit(X_train, labels[y_train])
+        self.assertTrue((relabeled.classes_ == labels).all())
+        self.assertTrue((relabeled.predict(X_test) == labels[classifier.predict(X_test)]).all())
+        self.assertTrue((relabeled.predict_proba(X_test) == classifier.predict_proba(X_test)).all())
+
+        names = np.array(["setosa", "versicolor", "virginica"])
+        named = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state).fit(X_train, names[y_train])
+        self.assertTrue((named.predict(X_test) == names[classifier.predict(X_test)]).all())
+
+        with TemporaryDirectory() as directory:
+            path = os.path.join(directory, "tree.model")
+            relabeled.save_model(path)
+            loaded = self.classifier.load_model(path, classes=relabeled.classes_)
+            self.assertTrue((loaded.predict(X_test) == relabeled.predict(X_test)).all())
+
+    def test_model_file(self):
+        X_train, X_test, y_train, y_test = train_test_split(*load_breast_cancer(return_X_y=True), test_size=.4, random_state=self.random_state)
+        classifier = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state).fit(X_train, y_train)
+
+        with TemporaryDirectory() as directory:
+            path = os.path.join(directory, "tree.model")
+            classifier.save_model(path)
+            loaded = self.classifier.load_model(path)
+            self.assertTrue((loaded.predict(X_test) == classifier.predict(X_test)).all())
+            self.assertTrue((loaded.predict_proba(X_test) == classifier.predict_proba(X_test)).all())
+
+            with open(path, "r+b") as model_file: #a damaged file is refused
+                model_file.truncate(os.path.getsize(path) - 1)
+            with self.assertRaises(ValueError):
+                self.classifier.load_model(path)
+
+            classifier.save_model(path) #so are node counts whose leaf count overflows an int
+            with open(path, "r+b") as model_file:
+                model_file.seek(16)
+                model_file.write(struct.pack("<i", 2**31 - 1))
+                model_file.seek(28)
+                model_file.write(struct.pack("<i", -2**31))
+            with self.assertRaises(ValueError):
+                self.classifier.load_model(path)
+
+    def test_pickle(self):
+        X_train, X_test, y_train, y_test = train_test_split(*load_breast_cancer(return_X_y=True), test_size=.4, random_state=self.random_state)
+        classifier = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state).fit(X_train, y_train)
+
+        loaded = pickle.loads(pickle.dumps(classifier))
+        self.assertTrue((loaded.predict(X_test) == classifier.predict(X_test)).all())
+        self.assertTrue((loaded.predict_proba(X_test) == classifier.predict_proba(X_test)).all())
+        self.assertEqual(loaded.get_params(), classifier.get_params())
+
+        unfitted = pickle.loads(pickle.dumps(type(classifier.tree)(splitter="oc1")))
+        with self.assertRaises(ValueError):
+            unfitted.predict(X_test)
+
+    def test_criterion(self):
+        X_train, X_test, y_train, y_test = train_test_split(*load_iris(return_X_y=True), test_size=.4, random_state=self.random_state)
+        default = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state).fit(X_train, y_train).predict(X_test)
+        gini = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state, criterion="gini").fit(X_train, y_train).predict(X_test)
+        self.assertTrue((default == gini).all())
+
+        for criterion in ["entropy", "twoing", "hellinger", "maxminority", "summinority", "variance"]:
+            for max_bins in [None, 4]: #the histogram split search sweeps with the criterion too
+                classifier = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state, criterion=criterion, max_bins=max_bins)
+                classifier.fit(X_train, y_train)
+                self.assertGreater(accuracy_score(y_test, classifier.predict(X_test)), .85, criterion)
+
+        with self.assertRaises(ValueError):
+            self.classifier(criterion="mse").fit(X_train, y_train)
+
+    def test_max_leaf_nodes(self):
+        X_train, X_test, y_train, y_test = train_test_split(*load_breast_cancer(return_X_y=True), test_size=.4, random_state=self.random_state)
+        unbounded = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state).fit(X_train, y_train)
+
+        for criterion in ["gini", "entropy", "summinority"]: #the splits are ranked on each criterion's own scale
+            for max_leaf_nodes in [2, 3, 5]:
+                classifier = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state, criterion=criterion, max_leaf_nodes=max_leaf_nodes)
+                classifier.fit(X_train, y_train)
+                self.assertLessEqual(classifier.tree.n_leaves, max_leaf_nodes)
+                self.assertGreater(accuracy_score(y_test, classifier.predict(X_test)), .85, criterion)
+
+        #a bound the tree stays under grows the same tree as depth first
+        bounded = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state, max_leaf_nodes=unbounded.tree.n_leaves + 1).fit(X_train, y_train)
+        self.assertEqual(bounded.tree.n_leaves, unbounded.tree.n_leaves)
+        self.assertTrue((bounded.predict(X_test) == unbounded.predict(X_test)).all())
+
+        with self.assertRaises(ValueError):
+            self.classifier(max_leaf_nodes=1).fit(X_train, y_train)
+
+    def test_stopping_criteria(self):
+        X_train, X_test, y_train, y_test = train_test_split(*load_breast_cancer(return_X_y=True), test_size=.4, random_state=self.random_state)
+        unbounded = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state).fit(X_train, y_train)
+        default = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state, max_depth=None, min_samples_split=2, min_samples_leaf=1, min_impurity_decrease=0.).fit(X_train, y_train)
+        self.assertTrue((unbounded.predict(X_test) == default.predict(X_test)).all())
+
+        for max_depth in [1, 2, 3]:
+            classifier = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state, max_depth=max_depth).fit(X_train, y_train)
+            self.assertLessEqual(classifier.tree.n_leaves, 2 ** max_depth)
+
+        classifier = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state, min_samples_leaf=30).fit(X_train, y_train)
+        _, leaf_sizes = np.unique(classifier.predict_proba(X_train), axis=0, return_counts=True) #samples in leaves alike
+        self.assertGreaterEqual(leaf_sizes.min(), 30)
+        self.assertGreater(accuracy_score(y_test, classifier.predict(X_test)), .85)
+
+        for parameters in [dict(min_samples_split=60), dict(min_impurity_decrease=.01)]:
+            classifier = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state, **parameters).fit(X_train, y_train)
+            self.assertLess(classifier.tree.n_leaves, unbounded.tree.n_leaves, parameters)
+            self.assertGreater(accuracy_score(y_test, classifier.predict(X_test)), .85, parameters)
+
+        for parameters in [dict(max_depth=0), dict(min_samples_split=1), dict(min_samples_leaf=0), dict(min_impurity_decrease=-1)]:
+            with self.assertRaises(ValueError):
+                self.classifier(**parameters).fit(X_train, y_train)
+
+    def test_single_leaf(self):
+        X_train, X_test, y_train, y_test = train_test_split(*load_iris(return_X_y=True), test_size=.4, random_state=self.random_state)
+        frequencies = np.bincount(y_train) / len(y_train)
+
+        for parameters in [dict(min_impurity_decrease=.9), dict(min_samples_split=1000), dict(min_samples_leaf=100)]:
+            classifier = self.classifier(splitter="oc1, axis_parallel", random_state=self.random_state, **parameters).fit(X_train, y_train)
+            self.assertEqual(classifier.tree.n_leaves, 1, parameters) #the root is not split, and predicts the training set
+            self.assertTrue((classifier.predict(X_test) == np.argmax(frequencies)).all(), parameters)
+            self.assertTrue(np.allclose(classifier.predict_proba(X_test), frequencies), parameters)
+
+        loaded = pickle.loads(pickle.dumps(classifier))
+        self.assertEqual(loaded.tree.n_leaves, 1)
+        self.assertTrue((loaded.predict(X_test) == classifier.predict(X_test)).all())
+        self.assertTrue((loaded.predict_proba(X_test) == classifier.predict_proba(X_test)).all())
+
+        with TemporaryDirectory() as directory:
+            path = os.path.join(directory, "tree.model")
+            classifier.save_model(path)
+            loaded = self.classifier.load_model(path)
+            self.assertTrue((loaded.predict_proba(X_test) == classifier.predict_proba(X_test)).all())